@@ -0,0 +1,33 @@
+#ifndef CLOCK_SYNC_H_
+#define CLOCK_SYNC_H_
+
+#include <Arduino.h>
+
+// The system clock runs on the RTC slow clock in deep sleep and drifts. Every NTP sync measures how
+// fast it ran since the sync before, the drift is kept in RTC memory and taken out of the clock on the
+// wakes in between and out of the sleep times, so NTP is only needed now and then.
+
+#define CLOCK_SYNC_WAKES 24        // NTP at least every this many wakes
+#define CLOCK_MAX_ERROR 2000       // ms the clock may be off before NTP is due
+#define CLOCK_DRIFT_UNKNOWN 20000  // ppm the clock can be off by before the drift is learned
+#define CLOCK_DRIFT_MIN_ERROR 50   // ppm, the least the learned drift is trusted to
+#define CLOCK_MIN_SPAN 600         // s between two syncs for a drift sample
+#define CLOCK_MARGIN 500           // ms the wake comes after its time at least
+#define CLOCK_MAX_MARGIN 30000     // ... and at most, the clock is synced on that wake anyway
+
+// Takes the drift since the last sync out of the clock, before the time is read on a wake
+void clock_wake();
+// NTP is needed: never synced, CLOCK_SYNC_WAKES wakes since the sync or the clock can be off too much
+bool clock_sync_due();
+// offset - us the true time is ahead of the clock; sets the clock and learns the drift
+void clock_sync(int64_t offset);
+// us since the epoch by the system clock
+int64_t clock_now();
+// ms the clock can be off by now
+uint32_t clock_error();
+// us of the sleep timer to wake up at the true time until (us since the epoch), a bit after it
+uint64_t clock_sleep(int64_t until);
+// Fast by, ppm
+float clock_drift();
+
+#endif /* CLOCK_SYNC_H_ */
@@ -0,0 +1,51 @@
+#ifndef DISPLAY_LIST_H_
+#define DISPLAY_LIST_H_
+
+#include <Arduino.h>
+#include <FS.h>
+#include "panel.h"
+#include "text_run.h"
+#include "icon_atlas.h"
+
+// The drawing wrappers of render.cpp record commands here, nothing is drawn until dl_draw().
+// Every command has the box it can touch and a hash of its arguments; the boxes and hashes of the
+// frame on the panel are kept on SPIFFS, so the next frame is compared command by command.
+
+#define DL_FILE "/frame.dl"
+#define DL_BANDS 2        // Horizontal bands of the frame rasterized at once, a task per core of the ESP32
+#define DL_MAX_BANDS 16   // For the sim
+#define DL_BAND_MIN 16    // Fewer commands are drawn by the calling task alone
+#define DL_BAND_STACK 4096
+
+void dl_clear();
+// x, y is the pen start on the baseline, like text_draw()
+void dl_text(const text_run_t &run, int x, int y);
+void dl_line(int x0, int y0, int x1, int y1, uint8_t color);
+void dl_rect(int x, int y, int w, int h, uint8_t color, bool fill);
+void dl_triangle(int x0, int y0, int x1, int y1, int x2, int y2, uint8_t color);
+void dl_circle(int x, int y, int r, uint8_t color, bool fill);
+void dl_arc(int x, int y, int r, int16_t start, int16_t end, uint8_t thickness, uint8_t color, bool aa);
+void dl_pixel(int x, int y, uint8_t color);
+// Images: from the atlas, the large atlas image scaled to w x h, or a raw 4bpp bitmap (copied)
+void dl_atlas(const atlas_entry_t &entry, int x, int y);
+void dl_scaled(const char *large, int w, int h, int x, int y);
+void dl_bitmap(const uint8_t *data, int w, int h, int x, int y);
+
+uint16_t dl_count();
+// Identity of the frame: equal hashes - equal frames
+uint32_t dl_hash();
+// Rasterizes the commands into framebuffer, only the ones that touch the regions if n > 0. Images are read
+// ahead, then every band draws the commands that touch it, clipped to its rows.
+void dl_draw(fs::FS &fs, uint8_t *framebuffer, const damage_t *regions = NULL, int n = 0);
+// Rasterizes the commands recorded so far into the white framebuffer, the dl_draw() calls of the frame skip
+// them. The commands recorded after them go over them, on the whole screen.
+void dl_draw_ahead(fs::FS &fs, uint8_t *framebuffer);
+// Bands of the next dl_draw() calls, 1 - the calling task draws everything
+void dl_bands(int n);
+// Boxes of the commands that are in only one of this list and the saved one, in PSRAM, the caller
+// frees them; NULL without a saved list
+damage_t *dl_diff(fs::FS &fs, int &n);
+// Keeps the boxes and hashes for the next dl_diff()
+bool dl_save(fs::FS &fs);
+
+#endif /* DISPLAY_LIST_H_ */
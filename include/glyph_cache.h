@@ -0,0 +1,46 @@
+#ifndef GLYPH_CACHE_H_
+#define GLYPH_CACHE_H_
+
+#include <Arduino.h>
+#include "epd_driver.h"
+
+#define GLYPH_CACHE_BYTES 49152 // PSRAM budget for inflated bitmaps
+#define GLYPH_CACHE_ENTRIES 160
+#define GLYPH_CACHE_BUCKETS 64 // Power of two
+#define GLYPH_CACHE_WORKERS 16 // Tasks that can inflate at once, worker 0 is the one that draws
+
+typedef struct
+{
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t evictions;
+    uint32_t bytes; // Inflated bitmaps held now
+} glyph_cache_stats_t;
+
+// NULL if the font has no glyph for the code point
+const GFXglyph *glyph_find(const GFXfont *font, uint32_t cp);
+// 4bpp bitmap of the glyph, rows padded to whole bytes; valid until the next call
+const uint8_t *glyph_bitmap(const GFXfont *font, const GFXglyph *glyph);
+// Draws the glyph with its origin at x and the baseline at y, black on white like write_string();
+// only rows top .. bottom - 1 of the frame are written
+void glyph_draw(const GFXfont *font, const GFXglyph *glyph, int x, int y, uint8_t *framebuffer, int top = 0,
+                int bottom = EPD_HEIGHT);
+// write_string() for one line through the cache, returns the cursor x after the text
+int glyph_write_string(const GFXfont *font, const char *str, int x, int y, uint8_t *framebuffer);
+// Decodes one UTF-8 code point and advances str, 0 at the end of the string
+uint32_t utf8_next(const char **str);
+
+// Looks the glyph up like glyph_bitmap() does, but a miss only gets an entry: bitmap is where
+// glyph_cache_fill() inflates it, NULL if the glyph is cached already. false if there is no room without
+// dropping another glyph, nothing is reserved then.
+bool glyph_cache_reserve(const GFXfont *font, const GFXglyph *glyph, uint8_t *&bitmap);
+// Inflates a reserved bitmap, tasks filling at the same time use different workers. A glyph that can't be
+// inflated stays white.
+void glyph_cache_fill(const GFXfont *font, const GFXglyph *glyph, uint8_t *bitmap, int worker);
+// A frozen cache is only read, hits don't reorder it and misses are not drawn: several tasks can draw
+// text at once, from glyphs reserved and filled before
+void glyph_cache_freeze(bool frozen);
+void glyph_cache_clear();
+const glyph_cache_stats_t &glyph_cache_stats();
+
+#endif /* GLYPH_CACHE_H_ */
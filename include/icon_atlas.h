@@ -0,0 +1,48 @@
+#ifndef ICON_ATLAS_H_
+#define ICON_ATLAS_H_
+
+#include <Arduino.h>
+#include <FS.h>
+#include "epd_driver.h"
+
+// All images in one file made by tools/pack_icons.py, see the layout there
+
+#define ATLAS_FILE "/icons.pak"
+#define ATLAS_MAX_ICONS 80 // Index entries kept in RTC memory, 16 bytes each
+#define ATLAS_CHUNK 256    // Read buffer of the decoder
+
+enum icon_encoding
+{
+    ICON_RAW = 0, // 4bpp, rows padded to whole bytes
+    ICON_RLE = 1, // Runs of pixels
+};
+
+typedef struct
+{
+    uint32_t hash; // FNV-1a of the name
+    uint32_t offset;
+    uint16_t size;
+    uint16_t width;
+    uint16_t height;
+    uint8_t encoding;
+    uint8_t reserved;
+} atlas_entry_t;
+
+// false if there is no atlas or no such icon in it
+bool atlas_find(fs::FS &fs, const char *name, atlas_entry_t &entry);
+// The image decoded to raw 4bpp in PSRAM, the caller frees it; NULL if it is not in the atlas
+uint8_t *atlas_load(fs::FS &fs, const char *name, atlas_entry_t *entry = NULL);
+// The image as it is stored, entry.size bytes in entry.encoding, in PSRAM; the caller frees it
+uint8_t *atlas_read(fs::FS &fs, const atlas_entry_t &entry);
+// Decodes the image straight into the framebuffer at x,y, white pixels are transparent like in draw_icon()
+bool atlas_draw(fs::FS &fs, const atlas_entry_t &entry, int x, int y, uint8_t *framebuffer);
+// The same for an image in memory: size bytes of data in the given encoding; only rows top .. bottom - 1
+// of the frame are written
+bool image_draw(const uint8_t *data, size_t size, uint8_t encoding, int width, int height, int x, int y,
+                uint8_t *framebuffer, int top = 0, int bottom = EPD_HEIGHT);
+// ICON_RLE encoding of a raw image into out, 0 if it does not fit
+size_t rle_encode(const uint8_t *raw, int width, int height, uint8_t *out, size_t outSize);
+// Drops the index, for when the atlas file is replaced
+void atlas_invalidate();
+
+#endif /* ICON_ATLAS_H_ */
@@ -0,0 +1,24 @@
+#ifndef ICON_SCALE_H_
+#define ICON_SCALE_H_
+
+#include <Arduino.h>
+#include <FS.h>
+
+#define SCALE_CACHE_SLOTS 2     // Scaled icons kept in RTC memory, the two forecast parts
+#define SCALE_CACHE_BYTES 1280  // RLE bytes per slot, bigger results are drawn but not kept
+#define SCALE_SHARPEN false     // Default of icon_draw_scaled(), sim -q shows it further from the hand-made icons
+
+// Area-averaging downscale of a raw 4bpp image (rows padded to whole bytes) to dw x dh.
+// Every source pixel adds to the destination pixels it overlaps in proportion to the overlap.
+// sharpen runs a mild Laplacian pass afterwards to bring back the edges the averaging softens.
+void icon_downscale(const uint8_t *src, int sw, int sh, uint8_t *dst, int dw, int dh, bool sharpen);
+
+// The atlas image large scaled to w x h in PSRAM, size bytes in encoding like image_draw() takes them;
+// the caller frees it. A cached result comes without touching the atlas.
+uint8_t *icon_scaled(fs::FS &fs, const char *large, int w, int h, size_t &size, uint8_t &encoding,
+                     bool sharpen = SCALE_SHARPEN);
+// Draws it at x,y
+bool icon_draw_scaled(fs::FS &fs, const char *large, int w, int h, int x, int y, uint8_t *framebuffer,
+                      bool sharpen = SCALE_SHARPEN);
+
+#endif /* ICON_SCALE_H_ */
@@ -0,0 +1,92 @@
+#ifndef LAYOUT_H_
+#define LAYOUT_H_
+
+#include <Arduino.h>
+#include <FS.h>
+
+// The screen as a list of widgets in /layout.json, see data/layout.json. It is compiled into a flat
+// list of ops once and the ops are kept in /layout.bin with the crc32 of the text, a wake reads them back
+// in one go when the text is the same. Without the file the built-in layout (include/layout_default.h) is
+// used, cached the same way.
+
+#define LAYOUT_FILE "/layout.json"
+#define LAYOUT_CACHE "/layout.bin"
+#define LAYOUT_DOC_SIZE 16384 // JsonDocument of the compiler
+#define LAYOUT_MAX_OPS 96
+#define LAYOUT_POOL 512     // Texts, formats and image names of all ops
+#define LAYOUT_TEXT_SIZE 64 // Longest text with the terminating zero
+#define LAYOUT_FONTS 10     // osans6b .. osans48b, the names are in layout.cpp, the fonts in render.cpp
+#define LAYOUT_NONE 0xFFFF  // No string in the pool
+
+enum layout_widget
+{
+    WIDGET_TEXT,  // A weather field by a printf format or a fixed text
+    WIDGET_IMAGE, // An image from the atlas
+    WIDGET_ICON,  // The condition icon, its name when there is no image
+    WIDGET_COMPASS,
+    WIDGET_SUN, // The arc of the day with the sun on it
+    WIDGET_BATTERY,
+    WIDGET_RSSI,
+    WIDGET_LINE,
+    WIDGET_COUNT
+};
+
+enum layout_field
+{
+    FIELD_NONE,
+    FIELD_CITY,
+    FIELD_TIME, // Of the weather answer
+    FIELD_SEASON,
+    FIELD_TEMP, // temp_avg of a forecast part
+    FIELD_FEELS_LIKE,
+    FIELD_HUMIDITY,
+    FIELD_PRESSURE, // mm Hg
+    FIELD_CONDITION,
+    FIELD_WIND_DIR,
+    FIELD_WIND_SPEED,
+    FIELD_WIND_GUST,
+    FIELD_SUNRISE,
+    FIELD_SUNSET,
+    FIELD_PART_NAME,
+    FIELD_PREC_MM,
+    FIELD_PREC_PROB,
+    FIELD_COUNT
+};
+
+#define LAYOUT_WRAP 0x01       // Text: the part after the first space goes on the next line
+#define LAYOUT_FROM_LEFT 0x02  // x is counted from the left end of the text drawn before
+#define LAYOUT_FROM_RIGHT 0x04 // ... from its right end
+#define LAYOUT_RULE 0x08       // Text: a line under it, b pixels below y
+#define LAYOUT_LARGE 0x10      // Icon, compass: the large style
+#define LAYOUT_CHROME 0x20     // Not placed from a text: what it draws whatever the weather is, is drawn ahead
+
+typedef struct
+{
+    uint8_t type;  // layout_widget
+    uint8_t field; // layout_field
+    int8_t part;   // Forecast part, -1 - the current weather
+    uint8_t font;  // Index in the font table
+    uint8_t align; // alignment
+    uint8_t flags;
+    int16_t x, y;
+    int16_t a, b;  // Line: the other end; image: width, height; compass, sun: radius
+    uint16_t str;  // Text, format or image name, offset in the pool
+} layout_op_t;
+
+typedef struct
+{
+    uint16_t count;
+    uint16_t infoCount; // ops[0 .. infoCount - 1] are the status line, display_info()
+    uint16_t poolSize;
+    layout_op_t ops[LAYOUT_MAX_OPS];
+    char pool[LAYOUT_POOL];
+} layout_t;
+
+// The compiled layout, read or compiled on the first call of the wake
+const layout_t &layout_get(fs::FS &fs);
+// Compiles the JSON text, false with the reason logged if it is not a valid layout
+bool layout_compile(const char *json, size_t size, layout_t &layout);
+// Drops the compiled layout, for when /layout.json is replaced
+void layout_invalidate(fs::FS &fs);
+
+#endif /* LAYOUT_H_ */
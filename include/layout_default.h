@@ -0,0 +1,58 @@
+// Generated by tools/gen_layout.py from data/layout.json, do not edit
+#ifndef LAYOUT_DEFAULT_H_
+#define LAYOUT_DEFAULT_H_
+
+// The layout used without /layout.json on SPIFFS
+static const char layoutDefault[] =
+    "{\"info\":["
+    "{\"type\":\"text\",\"field\":\"city\",\"font\":\"osans12b\",\"x\":10,\"y\":15},"
+    "{\"type\":\"text\",\"field\":\"time\",\"font\":\"osans12b\",\"x\":400,\"y\":15},"
+    "{\"type\":\"battery\",\"font\":\"osans12b\",\"x\":680,\"y\":30},"
+    "{\"type\":\"rssi\",\"x\":900,\"y\":35}"
+    "],"
+    "\"weather\":["
+    "{\"type\":\"line\",\"x\":0,\"y\":50,\"x2\":960,\"y2\":50},"
+    "{\"type\":\"compass\",\"large\":true,\"x\":830,\"y\":200,\"r\":100},"
+    "{\"type\":\"text\",\"field\":\"season\",\"font\":\"osans18b\",\"x\":20,\"y\":60},"
+    "{\"type\":\"text\",\"field\":\"temp\",\"format\":\"%d °C\",\"font\":\"osans48b\",\"align\":\"center\",\"x\":480,\"y\":70},"
+    "{\"type\":\"text\",\"field\":\"feels_like\",\"format\":\"%d °C\",\"font\":\"osans16b\",\"align\":\"center\",\"x\":480,\"y\":148},"
+    "{\"type\":\"text\",\"text\":\"(ощущается)\",\"font\":\"osans8b\",\"align\":\"center\",\"x\":480,\"y\":171},"
+    "{\"type\":\"text\",\"field\":\"humidity\",\"format\":\"%u%%\",\"font\":\"osans24b\",\"align\":\"right\",\"x\":460,\"y\":205},"
+    "{\"type\":\"image\",\"name\":\"blob\",\"from\":\"left\",\"x\":-40,\"y\":205,\"w\":36,\"h\":40},"
+    "{\"type\":\"text\",\"field\":\"pressure\",\"format\":\"%u\",\"font\":\"osans24b\",\"x\":500,\"y\":205},"
+    "{\"type\":\"text\",\"text\":\"mm\",\"font\":\"osans10b\",\"from\":\"right\",\"x\":5,\"y\":205,\"rule\":16},"
+    "{\"type\":\"text\",\"text\":\"Hg\",\"font\":\"osans10b\",\"from\":\"left\",\"x\":0,\"y\":219},"
+    "{\"type\":\"icon\",\"large\":true,\"x\":20,\"y\":50},"
+    "{\"type\":\"text\",\"field\":\"condition\",\"font\":\"osans8b\",\"align\":\"center\",\"wrap\":true,\"x\":145,\"y\":305},"
+    "{\"type\":\"sun\",\"x\":480,\"y\":355,\"r\":100},"
+    "{\"type\":\"image\",\"name\":\"sunrise\",\"x\":370,\"y\":305,\"w\":47,\"h\":35},"
+    "{\"type\":\"image\",\"name\":\"sunset\",\"x\":545,\"y\":305,\"w\":47,\"h\":40},"
+    "{\"type\":\"text\",\"field\":\"sunrise\",\"font\":\"osans10b\",\"align\":\"right\",\"x\":360,\"y\":320},"
+    "{\"type\":\"text\",\"field\":\"sunset\",\"font\":\"osans10b\",\"x\":600,\"y\":320},"
+    "{\"type\":\"line\",\"x\":0,\"y\":350,\"x2\":960,\"y2\":350},"
+    "{\"type\":\"line\",\"x\":480,\"y\":350,\"x2\":480,\"y2\":540},"
+    "{\"type\":\"text\",\"part\":0,\"field\":\"part_name\",\"font\":\"osans10b\",\"x\":10,\"y\":355},"
+    "{\"type\":\"icon\",\"part\":0,\"x\":10,\"y\":370},"
+    "{\"type\":\"text\",\"part\":0,\"field\":\"condition\",\"font\":\"osans6b\",\"wrap\":true,\"x\":20,\"y\":465},"
+    "{\"type\":\"text\",\"part\":0,\"field\":\"prec_mm\",\"format\":\"%.1fmm\",\"font\":\"osans6b\",\"align\":\"center\",\"x\":60,\"y\":500},"
+    "{\"type\":\"text\",\"part\":0,\"field\":\"prec_prob\",\"format\":\"%d%%\",\"font\":\"osans6b\",\"align\":\"center\",\"x\":60,\"y\":515},"
+    "{\"type\":\"compass\",\"part\":0,\"x\":390,\"y\":440,\"r\":60},"
+    "{\"type\":\"text\",\"part\":0,\"field\":\"temp\",\"format\":\"%d °C\",\"font\":\"osans24b\",\"align\":\"center\",\"x\":210,\"y\":380},"
+    "{\"type\":\"text\",\"part\":0,\"field\":\"feels_like\",\"format\":\"%d °C\",\"font\":\"osans18b\",\"align\":\"center\",\"x\":210,\"y\":425},"
+    "{\"type\":\"text\",\"text\":\"(ощущается)\",\"font\":\"osans6b\",\"align\":\"center\",\"x\":210,\"y\":453},"
+    "{\"type\":\"text\",\"part\":0,\"field\":\"pressure\",\"font\":\"osans10b\",\"align\":\"center\",\"x\":210,\"y\":475},"
+    "{\"type\":\"text\",\"text\":\"mm/Hg\",\"font\":\"osans6b\",\"align\":\"center\",\"x\":210,\"y\":490},"
+    "{\"type\":\"text\",\"part\":1,\"field\":\"part_name\",\"font\":\"osans10b\",\"x\":490,\"y\":355},"
+    "{\"type\":\"icon\",\"part\":1,\"x\":490,\"y\":370},"
+    "{\"type\":\"text\",\"part\":1,\"field\":\"condition\",\"font\":\"osans6b\",\"wrap\":true,\"x\":500,\"y\":465},"
+    "{\"type\":\"text\",\"part\":1,\"field\":\"prec_mm\",\"format\":\"%.1fmm\",\"font\":\"osans6b\",\"align\":\"center\",\"x\":540,\"y\":500},"
+    "{\"type\":\"text\",\"part\":1,\"field\":\"prec_prob\",\"format\":\"%d%%\",\"font\":\"osans6b\",\"align\":\"center\",\"x\":540,\"y\":515},"
+    "{\"type\":\"compass\",\"part\":1,\"x\":871,\"y\":440,\"r\":60},"
+    "{\"type\":\"text\",\"part\":1,\"field\":\"temp\",\"format\":\"%d °C\",\"font\":\"osans24b\",\"align\":\"center\",\"x\":690,\"y\":380},"
+    "{\"type\":\"text\",\"part\":1,\"field\":\"feels_like\",\"format\":\"%d °C\",\"font\":\"osans18b\",\"align\":\"center\",\"x\":690,\"y\":425},"
+    "{\"type\":\"text\",\"text\":\"(ощущается)\",\"font\":\"osans6b\",\"align\":\"center\",\"x\":690,\"y\":453},"
+    "{\"type\":\"text\",\"part\":1,\"field\":\"pressure\",\"font\":\"osans10b\",\"align\":\"center\",\"x\":690,\"y\":475},"
+    "{\"type\":\"text\",\"text\":\"mm/Hg\",\"font\":\"osans6b\",\"align\":\"center\",\"x\":690,\"y\":490}"
+    "]}";
+
+#endif /* LAYOUT_DEFAULT_H_ */
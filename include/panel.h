@@ -0,0 +1,28 @@
+#ifndef PANEL_H_
+#define PANEL_H_
+
+#include <Arduino.h>
+#include <FS.h>
+#include "epd_driver.h"
+
+#define DAMAGE_MERGE_GAP 16   // Regions closer than this are refreshed as one
+#define FULL_REFRESH_EVERY 24 // Partial updates between two full clears, against ghosting
+#define FULL_REFRESH_AREA 50  // Changed area in % of the screen above which a full refresh is cheaper
+
+typedef struct
+{
+    int16_t x;
+    int16_t y;
+    int16_t w;
+    int16_t h;
+} damage_t;
+
+// The panel shows something else (settings screen), the next update is a full one
+void panel_invalidate();
+// Draws the display list (display_list.h) into frame and pushes it to the panel: only the boxes of
+// the commands that differ from the previous frame, or the whole screen when there is no usable
+// previous list. frame must be white. The panel must be powered. false - a region could not be pushed,
+// the panel does not show the frame and the next update is a full one.
+bool panel_update(fs::FS &fs, uint8_t *frame);
+
+#endif /* PANEL_H_ */
@@ -0,0 +1,22 @@
+#ifndef PARAM_CACHE_H_
+#define PARAM_CACHE_H_
+
+#include <Arduino.h>
+#include "param_data.h"
+
+// param.json as parsed on an earlier wake, kept in RTC memory: the wakes after it get param_t without
+// mounting SPIFFS and parsing JSON. The copy is CRC-checked and dropped whenever the settings mode is
+// entered, the only way param.json changes; every save there bumps the config generation in the file.
+
+#define PARAM_CITY_SIZE 64
+#define PARAM_API_KEY_SIZE 64
+#define PARAM_SSID_SIZE 33 // 32 and the terminating zero
+#define PARAM_PASS_SIZE 65
+
+// false - no valid copy, param is left as it is
+bool param_restore(param_t &param);
+// false - a string does not fit, nothing is kept
+bool param_store(const param_t &param);
+void param_invalidate();
+
+#endif /* PARAM_CACHE_H_ */
@@ -3,6 +3,18 @@
 
 #include <Arduino.h>
 
+#define QUIET_MAX 4  // Quiet hours entries in param.json
+#define QUIET_FROM 2 // Without them in param.json: every night from 02:00 to 05:00
+#define QUIET_TO 5
+
+// No updates from .from to .to o'clock local time (over midnight if .to < .from), starting on the days of .days
+typedef struct
+{
+  uint8_t days; // Bit 0 - Sunday ... bit 6 - Saturday, like tm_wday
+  uint8_t from;
+  uint8_t to;
+} quiet_hours_t;
+
 typedef struct
 {
   String city;
@@ -14,6 +26,9 @@ typedef struct
   int8_t time_zone;
   String ap_ssid;
   String ap_pass;
+  uint32_t generation; // Of param.json, every save in the settings mode bumps it
+  quiet_hours_t quiet[QUIET_MAX];
+  uint8_t quiet_cnt;
 } param_t;
 
 #endif /* ifndef PARAM_DATA_H_ */
@@ -0,0 +1,12 @@
+#ifndef PARAM_JSON_H_
+#define PARAM_JSON_H_
+
+#include <FS.h>
+#include "param_data.h"
+
+#define PARAM_FILE "/param.json"
+
+// PARAM_FILE into param, false - no usable file
+bool param_read(fs::FS &fs, param_t &param);
+
+#endif /* PARAM_JSON_H_ */
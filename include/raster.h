@@ -0,0 +1,31 @@
+#ifndef RASTER_H_
+#define RASTER_H_
+
+#include <Arduino.h>
+#include "epd_driver.h"
+
+// Angles are in degrees, 0 points right and they grow clockwise on the screen (y goes down).
+// Every call writes only rows top .. bottom - 1 of the frame, tasks drawing it in bands share the framebuffer.
+
+// Arc of radius r around x,y from start to end. Thickness grows outwards, r is the inner edge.
+// Thin solid arcs are the pixels epd_draw_circle() would draw; aa shades the edges with grey.
+void arc_draw(int x, int y, int r, int16_t start, int16_t end, uint8_t thickness, uint8_t color, bool aa,
+              uint8_t *framebuffer, int top = 0, int bottom = EPD_HEIGHT);
+
+// 4bpp image w x h, rows padded to whole bytes, at x,y; 0xF pixels are transparent like in draw_icon().
+// Parts off the screen are clipped, x can be odd.
+void image_blit(const uint8_t *data, int w, int h, int x, int y, uint8_t *framebuffer, int top = 0,
+                int bottom = EPD_HEIGHT);
+
+// The pixels of epd_write_line(), epd_draw_rect()/epd_fill_rect(), epd_draw_circle()/epd_fill_circle()
+// and epd_fill_triangle()
+void line_draw(int x0, int y0, int x1, int y1, uint8_t color, uint8_t *framebuffer, int top = 0,
+               int bottom = EPD_HEIGHT);
+void rect_draw(int x, int y, int w, int h, uint8_t color, bool fill, uint8_t *framebuffer, int top = 0,
+               int bottom = EPD_HEIGHT);
+void circle_draw(int x, int y, int r, uint8_t color, bool fill, uint8_t *framebuffer, int top = 0,
+                 int bottom = EPD_HEIGHT);
+void triangle_fill(int x0, int y0, int x1, int y1, int x2, int y2, uint8_t color, uint8_t *framebuffer, int top = 0,
+                   int bottom = EPD_HEIGHT);
+
+#endif /* RASTER_H_ */
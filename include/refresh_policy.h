@@ -0,0 +1,57 @@
+#ifndef REFRESH_POLICY_H_
+#define REFRESH_POLICY_H_
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <time.h>
+#include "param_data.h"
+#include "weather_data.h"
+
+// Picks the next wake instead of a fixed period: sooner while the temperature moves or precipitation is
+// likely, later while the weather holds or the battery runs low, never inside the quiet hours of
+// param.quiet. The last observations are kept in RTC memory for the change rates.
+
+#define POLICY_HISTORY 4           // Observations kept
+#define POLICY_STEP 900            // s, the wakes fall on multiples of it
+#define POLICY_MIN_INTERVAL 900    // s
+#define POLICY_MAX_INTERVAL 14400  // s
+#define POLICY_MIN_SPAN 1800       // s between the observations a temperature slope is taken over
+#define POLICY_TEMP_SLOPE 2.0      // Degrees an hour for the shortest interval, half of it keeps the base one
+#define POLICY_PREC_PROB 70        // % of precipitation for the shortest interval
+#define POLICY_BATTERY_LOW 30      // %, the interval is doubled under it
+#define POLICY_BATTERY_CRITICAL 10 // ... and doubled again
+#define POLICY_CLOCK_SET 1451606400 // 2016-01-01, a clock behind it was never set and has no quiet hours
+
+// Why the interval is not the base one, policy_decision_t::reasons
+#define POLICY_VOLATILE 0x01 // Shortened for the weather
+#define POLICY_CALM 0x02     // Stretched for the weather
+#define POLICY_BATTERY 0x04
+#define POLICY_QUIET 0x08    // Moved to the end of the quiet hours
+#define POLICY_NO_DATA 0x10  // Too few observations for the slope
+
+typedef struct
+{
+    time_t time;       // Of the decision
+    time_t next;       // Wake time, s since the epoch
+    uint32_t interval; // s asked for, before the alignment and the quiet hours
+    float volatility;  // 0 - the weather holds, 1 - it changes fast
+    float tempSlope;   // Degrees an hour
+    uint8_t precProb;  // %
+    uint8_t battery;   // %
+    uint8_t reasons;
+} policy_decision_t;
+
+// A fetched weather: the fact temperature by its obs_time, the next part's precipitation probability
+void policy_observe(const weather_t &w, uint8_t battery);
+// The wake slot nearest to time is in the quiet hours, a wake a bit early or late is the one of its slot
+bool policy_quiet(time_t time, const param_t &param);
+// param.json "quiet": [{"days": "12345", "from": 23, "to": 7}, ...], days are tm_wday digits, all if left out;
+// no "quiet" - QUIET_FROM to QUIET_TO every day
+void policy_quiet_hours(JsonVariant quiet, param_t &param);
+// base - the fixed period, s
+policy_decision_t policy_next(time_t now, uint32_t base, const param_t &param);
+void policy_log(const policy_decision_t &decision);
+// Drops the observations
+void policy_reset();
+
+#endif /* REFRESH_POLICY_H_ */
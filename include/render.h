@@ -0,0 +1,61 @@
+#ifndef RENDER_H_
+#define RENDER_H_
+
+#include <Arduino.h>
+#include "epd_driver.h"
+#include "param_data.h"
+#include "weather_data.h"
+
+#define White 0xFF
+#define LightGrey 0xBB
+#define Grey 0x88
+#define DarkGrey 0x44
+#define Black 0x00
+
+#define L_SIZE 250
+#define S_SIZE 100
+
+enum alignment
+{
+  LEFT,
+  RIGHT,
+  CENTER
+};
+
+enum icon_size
+{
+  SmallIcon,
+  LargeIcon
+};
+
+// Everything the screen is drawn from, owned by the sketch (or by the host simulator)
+extern param_t param;
+extern weather_t weather;
+extern int wifi_signal;
+extern float battery_voltage;
+extern uint8_t *displayBuffer; // EPD_WIDTH * EPD_HEIGHT / 2, 4bpp
+
+// Downloads an icon that is not on SPIFFS yet, provided by the platform
+bool getIcon(const char *iconName);
+// Downloads and renders the icons of weather that are not on SPIFFS yet, called while still connected:
+// drawing does not go to the network
+void prefetch_icons();
+// Both sizes of the icon can be drawn without the network
+bool icon_ready(const char *name);
+
+// What doesn't depend on the weather, drawn ahead while it is fetched; display_info() and display_weather()
+// add the rest
+void display_chrome();
+void display_weather();
+void display_info();
+void display_settings(const char *ssid, const char *pass);
+uint8_t battery_percentage(float voltage);
+uint8_t *load_file(String fileName);
+bool draw_image(const char *name, int x, int y, int w, int h);
+void draw_icon(int x, int y, int w, int h, const uint8_t *data);
+int drawString(int x, int y, const char *text, alignment align);
+int drawString(int x, int y, const String &text, alignment align);
+void setFont(GFXfont const &font);
+void edp_update();
+
+#endif /* RENDER_H_ */
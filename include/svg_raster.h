@@ -0,0 +1,19 @@
+#ifndef SVG_RASTER_H_
+#define SVG_RASTER_H_
+
+#include <Arduino.h>
+#include <FS.h>
+
+// A small SVG renderer for the Yandex weather icons: path, polygon, circle, ellipse and rect filled
+// with solid colours or the average of a gradient, under g and transform. Strokes, text, clipping
+// and masks are not drawn. The file is parsed through a small buffer, shape by shape.
+
+#define SVG_CHUNK 256    // Read buffer of the parser
+#define SVG_MAX_DEPTH 16 // Nested elements
+#define SVG_GRADIENTS 8  // Gradients kept for url(#id) fills
+
+// Renders the SVG file fitted into width x height (aspect kept, centred) as a raw 4bpp image with rows
+// padded to whole bytes, like the .bin icons; what the SVG leaves empty is white. false if it can't be read.
+bool svg_render(fs::FS &fs, const char *path, int width, int height, uint8_t *image);
+
+#endif /* SVG_RASTER_H_ */
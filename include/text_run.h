@@ -0,0 +1,29 @@
+#ifndef TEXT_RUN_H_
+#define TEXT_RUN_H_
+
+#include <Arduino.h>
+#include "epd_driver.h"
+
+#define TEXT_RUN_MAX 64 // Glyphs per run, the rest of a longer string is dropped
+
+// A string measured once: its glyphs, where each one goes and the box of the whole run.
+// Coordinates are relative to the pen start on the baseline.
+typedef struct
+{
+    const GFXfont *font;
+    const GFXglyph *glyph[TEXT_RUN_MAX];
+    int16_t pen[TEXT_RUN_MAX];
+    uint8_t count;
+    int16_t advance; // Pen position after the last glyph
+    // The box get_text_bounds() reports for the string at 0,0
+    int16_t x1;
+    int16_t y1;
+    int16_t w;
+    int16_t h;
+} text_run_t;
+
+void text_shape(text_run_t &run, const GFXfont *font, const char *str);
+// Draws the run with its pen start at x and the baseline at y, into rows top .. bottom - 1 of the frame
+void text_draw(const text_run_t &run, int x, int y, uint8_t *framebuffer, int top = 0, int bottom = EPD_HEIGHT);
+
+#endif /* TEXT_RUN_H_ */
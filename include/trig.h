@@ -0,0 +1,32 @@
+#ifndef TRIG_H_
+#define TRIG_H_
+
+#include <Arduino.h>
+
+// Fixed point trigonometry for the drawing code: sines are Q15 (TRIG_ONE is 1.0) and angles are
+// binary, TRIG_TURN units per full turn, growing clockwise on the screen like in raster.h.
+// 16 compass points and the 8 wind directions are exact angles.
+
+#define TRIG_TURN 1024
+#define TRIG_QUARTER (TRIG_TURN / 4)
+#define TRIG_ONE 32768
+
+int32_t trig_sin(int32_t angle);
+int32_t trig_cos(int32_t angle);
+
+// Degrees to angle units, rounded to the nearest unit (0.35 degree)
+inline int32_t trig_angle(int32_t deg)
+{
+    return (deg * TRIG_TURN + (deg >= 0 ? 180 : -180)) / 360;
+}
+
+// v * q for a Q15 q, truncated towards zero like a float to int conversion
+inline int32_t trig_scale(int32_t v, int32_t q)
+{
+    return v * q / TRIG_ONE;
+}
+
+// Rotates x,y by angle; rx,ry are Q15, add the centre shifted by 15 and shift back to get pixels
+void trig_rotate(int32_t x, int32_t y, int32_t angle, int32_t &rx, int32_t &ry);
+
+#endif /* TRIG_H_ */
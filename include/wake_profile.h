@@ -0,0 +1,47 @@
+#ifndef WAKE_PROFILE_H_
+#define WAKE_PROFILE_H_
+
+#include <Arduino.h>
+
+// Where the awake time goes: every wake is a timeline of phases timed with esp_timer_get_time(), the
+// last PROFILE_WAKES of them are kept in RTC memory across deep sleep. A phase can be started and
+// stopped several times (retries), the times add up; phases of different tasks can overlap.
+
+#define PROFILE_WAKES 8
+
+enum profile_phase
+{
+    PHASE_SPIFFS, // Mount
+    PHASE_PARAM,  // /param.json
+    PHASE_WIFI,   // Associate, up to an IP
+    PHASE_NTP,
+    PHASE_HTTP,   // Connect, request, headers; the body is read by the decoder
+    PHASE_DECODE, // JSON into weather_t
+    PHASE_CHROME, // Drawn ahead on a task of its own, in parallel with the phases above
+    PHASE_RENDER, // The weather recorded over the chrome
+    PHASE_PANEL,  // Power on, rasterize, push, power off
+    PHASE_COUNT
+};
+
+typedef struct
+{
+    uint32_t wake;                // Since power on
+    uint32_t total;               // us from boot to profile_end(), 0 - the wake is not over
+    uint32_t phases[PHASE_COUNT]; // us, 0 - not reached
+    uint8_t cause;                // esp_sleep_wakeup_cause_t
+} profile_wake_t;
+
+// A new timeline, the oldest one is dropped
+void profile_begin(uint8_t cause);
+void profile_start(uint8_t phase);
+void profile_stop(uint8_t phase);
+void profile_end();
+// Timelines kept, the current one included
+uint8_t profile_count();
+// age 0 - the current wake, 1 - the one before, ...
+const profile_wake_t &profile_wake(uint8_t age);
+const char *profile_phase_name(uint8_t phase);
+// One line per timeline
+void profile_log(uint8_t age);
+
+#endif /* WAKE_PROFILE_H_ */
@@ -1,67 +1,143 @@
 #ifndef FACT_WEATHER_H_
 #define FACT_WEATHER_H_
 
-#include <Arduino.h>
+#include <stdint.h>
+
+// Closed Yandex vocabularies, the API tokens are in weather_vocab.cpp
+enum condition_t : uint8_t
+{
+    COND_UNKNOWN,
+    COND_CLEAR,
+    COND_PARTLY_CLOUDY,
+    COND_CLOUDY,
+    COND_OVERCAST,
+    COND_DRIZZLE,
+    COND_LIGHT_RAIN,
+    COND_RAIN,
+    COND_MODERATE_RAIN,
+    COND_HEAVY_RAIN,
+    COND_CONTINUOUS_HEAVY_RAIN,
+    COND_SHOWERS,
+    COND_WET_SNOW,
+    COND_LIGHT_SNOW,
+    COND_SNOW,
+    COND_SNOW_SHOWERS,
+    COND_HAIL,
+    COND_THUNDERSTORM,
+    COND_THUNDERSTORM_WITH_RAIN,
+    COND_THUNDERSTORM_WITH_HAIL,
+    COND_COUNT
+};
+
+enum daytime_t : uint8_t
+{
+    DAYTIME_UNKNOWN,
+    DAYTIME_DAY,
+    DAYTIME_NIGHT,
+    DAYTIME_COUNT
+};
+
+enum season_t : uint8_t
+{
+    SEASON_UNKNOWN,
+    SEASON_SUMMER,
+    SEASON_AUTUMN,
+    SEASON_WINTER,
+    SEASON_SPRING,
+    SEASON_COUNT
+};
+
+enum part_name_t : uint8_t
+{
+    PART_UNKNOWN,
+    PART_NIGHT,
+    PART_MORNING,
+    PART_DAY,
+    PART_EVENING,
+    PART_COUNT
+};
+
+enum wind_dir_t : uint8_t
+{
+    WIND_UNKNOWN,
+    WIND_CALM,
+    WIND_N,
+    WIND_NE,
+    WIND_E,
+    WIND_SE,
+    WIND_S,
+    WIND_SW,
+    WIND_W,
+    WIND_NW,
+    WIND_COUNT
+};
+
+#define ICON_NONE 0xFF // Icon ids index the icon name table, see icon_id()
+#define TOKEN_SIZE 24  // A token the vocabulary does not know, kept as it came to be shown instead of a label
 
 typedef struct
 {
-    String condition;
-    String daytime;
-    int8_t feels_like;
-    uint8_t humidity;
-    String icon;
     int obs_time;
-    bool polar;
     uint16_t pressure_mm;
     uint16_t pressure_pa;
-    String season;
-    int8_t temp;
-    int8_t temp_water;
-    String wind_dir;
     float wind_gust;
     float wind_speed;
+    condition_t condition;
+    daytime_t daytime;
+    season_t season;
+    wind_dir_t wind_dir;
+    uint8_t icon;
+    int8_t feels_like;
+    uint8_t humidity;
+    bool polar;
+    int8_t temp;
+    int8_t temp_water;
+    char condition_token[TOKEN_SIZE]; // Empty unless condition is COND_UNKNOWN
+    char season_token[TOKEN_SIZE];
 } fact_weather_t;
 
 typedef struct
 {
-    String condition;
-    String daytime;
-    int8_t feels_like;
-    uint8_t humidity;
-    String icon;
-    String part_name;
-    bool polar;
     float prec_mm;
+    float wind_gust;
+    float wind_speed;
     uint16_t prec_period;
-    uint8_t prec_prob;
     uint16_t pressure_mm;
     uint16_t pressure_pa;
+    condition_t condition;
+    daytime_t daytime;
+    part_name_t part_name;
+    wind_dir_t wind_dir;
+    uint8_t icon;
+    int8_t feels_like;
+    uint8_t humidity;
+    bool polar;
+    uint8_t prec_prob;
     int8_t temp_avg;
     int8_t temp_max;
     int8_t temp_min;
     int8_t temp_water;
-    String wind_dir;
-    float wind_gust;
-    float wind_speed;
+    char condition_token[TOKEN_SIZE]; // Empty unless condition is COND_UNKNOWN
+    char part_name_token[TOKEN_SIZE];
 } forecast_part_t;
 
 typedef struct
 {
-    String date;
     int date_ts;
-    uint8_t moon_code;
-    String moon_text;
     forecast_part_t parts[2];
-    String sunrise;
-    String sunset;
     uint16_t week;
+    uint8_t moon_code;
+    char date[11];      // 2022-02-06
+    char moon_text[16]; // moon-code-11
+    char sunrise[6];    // 08:27
+    char sunset[6];     // 16:57
 } forecast_weather_t;
 
 typedef struct
 {
     float lat;
     float lon;
-    String url;
+    char url[96];
 } info_t;
 
 typedef struct
@@ -70,7 +146,7 @@ typedef struct
     forecast_weather_t forecast;
     info_t info;
     int now;
-    String now_dt;
+    char now_dt[32]; // 2022-02-06T08:44:32.633810Z
 } weather_t;
 
 /* Answer example */
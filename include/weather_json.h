@@ -0,0 +1,19 @@
+#ifndef WEATHER_JSON_H_
+#define WEATHER_JSON_H_
+
+#include <ArduinoJson.h>
+#include "weather_data.h"
+
+// Only the fields weather_t uses, everything else is dropped by the deserializer
+#define WEATHER_FILTER_SIZE (JSON_OBJECT_SIZE(5) + JSON_OBJECT_SIZE(15) + JSON_OBJECT_SIZE(8) + \
+                             JSON_ARRAY_SIZE(1) + JSON_OBJECT_SIZE(19) + JSON_OBJECT_SIZE(3))
+// Filtered answer: two forecast parts plus the copied keys and string values
+#define WEATHER_DOC_SIZE (JSON_OBJECT_SIZE(5) + JSON_OBJECT_SIZE(15) + JSON_OBJECT_SIZE(8) + \
+                          JSON_ARRAY_SIZE(2) + 2 * JSON_OBJECT_SIZE(19) + JSON_OBJECT_SIZE(3) + 1024)
+
+// Filter for deserializeJson(), built on the first call
+const JsonDocument &weather_filter();
+// Copies a Yandex informers answer into the model
+void decode_weather(JsonObject jo, weather_t &weather);
+
+#endif /* WEATHER_JSON_H_ */
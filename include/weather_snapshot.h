@@ -0,0 +1,91 @@
+#ifndef WEATHER_SNAPSHOT_H_
+#define WEATHER_SNAPSHOT_H_
+
+#include <Arduino.h>
+#include <FS.h>
+#include "weather_data.h"
+
+#define SNAPSHOT_FILE "/weather.snap"
+#define SNAPSHOT_MAGIC 0x57534E50 // "PNSW"
+#define SNAPSHOT_VERSION 3
+#define SNAPSHOT_STR_SIZE 224 // Interned string table, offset 0 is the empty string
+
+// All strings are offsets into snapshot_t::strings, icons are kept by name
+// because the ids of run-time interned icons change from boot to boot
+typedef struct
+{
+    uint16_t icon;
+    uint16_t condition_token;
+    uint16_t part_name_token;
+    uint16_t prec_period;
+    uint16_t pressure_mm;
+    uint16_t pressure_pa;
+    float prec_mm;
+    float wind_gust;
+    float wind_speed;
+    uint8_t condition;
+    uint8_t daytime;
+    uint8_t part_name;
+    uint8_t wind_dir;
+    int8_t feels_like;
+    uint8_t humidity;
+    uint8_t polar;
+    uint8_t prec_prob;
+    int8_t temp_avg;
+    int8_t temp_max;
+    int8_t temp_min;
+    int8_t temp_water;
+} snapshot_part_t;
+
+typedef struct
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size; // sizeof(snapshot_t), catches layout changes without a version bump
+    uint32_t crc;  // crc32 of everything after the header
+} snapshot_header_t;
+
+typedef struct
+{
+    snapshot_header_t header;
+    // fact
+    int32_t obs_time;
+    uint16_t icon;
+    uint16_t pressure_mm;
+    uint16_t pressure_pa;
+    int8_t feels_like;
+    uint8_t humidity;
+    float wind_gust;
+    float wind_speed;
+    uint8_t condition;
+    uint8_t daytime;
+    uint8_t season;
+    uint8_t wind_dir;
+    uint8_t polar;
+    int8_t temp;
+    int8_t temp_water;
+    uint8_t moon_code;
+    // forecast
+    int32_t date_ts;
+    uint16_t date;
+    uint16_t moon_text;
+    uint16_t sunrise;
+    uint16_t sunset;
+    uint16_t week;
+    uint16_t url;
+    uint16_t condition_token;
+    uint16_t season_token;
+    snapshot_part_t parts[2];
+    // info
+    float lat;
+    float lon;
+    int32_t now;
+    uint16_t now_dt;
+    uint16_t str_used;
+    char strings[SNAPSHOT_STR_SIZE];
+} snapshot_t;
+
+bool snapshot_save(fs::FS &fs, const weather_t &w);
+bool snapshot_load(fs::FS &fs, weather_t &w);
+
+#endif /* WEATHER_SNAPSHOT_H_ */
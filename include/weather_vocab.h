@@ -0,0 +1,28 @@
+#ifndef WEATHER_VOCAB_H_
+#define WEATHER_VOCAB_H_
+
+#include <stdint.h>
+#include "weather_data.h"
+
+#define ICON_NAME_SIZE 16 // bkn_+ra_d
+#define ICON_EXTRA 8      // Icons missing from the build-time table, interned at run time
+
+// API token -> model, unknown tokens map to *_UNKNOWN
+condition_t parse_condition(const char *token);
+daytime_t parse_daytime(const char *token);
+season_t parse_season(const char *token);
+part_name_t parse_part_name(const char *token);
+wind_dir_t parse_wind_dir(const char *token);
+uint8_t icon_id(const char *name);
+
+// Model -> text for the screen
+const char *condition_label(condition_t condition);
+const char *season_label(season_t season);
+const char *part_name_label(part_name_t part);
+const char *wind_dir_label(wind_dir_t dir);
+int16_t wind_dir_angle(wind_dir_t dir); // -1 for calm and unknown
+const char *icon_name(uint8_t id);
+// An unknown token has an empty label, the token as it came (*_token of weather_t) is shown then
+const char *label_or_token(const char *label, const char *token);
+
+#endif /* WEATHER_VOCAB_H_ */
@@ -0,0 +1,480 @@
+// Generated by tools/gen_vocab.py, do not edit
+#ifndef WEATHER_VOCAB_TABLE_H_
+#define WEATHER_VOCAB_TABLE_H_
+
+#include <stdint.h>
+#include "weather_data.h"
+
+typedef struct
+{
+    const char *token;
+    uint8_t value; // enum value, the slot itself for icons
+    const char *label;
+    int16_t angle; // wind direction, -1 for everything else
+} vocab_entry_t;
+
+// FNV-1a with a per-table seed
+constexpr uint32_t vocab_hash(const char *token, uint32_t h)
+{
+    return *token ? vocab_hash(token + 1, (h ^ (uint8_t)*token) * 16777619u) : h;
+}
+
+constexpr uint8_t vocab_slot(const char *token, uint32_t seed, uint8_t slots)
+{
+    return vocab_hash(token, seed) & (slots - 1);
+}
+
+#define CONDITION_SEED 0x0000000Eu
+#define CONDITION_SLOTS 64
+#define CONDITION_UNKNOWN_SLOT 0
+constexpr vocab_entry_t condition_table[CONDITION_SLOTS] = {
+    {"", COND_UNKNOWN, "", -1},
+    {"snow", COND_SNOW, "Снег", -1},
+    {"", COND_UNKNOWN, "", -1},
+    {"", COND_UNKNOWN, "", -1},
+    {"", COND_UNKNOWN, "", -1},
+    {"", COND_UNKNOWN, "", -1},
+    {"heavy-rain", COND_HEAVY_RAIN, "Сильный дождь", -1},
+    {"", COND_UNKNOWN, "", -1},
+    {"", COND_UNKNOWN, "", -1},
+    {"thunderstorm-with-hail", COND_THUNDERSTORM_WITH_HAIL, "Гроза с градом", -1},
+    {"", COND_UNKNOWN, "", -1},
+    {"overcast", COND_OVERCAST, "Пасмурно", -1},
+    {"drizzle", COND_DRIZZLE, "Моросящий дождь", -1},
+    {"thunderstorm", COND_THUNDERSTORM, "Гроза", -1},
+    {"", COND_UNKNOWN, "", -1},
+    {"partly-cloudy", COND_PARTLY_CLOUDY, "Малооблачно", -1},
+    {"", COND_UNKNOWN, "", -1},
+    {"", COND_UNKNOWN, "", -1},
+    {"wet-snow", COND_WET_SNOW, "Дождь со снегом", -1},
+    {"", COND_UNKNOWN, "", -1},
+    {"moderate-rain", COND_MODERATE_RAIN, "Умеренно сильный дождь", -1},
+    {"", COND_UNKNOWN, "", -1},
+    {"cloudy", COND_CLOUDY, "Облачно с прояснениями", -1},
+    {"", COND_UNKNOWN, "", -1},
+    {"", COND_UNKNOWN, "", -1},
+    {"", COND_UNKNOWN, "", -1},
+    {"light-snow", COND_LIGHT_SNOW, "Небольшой снег", -1},
+    {"light-rain", COND_LIGHT_RAIN, "Небольшой дождь", -1},
+    {"", COND_UNKNOWN, "", -1},
+    {"", COND_UNKNOWN, "", -1},
+    {"", COND_UNKNOWN, "", -1},
+    {"", COND_UNKNOWN, "", -1},
+    {"", COND_UNKNOWN, "", -1},
+    {"", COND_UNKNOWN, "", -1},
+    {"", COND_UNKNOWN, "", -1},
+    {"", COND_UNKNOWN, "", -1},
+    {"hail", COND_HAIL, "Град", -1},
+    {"", COND_UNKNOWN, "", -1},
+    {"", COND_UNKNOWN, "", -1},
+    {"snow-showers", COND_SNOW_SHOWERS, "Снегопад", -1},
+    {"continuous-heavy-rain", COND_CONTINUOUS_HEAVY_RAIN, "Длительный сильный дождь", -1},
+    {"", COND_UNKNOWN, "", -1},
+    {"", COND_UNKNOWN, "", -1},
+    {"", COND_UNKNOWN, "", -1},
+    {"", COND_UNKNOWN, "", -1},
+    {"", COND_UNKNOWN, "", -1},
+    {"", COND_UNKNOWN, "", -1},
+    {"", COND_UNKNOWN, "", -1},
+    {"", COND_UNKNOWN, "", -1},
+    {"", COND_UNKNOWN, "", -1},
+    {"", COND_UNKNOWN, "", -1},
+    {"", COND_UNKNOWN, "", -1},
+    {"rain", COND_RAIN, "Дождь", -1},
+    {"", COND_UNKNOWN, "", -1},
+    {"", COND_UNKNOWN, "", -1},
+    {"", COND_UNKNOWN, "", -1},
+    {"", COND_UNKNOWN, "", -1},
+    {"showers", COND_SHOWERS, "Ливень", -1},
+    {"", COND_UNKNOWN, "", -1},
+    {"", COND_UNKNOWN, "", -1},
+    {"", COND_UNKNOWN, "", -1},
+    {"thunderstorm-with-rain", COND_THUNDERSTORM_WITH_RAIN, "Дождь с грозой", -1},
+    {"", COND_UNKNOWN, "", -1},
+    {"clear", COND_CLEAR, "Ясно", -1},
+};
+static_assert(vocab_slot("clear", CONDITION_SEED, CONDITION_SLOTS) == 63, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("partly-cloudy", CONDITION_SEED, CONDITION_SLOTS) == 15, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("cloudy", CONDITION_SEED, CONDITION_SLOTS) == 22, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("overcast", CONDITION_SEED, CONDITION_SLOTS) == 11, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("drizzle", CONDITION_SEED, CONDITION_SLOTS) == 12, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("light-rain", CONDITION_SEED, CONDITION_SLOTS) == 27, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("rain", CONDITION_SEED, CONDITION_SLOTS) == 52, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("moderate-rain", CONDITION_SEED, CONDITION_SLOTS) == 20, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("heavy-rain", CONDITION_SEED, CONDITION_SLOTS) == 6, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("continuous-heavy-rain", CONDITION_SEED, CONDITION_SLOTS) == 40, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("showers", CONDITION_SEED, CONDITION_SLOTS) == 57, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("wet-snow", CONDITION_SEED, CONDITION_SLOTS) == 18, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("light-snow", CONDITION_SEED, CONDITION_SLOTS) == 26, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("snow", CONDITION_SEED, CONDITION_SLOTS) == 1, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("snow-showers", CONDITION_SEED, CONDITION_SLOTS) == 39, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("hail", CONDITION_SEED, CONDITION_SLOTS) == 36, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("thunderstorm", CONDITION_SEED, CONDITION_SLOTS) == 13, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("thunderstorm-with-rain", CONDITION_SEED, CONDITION_SLOTS) == 61, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("thunderstorm-with-hail", CONDITION_SEED, CONDITION_SLOTS) == 9, "regenerate with tools/gen_vocab.py");
+
+// Indexed by condition_t
+constexpr uint8_t condition_slot[COND_COUNT] = {
+    CONDITION_UNKNOWN_SLOT, // COND_UNKNOWN
+    63, // COND_CLEAR
+    15, // COND_PARTLY_CLOUDY
+    22, // COND_CLOUDY
+    11, // COND_OVERCAST
+    12, // COND_DRIZZLE
+    27, // COND_LIGHT_RAIN
+    52, // COND_RAIN
+    20, // COND_MODERATE_RAIN
+    6, // COND_HEAVY_RAIN
+    40, // COND_CONTINUOUS_HEAVY_RAIN
+    57, // COND_SHOWERS
+    18, // COND_WET_SNOW
+    26, // COND_LIGHT_SNOW
+    1, // COND_SNOW
+    39, // COND_SNOW_SHOWERS
+    36, // COND_HAIL
+    13, // COND_THUNDERSTORM
+    61, // COND_THUNDERSTORM_WITH_RAIN
+    9, // COND_THUNDERSTORM_WITH_HAIL
+};
+static_assert(condition_table[condition_slot[COND_CLEAR]].value == COND_CLEAR, "condition_t changed, regenerate with tools/gen_vocab.py");
+static_assert(condition_table[condition_slot[COND_PARTLY_CLOUDY]].value == COND_PARTLY_CLOUDY, "condition_t changed, regenerate with tools/gen_vocab.py");
+static_assert(condition_table[condition_slot[COND_CLOUDY]].value == COND_CLOUDY, "condition_t changed, regenerate with tools/gen_vocab.py");
+static_assert(condition_table[condition_slot[COND_OVERCAST]].value == COND_OVERCAST, "condition_t changed, regenerate with tools/gen_vocab.py");
+static_assert(condition_table[condition_slot[COND_DRIZZLE]].value == COND_DRIZZLE, "condition_t changed, regenerate with tools/gen_vocab.py");
+static_assert(condition_table[condition_slot[COND_LIGHT_RAIN]].value == COND_LIGHT_RAIN, "condition_t changed, regenerate with tools/gen_vocab.py");
+static_assert(condition_table[condition_slot[COND_RAIN]].value == COND_RAIN, "condition_t changed, regenerate with tools/gen_vocab.py");
+static_assert(condition_table[condition_slot[COND_MODERATE_RAIN]].value == COND_MODERATE_RAIN, "condition_t changed, regenerate with tools/gen_vocab.py");
+static_assert(condition_table[condition_slot[COND_HEAVY_RAIN]].value == COND_HEAVY_RAIN, "condition_t changed, regenerate with tools/gen_vocab.py");
+static_assert(condition_table[condition_slot[COND_CONTINUOUS_HEAVY_RAIN]].value == COND_CONTINUOUS_HEAVY_RAIN, "condition_t changed, regenerate with tools/gen_vocab.py");
+static_assert(condition_table[condition_slot[COND_SHOWERS]].value == COND_SHOWERS, "condition_t changed, regenerate with tools/gen_vocab.py");
+static_assert(condition_table[condition_slot[COND_WET_SNOW]].value == COND_WET_SNOW, "condition_t changed, regenerate with tools/gen_vocab.py");
+static_assert(condition_table[condition_slot[COND_LIGHT_SNOW]].value == COND_LIGHT_SNOW, "condition_t changed, regenerate with tools/gen_vocab.py");
+static_assert(condition_table[condition_slot[COND_SNOW]].value == COND_SNOW, "condition_t changed, regenerate with tools/gen_vocab.py");
+static_assert(condition_table[condition_slot[COND_SNOW_SHOWERS]].value == COND_SNOW_SHOWERS, "condition_t changed, regenerate with tools/gen_vocab.py");
+static_assert(condition_table[condition_slot[COND_HAIL]].value == COND_HAIL, "condition_t changed, regenerate with tools/gen_vocab.py");
+static_assert(condition_table[condition_slot[COND_THUNDERSTORM]].value == COND_THUNDERSTORM, "condition_t changed, regenerate with tools/gen_vocab.py");
+static_assert(condition_table[condition_slot[COND_THUNDERSTORM_WITH_RAIN]].value == COND_THUNDERSTORM_WITH_RAIN, "condition_t changed, regenerate with tools/gen_vocab.py");
+static_assert(condition_table[condition_slot[COND_THUNDERSTORM_WITH_HAIL]].value == COND_THUNDERSTORM_WITH_HAIL, "condition_t changed, regenerate with tools/gen_vocab.py");
+
+#define DAYTIME_SEED 0x00000001u
+#define DAYTIME_SLOTS 4
+#define DAYTIME_UNKNOWN_SLOT 0
+constexpr vocab_entry_t daytime_table[DAYTIME_SLOTS] = {
+    {"", DAYTIME_UNKNOWN, "", -1},
+    {"n", DAYTIME_NIGHT, "Ночь", -1},
+    {"", DAYTIME_UNKNOWN, "", -1},
+    {"d", DAYTIME_DAY, "День", -1},
+};
+static_assert(vocab_slot("d", DAYTIME_SEED, DAYTIME_SLOTS) == 3, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("n", DAYTIME_SEED, DAYTIME_SLOTS) == 1, "regenerate with tools/gen_vocab.py");
+
+// Indexed by daytime_t
+constexpr uint8_t daytime_slot[DAYTIME_COUNT] = {
+    DAYTIME_UNKNOWN_SLOT, // DAYTIME_UNKNOWN
+    3, // DAYTIME_DAY
+    1, // DAYTIME_NIGHT
+};
+static_assert(daytime_table[daytime_slot[DAYTIME_DAY]].value == DAYTIME_DAY, "daytime_t changed, regenerate with tools/gen_vocab.py");
+static_assert(daytime_table[daytime_slot[DAYTIME_NIGHT]].value == DAYTIME_NIGHT, "daytime_t changed, regenerate with tools/gen_vocab.py");
+
+#define SEASON_SEED 0x00000004u
+#define SEASON_SLOTS 16
+#define SEASON_UNKNOWN_SLOT 0
+constexpr vocab_entry_t season_table[SEASON_SLOTS] = {
+    {"", SEASON_UNKNOWN, "", -1},
+    {"spring", SEASON_SPRING, "Весна", -1},
+    {"", SEASON_UNKNOWN, "", -1},
+    {"", SEASON_UNKNOWN, "", -1},
+    {"", SEASON_UNKNOWN, "", -1},
+    {"", SEASON_UNKNOWN, "", -1},
+    {"", SEASON_UNKNOWN, "", -1},
+    {"", SEASON_UNKNOWN, "", -1},
+    {"", SEASON_UNKNOWN, "", -1},
+    {"summer", SEASON_SUMMER, "Лето", -1},
+    {"", SEASON_UNKNOWN, "", -1},
+    {"", SEASON_UNKNOWN, "", -1},
+    {"", SEASON_UNKNOWN, "", -1},
+    {"winter", SEASON_WINTER, "Зима", -1},
+    {"autumn", SEASON_AUTUMN, "Осень", -1},
+    {"", SEASON_UNKNOWN, "", -1},
+};
+static_assert(vocab_slot("summer", SEASON_SEED, SEASON_SLOTS) == 9, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("autumn", SEASON_SEED, SEASON_SLOTS) == 14, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("winter", SEASON_SEED, SEASON_SLOTS) == 13, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("spring", SEASON_SEED, SEASON_SLOTS) == 1, "regenerate with tools/gen_vocab.py");
+
+// Indexed by season_t
+constexpr uint8_t season_slot[SEASON_COUNT] = {
+    SEASON_UNKNOWN_SLOT, // SEASON_UNKNOWN
+    9, // SEASON_SUMMER
+    14, // SEASON_AUTUMN
+    13, // SEASON_WINTER
+    1, // SEASON_SPRING
+};
+static_assert(season_table[season_slot[SEASON_SUMMER]].value == SEASON_SUMMER, "season_t changed, regenerate with tools/gen_vocab.py");
+static_assert(season_table[season_slot[SEASON_AUTUMN]].value == SEASON_AUTUMN, "season_t changed, regenerate with tools/gen_vocab.py");
+static_assert(season_table[season_slot[SEASON_WINTER]].value == SEASON_WINTER, "season_t changed, regenerate with tools/gen_vocab.py");
+static_assert(season_table[season_slot[SEASON_SPRING]].value == SEASON_SPRING, "season_t changed, regenerate with tools/gen_vocab.py");
+
+#define PART_NAME_SEED 0x00000003u
+#define PART_NAME_SLOTS 8
+#define PART_NAME_UNKNOWN_SLOT 0
+constexpr vocab_entry_t part_name_table[PART_NAME_SLOTS] = {
+    {"", PART_UNKNOWN, "", -1},
+    {"evening", PART_EVENING, "Вечер", -1},
+    {"", PART_UNKNOWN, "", -1},
+    {"night", PART_NIGHT, "Ночь", -1},
+    {"", PART_UNKNOWN, "", -1},
+    {"morning", PART_MORNING, "Утро", -1},
+    {"", PART_UNKNOWN, "", -1},
+    {"day", PART_DAY, "День", -1},
+};
+static_assert(vocab_slot("night", PART_NAME_SEED, PART_NAME_SLOTS) == 3, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("morning", PART_NAME_SEED, PART_NAME_SLOTS) == 5, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("day", PART_NAME_SEED, PART_NAME_SLOTS) == 7, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("evening", PART_NAME_SEED, PART_NAME_SLOTS) == 1, "regenerate with tools/gen_vocab.py");
+
+// Indexed by part_name_t
+constexpr uint8_t part_name_slot[PART_COUNT] = {
+    PART_NAME_UNKNOWN_SLOT, // PART_UNKNOWN
+    3, // PART_NIGHT
+    5, // PART_MORNING
+    7, // PART_DAY
+    1, // PART_EVENING
+};
+static_assert(part_name_table[part_name_slot[PART_NIGHT]].value == PART_NIGHT, "part_name_t changed, regenerate with tools/gen_vocab.py");
+static_assert(part_name_table[part_name_slot[PART_MORNING]].value == PART_MORNING, "part_name_t changed, regenerate with tools/gen_vocab.py");
+static_assert(part_name_table[part_name_slot[PART_DAY]].value == PART_DAY, "part_name_t changed, regenerate with tools/gen_vocab.py");
+static_assert(part_name_table[part_name_slot[PART_EVENING]].value == PART_EVENING, "part_name_t changed, regenerate with tools/gen_vocab.py");
+
+#define WIND_DIR_SEED 0x00000001u
+#define WIND_DIR_SLOTS 32
+#define WIND_DIR_UNKNOWN_SLOT 0
+constexpr vocab_entry_t wind_dir_table[WIND_DIR_SLOTS] = {
+    {"", WIND_UNKNOWN, "", -1},
+    {"", WIND_UNKNOWN, "", -1},
+    {"w", WIND_W, "W", 270},
+    {"", WIND_UNKNOWN, "", -1},
+    {"", WIND_UNKNOWN, "", -1},
+    {"", WIND_UNKNOWN, "", -1},
+    {"c", WIND_CALM, "C", -1},
+    {"", WIND_UNKNOWN, "", -1},
+    {"ne", WIND_NE, "NE", 45},
+    {"se", WIND_SE, "SE", 135},
+    {"", WIND_UNKNOWN, "", -1},
+    {"", WIND_UNKNOWN, "", -1},
+    {"e", WIND_E, "E", 90},
+    {"", WIND_UNKNOWN, "", -1},
+    {"", WIND_UNKNOWN, "", -1},
+    {"", WIND_UNKNOWN, "", -1},
+    {"", WIND_UNKNOWN, "", -1},
+    {"", WIND_UNKNOWN, "", -1},
+    {"", WIND_UNKNOWN, "", -1},
+    {"sw", WIND_SW, "SW", 225},
+    {"", WIND_UNKNOWN, "", -1},
+    {"", WIND_UNKNOWN, "", -1},
+    {"s", WIND_S, "S", 180},
+    {"", WIND_UNKNOWN, "", -1},
+    {"", WIND_UNKNOWN, "", -1},
+    {"", WIND_UNKNOWN, "", -1},
+    {"", WIND_UNKNOWN, "", -1},
+    {"", WIND_UNKNOWN, "", -1},
+    {"", WIND_UNKNOWN, "", -1},
+    {"n", WIND_N, "N", 0},
+    {"nw", WIND_NW, "NW", 315},
+    {"", WIND_UNKNOWN, "", -1},
+};
+static_assert(vocab_slot("c", WIND_DIR_SEED, WIND_DIR_SLOTS) == 6, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("n", WIND_DIR_SEED, WIND_DIR_SLOTS) == 29, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("ne", WIND_DIR_SEED, WIND_DIR_SLOTS) == 8, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("e", WIND_DIR_SEED, WIND_DIR_SLOTS) == 12, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("se", WIND_DIR_SEED, WIND_DIR_SLOTS) == 9, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("s", WIND_DIR_SEED, WIND_DIR_SLOTS) == 22, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("sw", WIND_DIR_SEED, WIND_DIR_SLOTS) == 19, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("w", WIND_DIR_SEED, WIND_DIR_SLOTS) == 2, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("nw", WIND_DIR_SEED, WIND_DIR_SLOTS) == 30, "regenerate with tools/gen_vocab.py");
+
+// Indexed by wind_dir_t
+constexpr uint8_t wind_dir_slot[WIND_COUNT] = {
+    WIND_DIR_UNKNOWN_SLOT, // WIND_UNKNOWN
+    6, // WIND_CALM
+    29, // WIND_N
+    8, // WIND_NE
+    12, // WIND_E
+    9, // WIND_SE
+    22, // WIND_S
+    19, // WIND_SW
+    2, // WIND_W
+    30, // WIND_NW
+};
+static_assert(wind_dir_table[wind_dir_slot[WIND_CALM]].value == WIND_CALM, "wind_dir_t changed, regenerate with tools/gen_vocab.py");
+static_assert(wind_dir_table[wind_dir_slot[WIND_N]].value == WIND_N, "wind_dir_t changed, regenerate with tools/gen_vocab.py");
+static_assert(wind_dir_table[wind_dir_slot[WIND_NE]].value == WIND_NE, "wind_dir_t changed, regenerate with tools/gen_vocab.py");
+static_assert(wind_dir_table[wind_dir_slot[WIND_E]].value == WIND_E, "wind_dir_t changed, regenerate with tools/gen_vocab.py");
+static_assert(wind_dir_table[wind_dir_slot[WIND_SE]].value == WIND_SE, "wind_dir_t changed, regenerate with tools/gen_vocab.py");
+static_assert(wind_dir_table[wind_dir_slot[WIND_S]].value == WIND_S, "wind_dir_t changed, regenerate with tools/gen_vocab.py");
+static_assert(wind_dir_table[wind_dir_slot[WIND_SW]].value == WIND_SW, "wind_dir_t changed, regenerate with tools/gen_vocab.py");
+static_assert(wind_dir_table[wind_dir_slot[WIND_W]].value == WIND_W, "wind_dir_t changed, regenerate with tools/gen_vocab.py");
+static_assert(wind_dir_table[wind_dir_slot[WIND_NW]].value == WIND_NW, "wind_dir_t changed, regenerate with tools/gen_vocab.py");
+
+#define ICON_SEED 0x00000016u
+#define ICON_SLOTS 128
+#define ICON_UNKNOWN_SLOT 1
+constexpr vocab_entry_t icon_table[ICON_SLOTS] = {
+    {"ovc_ts_ra", 0, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"bkn_sn_d", 12, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"bkn_-sn_d", 15, "", -1},
+    {"ovc_sn", 16, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"ovc_+ra", 23, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"bkn_n", 28, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"skc_n", 40, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"ovc_ra_sn", 44, "", -1},
+    {"bkn_+ra_d", 45, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"ovc_ra", 48, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"skc_d", 54, "", -1},
+    {"bkn_-ra_d", 55, "", -1},
+    {"bkn_ra_d", 56, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"bkn_-ra_n", 69, "", -1},
+    {"bkn_ra_n", 70, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"bkn_sn_n", 74, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"bkn_-sn_n", 77, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"bl", 80, "", -1},
+    {"ovc_-ra", 81, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"bkn_d", 90, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"ovc_+sn", 99, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"ovc_-sn", 105, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"ovc_ts", 108, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"fg_d", 110, "", -1},
+    {"bkn_+ra_n", 111, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"ovc", 124, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+    {"", ICON_NONE, "", -1},
+};
+static_assert(vocab_slot("bkn_+ra_d", ICON_SEED, ICON_SLOTS) == 45, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("bkn_+ra_n", ICON_SEED, ICON_SLOTS) == 111, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("bkn_-ra_d", ICON_SEED, ICON_SLOTS) == 55, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("bkn_-ra_n", ICON_SEED, ICON_SLOTS) == 69, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("bkn_-sn_d", ICON_SEED, ICON_SLOTS) == 15, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("bkn_-sn_n", ICON_SEED, ICON_SLOTS) == 77, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("bkn_d", ICON_SEED, ICON_SLOTS) == 90, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("bkn_n", ICON_SEED, ICON_SLOTS) == 28, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("bkn_ra_d", ICON_SEED, ICON_SLOTS) == 56, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("bkn_ra_n", ICON_SEED, ICON_SLOTS) == 70, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("bkn_sn_d", ICON_SEED, ICON_SLOTS) == 12, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("bkn_sn_n", ICON_SEED, ICON_SLOTS) == 74, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("bl", ICON_SEED, ICON_SLOTS) == 80, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("fg_d", ICON_SEED, ICON_SLOTS) == 110, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("ovc", ICON_SEED, ICON_SLOTS) == 124, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("ovc_+ra", ICON_SEED, ICON_SLOTS) == 23, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("ovc_+sn", ICON_SEED, ICON_SLOTS) == 99, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("ovc_-ra", ICON_SEED, ICON_SLOTS) == 81, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("ovc_-sn", ICON_SEED, ICON_SLOTS) == 105, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("ovc_ra", ICON_SEED, ICON_SLOTS) == 48, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("ovc_ra_sn", ICON_SEED, ICON_SLOTS) == 44, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("ovc_sn", ICON_SEED, ICON_SLOTS) == 16, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("ovc_ts", ICON_SEED, ICON_SLOTS) == 108, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("ovc_ts_ra", ICON_SEED, ICON_SLOTS) == 0, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("skc_d", ICON_SEED, ICON_SLOTS) == 54, "regenerate with tools/gen_vocab.py");
+static_assert(vocab_slot("skc_n", ICON_SEED, ICON_SLOTS) == 40, "regenerate with tools/gen_vocab.py");
+
+#endif /* WEATHER_VOCAB_TABLE_H_ */
@@ -0,0 +1,108 @@
+#include "clock_sync.h"
+#include <sys/time.h>
+
+typedef struct
+{
+    int64_t syncTime; // us since the epoch of the last sync, 0 - never synced
+    int64_t applied;  // us the clock was set back for the drift since then
+    float drift;      // ppm the clock runs fast by, in deep sleep mostly
+    float driftError; // ppm the last estimates were off by
+    uint16_t wakes;   // Since the sync
+    uint8_t samples;  // Drift measurements so far
+} clock_state_t;
+
+RTC_DATA_ATTR static clock_state_t state = {0, 0, 0, CLOCK_DRIFT_UNKNOWN, 0, 0};
+
+static uint32_t error_at(int64_t time);
+static void set_us(int64_t time);
+
+void clock_wake()
+{
+    state.wakes++;
+    if (state.syncTime == 0 || state.samples == 0)
+        return;
+    // The clock counted raw us since the sync, the true time is raw / (1 + drift) of them
+    int64_t now = clock_now();
+    int64_t raw = now + state.applied - state.syncTime;
+    int64_t fix = raw - (int64_t)(raw / (1.0 + state.drift * 1e-6)) - state.applied;
+    set_us(now - fix);
+    state.applied += fix;
+    log_i("clock: %.1f ms taken out for %.0f ppm, %u wake(s) since NTP, off by %u ms at most", fix / 1000.0,
+          state.drift, state.wakes, clock_error());
+}
+
+bool clock_sync_due()
+{
+    return state.syncTime == 0 || state.wakes >= CLOCK_SYNC_WAKES || clock_error() > CLOCK_MAX_ERROR;
+}
+
+void clock_sync(int64_t offset)
+{
+    int64_t now = clock_now();
+    int64_t truth = now + offset;
+    if (state.syncTime != 0 && truth - state.syncTime >= CLOCK_MIN_SPAN * 1000000LL)
+    {
+        int64_t elapsed = truth - state.syncTime;
+        int64_t raw = now + state.applied - state.syncTime;
+        float sample = ((double)raw / elapsed - 1.0) * 1e6;
+        if (state.samples == 0)
+            state.drift = sample;
+        else
+        {
+            // The error estimate jumps up with a miss and decays while the estimates hold
+            state.driftError = max(max(fabsf(sample - state.drift), state.driftError * 3 / 4), (float)CLOCK_DRIFT_MIN_ERROR);
+            state.drift += (sample - state.drift) / 2;
+        }
+        if (state.samples < UINT8_MAX)
+            state.samples++;
+    }
+    log_i("clock: NTP moved it by %.1f ms after %u wake(s), drift %.0f ppm +- %.0f", offset / 1000.0, state.wakes,
+          state.drift, state.driftError);
+    set_us(truth);
+    state.syncTime = truth;
+    state.applied = 0;
+    state.wakes = 0;
+}
+
+uint32_t clock_error()
+{
+    return error_at(clock_now());
+}
+
+uint64_t clock_sleep(int64_t until)
+{
+    int64_t now = clock_now();
+    // Late by the error the clock can have then rather than early
+    int64_t margin = constrain(error_at(until), (uint32_t)CLOCK_MARGIN, (uint32_t)CLOCK_MAX_MARGIN) * 1000LL;
+    int64_t left = max(until - now, (int64_t)0) + margin;
+    return left * (1.0 + state.drift * 1e-6);
+}
+
+float clock_drift()
+{
+    return state.drift;
+}
+
+int64_t clock_now()
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+// ms the clock can be off by at the time
+static uint32_t error_at(int64_t time)
+{
+    if (state.syncTime == 0)
+        return UINT32_MAX;
+    float ppm = (state.samples > 0) ? state.driftError : CLOCK_DRIFT_UNKNOWN;
+    // A clock set back behind the sync (a sleep time cut short, a jump of NTP) has drifted for no time yet
+    int64_t elapsed = max(time - state.syncTime, (int64_t)0);
+    return elapsed / 1000 * ppm * 1e-6;
+}
+
+static void set_us(int64_t time)
+{
+    struct timeval tv = {(time_t)(time / 1000000), (suseconds_t)(time % 1000000)};
+    settimeofday(&tv, NULL);
+}
@@ -0,0 +1,673 @@
+#include "display_list.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include "raster.h"
+#include "icon_scale.h"
+#include "glyph_cache.h"
+
+#define DL_MAGIC 0x4C445759 // "YWDL" read as a little endian word
+#define DL_VERSION 1
+#define DL_FILL 0x01
+#define DL_AA 0x02
+
+enum dl_type
+{
+    DL_TEXT,
+    DL_LINE,
+    DL_RECT,
+    DL_TRIANGLE,
+    DL_CIRCLE,
+    DL_ARC,
+    DL_PIXEL,
+    DL_ATLAS,
+    DL_SCALED,
+    DL_BITMAP
+};
+
+typedef struct
+{
+    // Hashed as they are, the record functions zero the struct first
+    uint8_t type;
+    uint8_t color;
+    uint8_t thickness;
+    uint8_t flags;
+    int16_t x, y;
+    int16_t a, b, c, d; // Line: x1, y1; rect: w, h; triangle: x1, y1, x2, y2; circle: r; arc: r, start, end;
+                        // images: w, h
+    // Not hashed
+    uint32_t data; // Text run, atlas entry, image name or bitmap in the arena
+    damage_t box;
+    uint32_t hash;
+} dl_cmd_t;
+
+#define DL_KEY_SIZE 16 // type .. d
+
+// What is saved of a command
+typedef struct
+{
+    damage_t box;
+    uint32_t hash;
+} dl_entry_t;
+
+typedef struct
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;
+} dl_header_t;
+
+// An atlas or scaled image read ahead, as image_draw() takes it
+typedef struct
+{
+    uint8_t *data;
+    size_t size;
+    uint8_t encoding;
+    int16_t width, height;
+} dl_image_t;
+
+// A glyph reserved in the cache, inflated by one of the bands
+typedef struct
+{
+    const GFXfont *font;
+    const GFXglyph *glyph;
+    uint8_t *bitmap;
+} dl_glyph_t;
+
+typedef struct
+{
+    const uint16_t *order; // Commands to draw
+    const dl_image_t *images;
+    uint16_t count;
+    const dl_glyph_t *glyphs; // Every bands-th of them from index on is inflated by this band
+    uint16_t glyphCnt;
+    uint8_t index;
+    uint8_t bands;
+    uint8_t worker; // Decompressor of glyph_cache_fill()
+    uint8_t *framebuffer;
+    int16_t top, bottom; // Rows of the band
+    uint32_t inflateTime;
+    uint32_t drawTime;
+} dl_band_t;
+
+static dl_cmd_t *cmds = NULL;
+static uint16_t cmdCnt = 0;
+static uint16_t cmdMax = 0;
+static uint8_t *arena = NULL; // Payloads of the commands
+static uint32_t arenaSize = 0;
+static uint32_t arenaMax = 0;
+static uint16_t aheadCnt = 0; // cmds[0 .. aheadCnt - 1] are in the framebuffer already, dl_draw_ahead()
+static uint8_t bandCnt = DL_BANDS;
+static SemaphoreHandle_t bandDone = NULL; // A band task is through a phase
+static SemaphoreHandle_t bandGo = NULL;   // All glyphs are inflated, draw
+
+static dl_cmd_t *add(uint8_t type, uint8_t color, int x, int y, int bx, int by, int bw, int bh);
+static bool store(dl_cmd_t *cmd, const void *data, size_t size);
+static void finish(dl_cmd_t *cmd, const void *payload, size_t size);
+static bool clip(int x, int y, int w, int h, damage_t &r);
+static bool touches(const damage_t &box, const damage_t *regions, int n);
+static uint32_t fnv(const void *data, size_t size, uint32_t hash);
+static int entry_cmp(const void *a, const void *b);
+static void read_image(fs::FS &fs, const dl_cmd_t &cmd, dl_image_t &image);
+static bool reserve_glyphs(const text_run_t &run, dl_glyph_t *glyphs, uint16_t &glyphCnt);
+static void split(const uint16_t *order, uint16_t count, int bands, dl_band_t *band);
+static void band_task(void *arg);
+static void inflate_band(dl_band_t &band);
+static void draw_band(dl_band_t &band);
+static void draw_cmd(const dl_cmd_t &cmd, const dl_image_t &image, uint8_t *framebuffer, int top, int bottom);
+
+void dl_clear()
+{
+    cmdCnt = 0;
+    arenaSize = 0;
+    aheadCnt = 0;
+}
+
+void dl_text(const text_run_t &run, int x, int y)
+{
+    // The box is mirrored around the baseline: the glyphs cover y - (y1 + h) .. y - y1
+    dl_cmd_t *cmd = add(DL_TEXT, 0, x, y, x + run.x1 - 1, y - run.y1 - run.h - 1, run.w + 2, run.h + 2);
+    if (cmd == NULL)
+        return;
+    if (!store(cmd, &run, sizeof(run)))
+        return;
+    // The glyphs and where they go, the rest of the run is left over from longer strings
+    uint32_t hash = fnv(&run.font, sizeof(run.font), 2166136261u);
+    hash = fnv(run.glyph, run.count * sizeof(run.glyph[0]), hash);
+    hash = fnv(run.pen, run.count * sizeof(run.pen[0]), hash);
+    finish(cmd, &hash, sizeof(hash));
+}
+
+void dl_line(int x0, int y0, int x1, int y1, uint8_t color)
+{
+    dl_cmd_t *cmd = add(DL_LINE, color, x0, y0, min(x0, x1), min(y0, y1), abs(x1 - x0) + 1, abs(y1 - y0) + 1);
+    if (cmd == NULL)
+        return;
+    cmd->a = x1;
+    cmd->b = y1;
+    finish(cmd, NULL, 0);
+}
+
+void dl_rect(int x, int y, int w, int h, uint8_t color, bool fill)
+{
+    dl_cmd_t *cmd = add(DL_RECT, color, x, y, x, y, w, h);
+    if (cmd == NULL)
+        return;
+    cmd->a = w;
+    cmd->b = h;
+    cmd->flags = fill ? DL_FILL : 0;
+    finish(cmd, NULL, 0);
+}
+
+void dl_triangle(int x0, int y0, int x1, int y1, int x2, int y2, uint8_t color)
+{
+    int bx = min(x0, min(x1, x2)), by = min(y0, min(y1, y2));
+    dl_cmd_t *cmd = add(DL_TRIANGLE, color, x0, y0, bx, by, max(x0, max(x1, x2)) - bx + 1, max(y0, max(y1, y2)) - by + 1);
+    if (cmd == NULL)
+        return;
+    cmd->a = x1;
+    cmd->b = y1;
+    cmd->c = x2;
+    cmd->d = y2;
+    finish(cmd, NULL, 0);
+}
+
+void dl_circle(int x, int y, int r, uint8_t color, bool fill)
+{
+    dl_cmd_t *cmd = add(DL_CIRCLE, color, x, y, x - r, y - r, 2 * r + 1, 2 * r + 1);
+    if (cmd == NULL)
+        return;
+    cmd->a = r;
+    cmd->flags = fill ? DL_FILL : 0;
+    finish(cmd, NULL, 0);
+}
+
+void dl_arc(int x, int y, int r, int16_t start, int16_t end, uint8_t thickness, uint8_t color, bool aa)
+{
+    int outer = r + thickness;
+    dl_cmd_t *cmd = add(DL_ARC, color, x, y, x - outer, y - outer, 2 * outer + 1, 2 * outer + 1);
+    if (cmd == NULL)
+        return;
+    cmd->a = r;
+    cmd->b = start;
+    cmd->c = end;
+    cmd->thickness = thickness;
+    cmd->flags = aa ? DL_AA : 0;
+    finish(cmd, NULL, 0);
+}
+
+void dl_pixel(int x, int y, uint8_t color)
+{
+    dl_cmd_t *cmd = add(DL_PIXEL, color, x, y, x, y, 1, 1);
+    if (cmd != NULL)
+        finish(cmd, NULL, 0);
+}
+
+void dl_atlas(const atlas_entry_t &entry, int x, int y)
+{
+    dl_cmd_t *cmd = add(DL_ATLAS, 0, x, y, x, y, entry.width, entry.height);
+    if (cmd == NULL)
+        return;
+    if (!store(cmd, &entry, sizeof(entry)))
+        return;
+    finish(cmd, &entry, sizeof(entry));
+}
+
+void dl_scaled(const char *large, int w, int h, int x, int y)
+{
+    dl_cmd_t *cmd = add(DL_SCALED, 0, x, y, x, y, w, h);
+    if (cmd == NULL)
+        return;
+    cmd->a = w;
+    cmd->b = h;
+    if (!store(cmd, large, strlen(large) + 1))
+        return;
+    finish(cmd, large, strlen(large));
+}
+
+void dl_bitmap(const uint8_t *data, int w, int h, int x, int y)
+{
+    dl_cmd_t *cmd = add(DL_BITMAP, 0, x, y, x, y, w, h);
+    if (cmd == NULL)
+        return;
+    cmd->a = w;
+    cmd->b = h;
+    size_t size = (w + 1) / 2 * h;
+    if (!store(cmd, data, size))
+        return;
+    finish(cmd, data, size);
+}
+
+uint16_t dl_count()
+{
+    return cmdCnt;
+}
+
+uint32_t dl_hash()
+{
+    uint32_t hash = 2166136261u;
+    for (uint16_t i = 0; i < cmdCnt; i++)
+        hash = fnv(&cmds[i].hash, sizeof(cmds[i].hash), hash);
+    return hash;
+}
+
+void dl_draw(fs::FS &fs, uint8_t *framebuffer, const damage_t *regions, int n)
+{
+    uint32_t start = micros();
+    (void)start; // Only logged
+    uint16_t *order = (uint16_t *)ps_malloc(cmdCnt * sizeof(uint16_t) + 1);
+    uint16_t count = 0;
+    uint32_t glyphMax = 0;
+    for (uint16_t i = aheadCnt; i < cmdCnt && order != NULL; i++)
+    {
+        if (n > 0 && !touches(cmds[i].box, regions, n))
+            continue;
+        order[count++] = i;
+        if (cmds[i].type == DL_TEXT)
+            glyphMax += ((const text_run_t *)(arena + cmds[i].data))->count;
+    }
+    dl_image_t *images = (dl_image_t *)ps_calloc(count + 1, sizeof(dl_image_t));
+    dl_glyph_t *glyphs = (dl_glyph_t *)ps_malloc(glyphMax * sizeof(dl_glyph_t) + 1);
+    if (order == NULL || images == NULL || glyphs == NULL)
+    {
+        log_i("display list: no memory to draw %u commands", cmdCnt);
+        free(order);
+        free(images);
+        free(glyphs);
+        return;
+    }
+    int bands = (count >= DL_BAND_MIN) ? bandCnt : 1;
+    if (bands > 1 && bandDone == NULL)
+    {
+        bandDone = xSemaphoreCreateCounting(DL_MAX_BANDS, 0);
+        bandGo = xSemaphoreCreateCounting(DL_MAX_BANDS, 0);
+    }
+    if (bandDone == NULL || bandGo == NULL)
+        bands = 1;
+
+    // Files and caches are only touched here; the bands inflate the glyphs reserved and draw
+    uint16_t glyphCnt = 0;
+    bool reserved = (bands > 1);
+    for (uint16_t k = 0; k < count; k++)
+    {
+        const dl_cmd_t &cmd = cmds[order[k]];
+        read_image(fs, cmd, images[k]);
+        if (reserved && cmd.type == DL_TEXT)
+            reserved = reserve_glyphs(*(const text_run_t *)(arena + cmd.data), glyphs, glyphCnt);
+    }
+    if (!reserved)
+        bands = 1; // The cache is full, glyphs are inflated as they are drawn; the reserved ones by band 0
+    log_i("display list: images and glyphs of %u commands read ahead in %u us", count, micros() - start);
+
+    dl_band_t band[DL_MAX_BANDS];
+    bool started[DL_MAX_BANDS] = {false};
+    split(order, count, bands, band);
+    for (int b = 0; b < bands; b++)
+    {
+        band[b].images = images;
+        band[b].glyphs = glyphs;
+        band[b].glyphCnt = glyphCnt;
+        band[b].index = b;
+        band[b].bands = bands;
+        band[b].worker = b;
+        band[b].framebuffer = framebuffer;
+        if (b > 0)
+            started[b] = xTaskCreatePinnedToCore(band_task, "dl_band", DL_BAND_STACK, &band[b], uxTaskPriorityGet(NULL),
+                                                 NULL, (xPortGetCoreID() + b) % portNUM_PROCESSORS) == pdPASS;
+        if (!started[b])
+            band[b].worker = 0; // This task does it
+    }
+    // All glyphs have to be inflated before any band draws, a band draws glyphs the others inflated
+    for (int b = 0; b < bands; b++)
+    {
+        if (!started[b])
+            inflate_band(band[b]);
+    }
+    for (int b = 1; b < bands; b++)
+    {
+        if (started[b])
+            xSemaphoreTake(bandDone, portMAX_DELAY);
+    }
+    if (bands > 1)
+        glyph_cache_freeze(true);
+    for (int b = 1; b < bands; b++)
+    {
+        if (started[b])
+            xSemaphoreGive(bandGo);
+    }
+    for (int b = 0; b < bands; b++)
+    {
+        if (!started[b])
+            draw_band(band[b]);
+    }
+    for (int b = 1; b < bands; b++)
+    {
+        if (started[b])
+            xSemaphoreTake(bandDone, portMAX_DELAY);
+    }
+    glyph_cache_freeze(false);
+
+    uint32_t inflateMax = 0, drawMax = 0;
+    for (int b = 0; b < bands; b++)
+    {
+        inflateMax = max(inflateMax, band[b].inflateTime);
+        drawMax = max(drawMax, band[b].drawTime);
+    }
+    for (uint16_t k = 0; k < count; k++)
+        free(images[k].data);
+    free(images);
+    free(glyphs);
+    free(order);
+    log_i("display list: %u of %u commands drawn in %u us, %d band(s) inflating %u glyphs in %u us and drawing in %u us "
+          "at most",
+          count, cmdCnt, micros() - start, bands, glyphCnt, inflateMax, drawMax);
+}
+
+void dl_draw_ahead(fs::FS &fs, uint8_t *framebuffer)
+{
+    dl_draw(fs, framebuffer);
+    aheadCnt = cmdCnt;
+}
+
+void dl_bands(int n)
+{
+    bandCnt = constrain(n, 1, DL_MAX_BANDS);
+}
+
+// A multiset difference of the entries: sorted by hash, the ones without a twin are what changed
+damage_t *dl_diff(fs::FS &fs, int &n)
+{
+    n = 0;
+    if (!fs.exists(DL_FILE))
+        return NULL;
+    File f = fs.open(DL_FILE, FILE_READ);
+    dl_header_t header;
+    if (!f || f.read((uint8_t *)&header, sizeof(header)) != sizeof(header) || header.magic != DL_MAGIC ||
+        header.version != DL_VERSION)
+        return NULL;
+    dl_entry_t *prev = (dl_entry_t *)ps_malloc((header.count + cmdCnt) * sizeof(dl_entry_t) + 1);
+    damage_t *regions = (damage_t *)ps_malloc((header.count + cmdCnt) * sizeof(damage_t) + 1);
+    size_t size = header.count * sizeof(dl_entry_t);
+    if (prev == NULL || regions == NULL || f.read((uint8_t *)prev, size) != size)
+    {
+        free(prev);
+        free(regions);
+        return NULL;
+    }
+    dl_entry_t *cur = prev + header.count;
+    for (uint16_t i = 0; i < cmdCnt; i++)
+        cur[i] = {cmds[i].box, cmds[i].hash};
+    qsort(prev, header.count, sizeof(dl_entry_t), entry_cmp);
+    qsort(cur, cmdCnt, sizeof(dl_entry_t), entry_cmp);
+    int i = 0, j = 0;
+    while (i < header.count || j < cmdCnt)
+    {
+        int cmp = (i == header.count) ? 1 : (j == cmdCnt) ? -1 : entry_cmp(&prev[i], &cur[j]);
+        if (cmp == 0)
+        {
+            i++;
+            j++;
+        }
+        else if (cmp < 0)
+            regions[n++] = prev[i++].box; // Gone, what it drew is wiped
+        else
+            regions[n++] = cur[j++].box; // New
+    }
+    free(prev);
+    return regions;
+}
+
+bool dl_save(fs::FS &fs)
+{
+    File f = fs.open(DL_FILE, FILE_WRITE);
+    dl_header_t header = {DL_MAGIC, DL_VERSION, cmdCnt};
+    bool res = f && f.write((uint8_t *)&header, sizeof(header)) == sizeof(header);
+    for (uint16_t i = 0; i < cmdCnt && res; i++)
+    {
+        dl_entry_t entry = {cmds[i].box, cmds[i].hash};
+        res = f.write((uint8_t *)&entry, sizeof(entry)) == sizeof(entry);
+    }
+    f.close();
+    log_i("display list saved: %d, %u commands", res, cmdCnt);
+    return res;
+}
+
+// A new command with the box clipped to the screen, NULL if it is off the screen or there is no memory
+static dl_cmd_t *add(uint8_t type, uint8_t color, int x, int y, int bx, int by, int bw, int bh)
+{
+    damage_t box;
+    if (!clip(bx, by, bw, bh, box))
+        return NULL;
+    if (cmdCnt == cmdMax)
+    {
+        uint16_t grow = cmdMax ? cmdMax * 2 : 256;
+        dl_cmd_t *grown = (dl_cmd_t *)ps_realloc(cmds, grow * sizeof(dl_cmd_t));
+        if (grown == NULL)
+        {
+            log_i("display list: no memory for %u commands", grow);
+            return NULL;
+        }
+        cmds = grown;
+        cmdMax = grow;
+    }
+    dl_cmd_t *cmd = &cmds[cmdCnt++];
+    memset(cmd, 0, sizeof(dl_cmd_t));
+    cmd->type = type;
+    cmd->color = color;
+    cmd->x = x;
+    cmd->y = y;
+    cmd->box = box;
+    return cmd;
+}
+
+// Copies the payload of the last command into the arena, 4-byte aligned; drops the command if it can't
+static bool store(dl_cmd_t *cmd, const void *data, size_t size)
+{
+    uint32_t offset = (arenaSize + 3) & ~3u;
+    if (offset + size > arenaMax)
+    {
+        uint32_t grow = max(arenaMax * 2, (uint32_t)(offset + size + 16 * 1024));
+        uint8_t *grown = (uint8_t *)ps_realloc(arena, grow);
+        if (grown == NULL)
+        {
+            log_i("display list: no memory for %u bytes", grow);
+            cmdCnt--;
+            return false;
+        }
+        arena = grown;
+        arenaMax = grow;
+    }
+    memcpy(arena + offset, data, size);
+    arenaSize = offset + size;
+    cmd->data = offset;
+    return true;
+}
+
+static void finish(dl_cmd_t *cmd, const void *payload, size_t size)
+{
+    cmd->hash = fnv(payload, size, fnv(cmd, DL_KEY_SIZE, 2166136261u));
+}
+
+// Even x and width keep a region byte aligned in the 4bpp frame
+static bool clip(int x, int y, int w, int h, damage_t &r)
+{
+    int x0 = max(x, 0) & ~1;
+    int y0 = max(y, 0);
+    int x1 = (min(x + w, EPD_WIDTH) + 1) & ~1;
+    int y1 = min(y + h, EPD_HEIGHT);
+    if (x1 <= x0 || y1 <= y0)
+        return false;
+    r = {(int16_t)x0, (int16_t)y0, (int16_t)(x1 - x0), (int16_t)(y1 - y0)};
+    return true;
+}
+
+static bool touches(const damage_t &box, const damage_t *regions, int n)
+{
+    for (int i = 0; i < n; i++)
+        if (box.x < regions[i].x + regions[i].w && regions[i].x < box.x + box.w &&
+            box.y < regions[i].y + regions[i].h && regions[i].y < box.y + box.h)
+            return true;
+    return false;
+}
+
+static uint32_t fnv(const void *data, size_t size, uint32_t hash)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    for (size_t i = 0; i < size; i++)
+        hash = (hash ^ p[i]) * 16777619u;
+    return hash;
+}
+
+static int entry_cmp(const void *a, const void *b)
+{
+    const dl_entry_t *ea = (const dl_entry_t *)a, *eb = (const dl_entry_t *)b;
+    if (ea->hash != eb->hash)
+        return (ea->hash < eb->hash) ? -1 : 1;
+    return memcmp(&ea->box, &eb->box, sizeof(damage_t));
+}
+
+static void read_image(fs::FS &fs, const dl_cmd_t &cmd, dl_image_t &image)
+{
+    const uint8_t *payload = arena + cmd.data;
+    if (cmd.type == DL_ATLAS)
+    {
+        const atlas_entry_t &entry = *(const atlas_entry_t *)payload;
+        image.data = atlas_read(fs, entry);
+        image.size = entry.size;
+        image.encoding = entry.encoding;
+        image.width = entry.width;
+        image.height = entry.height;
+        if (image.data == NULL)
+            log_i("display list: can't read an atlas image");
+    }
+    else if (cmd.type == DL_SCALED)
+    {
+        image.data = icon_scaled(fs, (const char *)payload, cmd.a, cmd.b, image.size, image.encoding);
+        image.width = cmd.a;
+        image.height = cmd.b;
+        if (image.data == NULL)
+            log_i("display list: can't scale %s", (const char *)payload);
+    }
+}
+
+// The glyphs of the text that are not cached yet, false if the cache has no room left for them
+static bool reserve_glyphs(const text_run_t &run, dl_glyph_t *glyphs, uint16_t &glyphCnt)
+{
+    for (uint8_t i = 0; i < run.count; i++)
+    {
+        const GFXglyph *glyph = run.glyph[i];
+        uint8_t *bitmap;
+        if (glyph->width == 0 || glyph->height == 0)
+            continue; // Not drawn
+        if (!glyph_cache_reserve(run.font, glyph, bitmap))
+            return false;
+        if (bitmap != NULL)
+            glyphs[glyphCnt++] = {run.font, glyph, bitmap};
+    }
+    return true;
+}
+
+// Band edges where the box area of the commands, roughly their cost, is split evenly
+static void split(const uint16_t *order, uint16_t count, int bands, dl_band_t *band)
+{
+    int32_t *cost = (int32_t *)ps_calloc(EPD_HEIGHT + 1, sizeof(int32_t));
+    int64_t total = 0;
+    for (uint16_t k = 0; k < count && cost != NULL; k++)
+    {
+        const damage_t &box = cmds[order[k]].box;
+        cost[box.y] += box.w;
+        cost[box.y + box.h] -= box.w;
+        total += (int32_t)box.w * box.h;
+    }
+    int y = 0;
+    int32_t row = 0;
+    int64_t sum = 0;
+    for (int b = 0; b < bands; b++)
+    {
+        band[b].order = order;
+        band[b].count = count;
+        band[b].inflateTime = 0;
+        band[b].drawTime = 0;
+        band[b].top = y;
+        if (b == bands - 1 || cost == NULL)
+            y = EPD_HEIGHT;
+        for (; y < EPD_HEIGHT && sum * bands < total * (b + 1); y++)
+        {
+            row += cost[y];
+            sum += row;
+        }
+        band[b].bottom = y;
+    }
+    free(cost);
+}
+
+static void band_task(void *arg)
+{
+    dl_band_t &band = *(dl_band_t *)arg;
+    inflate_band(band);
+    xSemaphoreGive(bandDone);
+    xSemaphoreTake(bandGo, portMAX_DELAY);
+    draw_band(band);
+    xSemaphoreGive(bandDone);
+    vTaskDelete(NULL);
+}
+
+static void inflate_band(dl_band_t &band)
+{
+    uint32_t start = micros();
+    for (uint16_t k = band.index; k < band.glyphCnt; k += band.bands)
+        glyph_cache_fill(band.glyphs[k].font, band.glyphs[k].glyph, band.glyphs[k].bitmap, band.worker);
+    band.inflateTime = micros() - start;
+}
+
+static void draw_band(dl_band_t &band)
+{
+    uint32_t start = micros();
+    for (uint16_t k = 0; k < band.count; k++)
+    {
+        const dl_cmd_t &cmd = cmds[band.order[k]];
+        if (cmd.box.y < band.bottom && band.top < cmd.box.y + cmd.box.h)
+            draw_cmd(cmd, band.images[k], band.framebuffer, band.top, band.bottom);
+    }
+    band.drawTime = micros() - start;
+}
+
+static void draw_cmd(const dl_cmd_t &cmd, const dl_image_t &image, uint8_t *framebuffer, int top, int bottom)
+{
+    const uint8_t *payload = arena + cmd.data;
+    switch (cmd.type)
+    {
+    case DL_TEXT:
+        text_draw(*(const text_run_t *)payload, cmd.x, cmd.y, framebuffer, top, bottom);
+        break;
+    case DL_LINE:
+        line_draw(cmd.x, cmd.y, cmd.a, cmd.b, cmd.color, framebuffer, top, bottom);
+        break;
+    case DL_RECT:
+        rect_draw(cmd.x, cmd.y, cmd.a, cmd.b, cmd.color, cmd.flags & DL_FILL, framebuffer, top, bottom);
+        break;
+    case DL_TRIANGLE:
+        triangle_fill(cmd.x, cmd.y, cmd.a, cmd.b, cmd.c, cmd.d, cmd.color, framebuffer, top, bottom);
+        break;
+    case DL_CIRCLE:
+        circle_draw(cmd.x, cmd.y, cmd.a, cmd.color, cmd.flags & DL_FILL, framebuffer, top, bottom);
+        break;
+    case DL_ARC:
+        arc_draw(cmd.x, cmd.y, cmd.a, cmd.b, cmd.c, cmd.thickness, cmd.color, cmd.flags & DL_AA, framebuffer, top,
+                 bottom);
+        break;
+    case DL_PIXEL:
+        if (cmd.y >= top && cmd.y < bottom)
+            epd_draw_pixel(cmd.x, cmd.y, cmd.color, framebuffer);
+        break;
+    case DL_ATLAS:
+    case DL_SCALED:
+        if (image.data != NULL)
+            image_draw(image.data, image.size, image.encoding, image.width, image.height, cmd.x, cmd.y, framebuffer,
+                       top, bottom);
+        break;
+    case DL_BITMAP:
+        image_blit(payload, cmd.a, cmd.b, cmd.x, cmd.y, framebuffer, top, bottom);
+        break;
+    }
+}
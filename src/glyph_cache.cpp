@@ -0,0 +1,323 @@
+#include "glyph_cache.h"
+#include <rom/miniz.h>
+
+typedef struct
+{
+    const GFXglyph *glyph; // Unique per (font, code point)
+    uint8_t *bitmap;
+    int16_t prev; // LRU list, most recently used first
+    int16_t next;
+    int16_t chain; // Next entry in the same bucket
+} glyph_entry_t;
+
+static glyph_entry_t entries[GLYPH_CACHE_ENTRIES];
+static int16_t buckets[GLYPH_CACHE_BUCKETS];
+static int16_t lruHead = -1, lruTail = -1;
+static int16_t entryCnt = 0;  // Entries handed out so far
+static int16_t freeHead = -1; // Evicted entries, linked through chain
+static bool ready = false;
+static bool frozen = false;
+static glyph_cache_stats_t stats;
+static tinfl_decompressor decomp;
+static tinfl_decompressor *workers[GLYPH_CACHE_WORKERS]; // 1.. in PSRAM, made on their first fill
+static uint8_t *scratch = NULL; // Bitmaps too big to cache
+static size_t scratchSize = 0;
+
+static uint32_t bitmap_size(const GFXglyph *glyph);
+static bool inflate_glyph(const GFXfont *font, const GFXglyph *glyph, uint8_t *dest, tinfl_decompressor *d);
+static uint8_t bucket_of(const GFXglyph *glyph);
+static void lru_unlink(int16_t i);
+static void lru_push(int16_t i);
+static int16_t entry_alloc();
+static void entry_free(int16_t i);
+static void evict();
+
+const GFXglyph *glyph_find(const GFXfont *font, uint32_t cp)
+{
+    for (uint32_t i = 0; i < font->interval_count; i++)
+    {
+        const UnicodeInterval *interval = &font->intervals[i];
+        if (cp >= interval->first && cp <= interval->last)
+            return &font->glyph[interval->offset + (cp - interval->first)];
+        if (cp < interval->first)
+            return NULL;
+    }
+    return NULL;
+}
+
+const uint8_t *glyph_bitmap(const GFXfont *font, const GFXglyph *glyph)
+{
+    if (!font->compressed)
+        return &font->bitmap[glyph->data_offset];
+    if (!ready)
+        glyph_cache_clear();
+
+    uint8_t b = bucket_of(glyph);
+    for (int16_t i = buckets[b]; i >= 0; i = entries[i].chain)
+    {
+        if (entries[i].glyph == glyph)
+        {
+            if (frozen)
+                return entries[i].bitmap;
+            stats.hits++;
+            lru_unlink(i);
+            lru_push(i);
+            return entries[i].bitmap;
+        }
+    }
+
+    if (frozen)
+        return NULL;
+    stats.misses++;
+    uint32_t size = bitmap_size(glyph);
+    if (size > GLYPH_CACHE_BYTES / 4)
+    {
+        if (size > scratchSize)
+        {
+            free(scratch);
+            scratch = (uint8_t *)ps_malloc(size);
+            scratchSize = (scratch != NULL) ? size : 0;
+        }
+        return (scratch != NULL && inflate_glyph(font, glyph, scratch, &decomp)) ? scratch : NULL;
+    }
+    while (stats.bytes + size > GLYPH_CACHE_BYTES && lruTail >= 0)
+        evict();
+    int16_t i = entry_alloc();
+    uint8_t *bitmap = (uint8_t *)ps_malloc(size);
+    if (bitmap == NULL || !inflate_glyph(font, glyph, bitmap, &decomp))
+    {
+        free(bitmap);
+        entry_free(i);
+        return NULL;
+    }
+    entries[i].glyph = glyph;
+    entries[i].bitmap = bitmap;
+    entries[i].chain = buckets[b];
+    buckets[b] = i;
+    lru_push(i);
+    stats.bytes += size;
+    return bitmap;
+}
+
+// Same output as the library's draw_char(): the glyph box is opaque, bitmap value v becomes 15 - v
+void glyph_draw(const GFXfont *font, const GFXglyph *glyph, int x, int y, uint8_t *framebuffer, int top, int bottom)
+{
+    if (glyph->width == 0 || glyph->height == 0)
+        return;
+    const uint8_t *bitmap = glyph_bitmap(font, glyph);
+    if (bitmap == NULL)
+        return;
+    int byteWidth = (glyph->width + 1) / 2;
+    int left = x + glyph->left;
+    int x0 = max(0, -left);
+    int x1 = min((int)glyph->width, EPD_WIDTH - left);
+    int row0 = max(0, max(top, 0) - (y - glyph->top));
+    int row1 = min((int)glyph->height, min(bottom, EPD_HEIGHT) - (y - glyph->top));
+    for (int row = row0; row < row1; row++)
+    {
+        int yy = y - glyph->top + row;
+        const uint8_t *src = bitmap + row * byteWidth;
+        uint8_t *dst = framebuffer + yy * EPD_WIDTH / 2;
+        for (int xx = x0; xx < x1; xx++)
+        {
+            uint8_t v = 15 - ((xx & 1) ? (src[xx / 2] >> 4) : (src[xx / 2] & 0x0F));
+            int px = left + xx;
+            uint8_t *p = &dst[px / 2];
+            *p = (px & 1) ? ((*p & 0x0F) | (v << 4)) : ((*p & 0xF0) | v);
+        }
+    }
+}
+
+int glyph_write_string(const GFXfont *font, const char *str, int x, int y, uint8_t *framebuffer)
+{
+    uint32_t cp;
+    while ((cp = utf8_next(&str)) != 0)
+    {
+        const GFXglyph *glyph = glyph_find(font, cp);
+        if (glyph == NULL)
+            continue;
+        glyph_draw(font, glyph, x, y, framebuffer);
+        x += glyph->advance_x;
+    }
+    return x;
+}
+
+uint32_t utf8_next(const char **str)
+{
+    const uint8_t *s = (const uint8_t *)*str;
+    if (*s == 0)
+        return 0;
+    uint32_t cp = *s++;
+    int more = 0;
+    if (cp >= 0xF0)
+    {
+        cp &= 0x07;
+        more = 3;
+    }
+    else if (cp >= 0xE0)
+    {
+        cp &= 0x0F;
+        more = 2;
+    }
+    else if (cp >= 0xC0)
+    {
+        cp &= 0x1F;
+        more = 1;
+    }
+    for (; more > 0 && *s; more--)
+        cp = (cp << 6) | (*s++ & 0x3F);
+    *str = (const char *)s;
+    return cp;
+}
+
+bool glyph_cache_reserve(const GFXfont *font, const GFXglyph *glyph, uint8_t *&bitmap)
+{
+    bitmap = NULL;
+    if (!font->compressed)
+        return true;
+    if (!ready)
+        glyph_cache_clear();
+    uint8_t b = bucket_of(glyph);
+    for (int16_t i = buckets[b]; i >= 0; i = entries[i].chain)
+    {
+        if (entries[i].glyph == glyph)
+        {
+            stats.hits++;
+            lru_unlink(i);
+            lru_push(i);
+            return true;
+        }
+    }
+    // Bitmaps reserved before may not be filled yet, none of them can be evicted
+    uint32_t size = bitmap_size(glyph);
+    if (frozen || size > GLYPH_CACHE_BYTES / 4 || stats.bytes + size > GLYPH_CACHE_BYTES ||
+        (freeHead < 0 && entryCnt == GLYPH_CACHE_ENTRIES))
+        return false;
+    bitmap = (uint8_t *)ps_malloc(size);
+    if (bitmap == NULL)
+        return false;
+    stats.misses++;
+    int16_t i = entry_alloc();
+    entries[i].glyph = glyph;
+    entries[i].bitmap = bitmap;
+    entries[i].chain = buckets[b];
+    buckets[b] = i;
+    lru_push(i);
+    stats.bytes += size;
+    return true;
+}
+
+void glyph_cache_fill(const GFXfont *font, const GFXglyph *glyph, uint8_t *bitmap, int worker)
+{
+    tinfl_decompressor *d = &decomp;
+    if (worker > 0 && worker < GLYPH_CACHE_WORKERS)
+    {
+        if (workers[worker] == NULL)
+            workers[worker] = (tinfl_decompressor *)ps_malloc(sizeof(tinfl_decompressor));
+        d = workers[worker];
+    }
+    if (d == NULL || !inflate_glyph(font, glyph, bitmap, d))
+        memset(bitmap, 0, bitmap_size(glyph));
+}
+
+void glyph_cache_freeze(bool on)
+{
+    frozen = on;
+}
+
+void glyph_cache_clear()
+{
+    for (int16_t i = 0; i < entryCnt; i++)
+        free(entries[i].bitmap);
+    for (uint8_t b = 0; b < GLYPH_CACHE_BUCKETS; b++)
+        buckets[b] = -1;
+    memset(entries, 0, sizeof(entries));
+    entryCnt = 0;
+    freeHead = -1;
+    lruHead = lruTail = -1;
+    stats = {};
+    ready = true;
+}
+
+const glyph_cache_stats_t &glyph_cache_stats()
+{
+    return stats;
+}
+
+static uint32_t bitmap_size(const GFXglyph *glyph)
+{
+    return (glyph->width + 1) / 2 * glyph->height;
+}
+
+static bool inflate_glyph(const GFXfont *font, const GFXglyph *glyph, uint8_t *dest, tinfl_decompressor *d)
+{
+    size_t inSize = glyph->compressed_size;
+    size_t outSize = bitmap_size(glyph);
+    tinfl_init(d);
+    tinfl_status status = tinfl_decompress(d, &font->bitmap[glyph->data_offset], &inSize, dest, dest, &outSize,
+                                           TINFL_FLAG_PARSE_ZLIB_HEADER | TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF);
+    return status == TINFL_STATUS_DONE;
+}
+
+static uint8_t bucket_of(const GFXglyph *glyph)
+{
+    uintptr_t p = (uintptr_t)glyph / sizeof(GFXglyph);
+    return (p ^ (p >> 6)) & (GLYPH_CACHE_BUCKETS - 1);
+}
+
+static void lru_unlink(int16_t i)
+{
+    if (entries[i].prev >= 0)
+        entries[entries[i].prev].next = entries[i].next;
+    else
+        lruHead = entries[i].next;
+    if (entries[i].next >= 0)
+        entries[entries[i].next].prev = entries[i].prev;
+    else
+        lruTail = entries[i].prev;
+}
+
+static void lru_push(int16_t i)
+{
+    entries[i].prev = -1;
+    entries[i].next = lruHead;
+    if (lruHead >= 0)
+        entries[lruHead].prev = i;
+    lruHead = i;
+    if (lruTail < 0)
+        lruTail = i;
+}
+
+static int16_t entry_alloc()
+{
+    if (freeHead < 0 && entryCnt < GLYPH_CACHE_ENTRIES)
+        return entryCnt++;
+    if (freeHead < 0)
+        evict();
+    int16_t i = freeHead;
+    freeHead = entries[i].chain;
+    return i;
+}
+
+static void entry_free(int16_t i)
+{
+    entries[i].glyph = NULL;
+    entries[i].bitmap = NULL;
+    entries[i].chain = freeHead;
+    freeHead = i;
+}
+
+// Drops the least recently used bitmap
+static void evict()
+{
+    int16_t i = lruTail;
+    lru_unlink(i);
+    int16_t *link = &buckets[bucket_of(entries[i].glyph)];
+    while (*link != i)
+        link = &entries[*link].chain;
+    *link = entries[i].chain;
+    stats.bytes -= bitmap_size(entries[i].glyph);
+    stats.evictions++;
+    free(entries[i].bitmap);
+    entry_free(i);
+}
@@ -0,0 +1,376 @@
+#include "icon_atlas.h"
+#include "epd_driver.h"
+#include "raster.h"
+
+#define ATLAS_MAGIC 0x41495759 // "YWIA" read as a little endian word
+#define ATLAS_VERSION 2
+#define ROW_BYTES (EPD_WIDTH / 2)
+
+typedef struct
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;
+} atlas_header_t;
+
+typedef struct
+{
+    const uint8_t *mem; // Image in memory, NULL - read from the atlas through buf
+    uint8_t buf[ATLAS_CHUNK];
+    uint32_t pos;
+    uint32_t len;
+    uint32_t left; // Bytes of the image not in buf yet
+} reader_t;
+
+// Pixels x .. x + n - 1 of row y of the image have value v
+typedef void (*span_fn)(void *ctx, int x, int y, int n, uint8_t v);
+
+typedef struct
+{
+    int x, y;
+    uint8_t *framebuffer;
+    int top, bottom; // Rows of the frame it may write
+} draw_ctx_t;
+
+typedef struct
+{
+    uint8_t *data;
+    int rowBytes;
+} store_ctx_t;
+
+static_assert(sizeof(atlas_header_t) == 8 && sizeof(atlas_entry_t) == 16, "layout of tools/pack_icons.py");
+
+// The index survives deep sleep, a wake only seeks to the icons it draws
+RTC_DATA_ATTR static atlas_entry_t atlasIndex[ATLAS_MAX_ICONS];
+RTC_DATA_ATTR static uint16_t atlasCnt = 0;
+RTC_DATA_ATTR static uint32_t atlasSize = 0; // Size of the file the index was read from, 0 - not read
+
+static File atlas; // Stays open for the wake
+static bool atlasMissing = false;
+
+static bool atlas_open(fs::FS &fs);
+static bool read_index();
+static uint32_t name_hash(const char *name);
+static int read_byte(reader_t &r);
+static bool decode(reader_t &r, uint8_t encoding, int width, int height, span_fn span, void *ctx);
+static bool decode_entry(const atlas_entry_t &entry, span_fn span, void *ctx);
+static bool reader_at(reader_t &r, const atlas_entry_t &entry);
+static bool draw(reader_t &r, uint8_t encoding, int width, int height, int x, int y, uint8_t *framebuffer, int top,
+                 int bottom);
+static void put_span(uint8_t *row, int x, int n, uint8_t v);
+static void span_draw(void *ctx, int x, int y, int n, uint8_t v);
+static void span_store(void *ctx, int x, int y, int n, uint8_t v);
+
+bool atlas_find(fs::FS &fs, const char *name, atlas_entry_t &entry)
+{
+    if (!atlas_open(fs))
+        return false;
+    uint32_t hash = name_hash(name);
+    int lo = 0, hi = atlasCnt - 1;
+    while (lo <= hi)
+    {
+        int mid = (lo + hi) / 2;
+        if (atlasIndex[mid].hash == hash)
+        {
+            entry = atlasIndex[mid];
+            return true;
+        }
+        if (atlasIndex[mid].hash < hash)
+            lo = mid + 1;
+        else
+            hi = mid - 1;
+    }
+    return false;
+}
+
+uint8_t *atlas_load(fs::FS &fs, const char *name, atlas_entry_t *entry)
+{
+    atlas_entry_t e;
+    if (!atlas_find(fs, name, e))
+        return NULL;
+    size_t size = (e.width + 1) / 2 * e.height;
+    uint8_t *data = (uint8_t *)ps_malloc(size);
+    if (data == NULL)
+        return NULL;
+    memset(data, 0xFF, size); // Padding nibbles of odd widths stay white
+    store_ctx_t ctx = {data, (e.width + 1) / 2};
+    if (!decode_entry(e, span_store, &ctx))
+    {
+        log_i("atlas: can't read %s", name);
+        free(data);
+        return NULL;
+    }
+    if (entry != NULL)
+        *entry = e;
+    return data;
+}
+
+uint8_t *atlas_read(fs::FS &fs, const atlas_entry_t &entry)
+{
+    if (!atlas_open(fs) || !atlas.seek(entry.offset))
+        return NULL;
+    uint8_t *data = (uint8_t *)ps_malloc(entry.size + 1);
+    if (data != NULL && atlas.read(data, entry.size) != entry.size)
+    {
+        free(data);
+        data = NULL;
+    }
+    return data;
+}
+
+bool atlas_draw(fs::FS &fs, const atlas_entry_t &entry, int x, int y, uint8_t *framebuffer)
+{
+    reader_t r;
+    if (!atlas_open(fs) || !reader_at(r, entry))
+        return false;
+    return draw(r, entry.encoding, entry.width, entry.height, x, y, framebuffer, 0, EPD_HEIGHT);
+}
+
+bool image_draw(const uint8_t *data, size_t size, uint8_t encoding, int width, int height, int x, int y,
+                uint8_t *framebuffer, int top, int bottom)
+{
+    reader_t r;
+    r.mem = data;
+    r.pos = 0;
+    r.len = size;
+    r.left = 0;
+    return draw(r, encoding, width, height, x, y, framebuffer, max(top, 0), min(bottom, EPD_HEIGHT));
+}
+
+size_t rle_encode(const uint8_t *raw, int width, int height, uint8_t *out, size_t outSize)
+{
+    int rowBytes = (width + 1) / 2;
+    size_t o = 0;
+    int value = -1, length = 0;
+    for (int i = 0; i <= width * height; i++)
+    {
+        int p = -1; // Past the last pixel, flushes the last run
+        if (i < width * height)
+        {
+            uint8_t b = raw[i / width * rowBytes + i % width / 2];
+            p = ((i % width) & 1) ? (b >> 4) : (b & 0x0F);
+        }
+        if (p == value)
+        {
+            length++;
+            continue;
+        }
+        while (length > 0)
+        {
+            int n = min(length, 15 + 255);
+            if (o + 2 > outSize)
+                return 0;
+            if (n < 15)
+                out[o++] = value << 4 | (n - 1);
+            else
+            {
+                out[o++] = value << 4 | 15;
+                out[o++] = n - 15;
+            }
+            length -= n;
+        }
+        value = p;
+        length = 1;
+    }
+    return o;
+}
+
+void atlas_invalidate()
+{
+    atlasCnt = 0;
+    atlasSize = 0;
+    atlasMissing = false;
+    atlas.close();
+}
+
+static bool atlas_open(fs::FS &fs)
+{
+    if (atlas)
+        return true;
+    if (atlasMissing)
+        return false;
+    // Without an index yet, exists() keeps the VFS from logging an error for a missing file
+    if (atlasSize == 0 && !fs.exists(ATLAS_FILE))
+    {
+        atlasMissing = true;
+        return false;
+    }
+    atlas = fs.open(ATLAS_FILE, FILE_READ);
+    if (atlas && atlas.size() == atlasSize && atlasCnt > 0)
+        return true;
+    if (atlas && read_index())
+        return true;
+    log_i("atlas: %s is missing or broken", ATLAS_FILE);
+    atlas_invalidate();
+    atlasMissing = true;
+    return false;
+}
+
+static bool read_index()
+{
+    atlas_header_t header;
+    if (atlas.read((uint8_t *)&header, sizeof(header)) != sizeof(header) || header.magic != ATLAS_MAGIC ||
+        header.version != ATLAS_VERSION || header.count > ATLAS_MAX_ICONS)
+        return false;
+    size_t size = header.count * sizeof(atlas_entry_t);
+    if (atlas.read((uint8_t *)atlasIndex, size) != size)
+        return false;
+    atlasCnt = header.count;
+    atlasSize = atlas.size();
+    log_i("atlas: %u icons indexed", atlasCnt);
+    return true;
+}
+
+static uint32_t name_hash(const char *name)
+{
+    uint32_t hash = 2166136261u;
+    while (*name)
+        hash = (hash ^ (uint8_t)*name++) * 16777619u;
+    return hash;
+}
+
+static int read_byte(reader_t &r)
+{
+    if (r.mem != NULL)
+        return (r.pos < r.len) ? r.mem[r.pos++] : -1;
+    if (r.pos == r.len)
+    {
+        if (r.left == 0)
+            return -1;
+        r.len = atlas.read(r.buf, min(r.left, (uint32_t)ATLAS_CHUNK));
+        if (r.len == 0)
+            return -1;
+        r.left -= r.len;
+        r.pos = 0;
+    }
+    return r.buf[r.pos++];
+}
+
+// Streams the image from the atlas through a small buffer
+static bool decode_entry(const atlas_entry_t &entry, span_fn span, void *ctx)
+{
+    reader_t r;
+    if (!reader_at(r, entry))
+        return false;
+    return decode(r, entry.encoding, entry.width, entry.height, span, ctx);
+}
+
+static bool reader_at(reader_t &r, const atlas_entry_t &entry)
+{
+    r.mem = NULL;
+    r.pos = r.len = 0;
+    r.left = entry.size;
+    return atlas.seek(entry.offset);
+}
+
+// Runs go in as spans, raw rows are blitted a word at a time
+static bool draw(reader_t &r, uint8_t encoding, int width, int height, int x, int y, uint8_t *framebuffer, int top,
+                 int bottom)
+{
+    if (encoding != ICON_RAW)
+    {
+        draw_ctx_t ctx = {x, y, framebuffer, top, bottom};
+        return decode(r, encoding, width, height, span_draw, &ctx);
+    }
+    uint8_t row[ROW_BYTES];
+    int rowBytes = (width + 1) / 2;
+    if (rowBytes > ROW_BYTES)
+        return false;
+    for (int yy = 0; yy < height; yy++)
+    {
+        for (int i = 0; i < rowBytes; i++)
+        {
+            int b = read_byte(r);
+            if (b < 0)
+                return false;
+            row[i] = b;
+        }
+        image_blit(row, width, 1, x, y + yy, framebuffer, top, bottom);
+    }
+    return true;
+}
+
+// Hands the image out as runs of equal pixels
+static bool decode(reader_t &r, uint8_t encoding, int width, int height, span_fn span, void *ctx)
+{
+    if (encoding > ICON_RLE)
+        return false;
+    int x = 0, y = 0;
+    bool odd = false; // Raw: the high nibble of last is next
+    int last = 0;
+    while (y < height)
+    {
+        int v, n = 1;
+        if (encoding == ICON_RLE)
+        {
+            int t = read_byte(r);
+            if (t < 0)
+                return false;
+            v = t >> 4;
+            n = (t & 0x0F) + 1;
+            if (n == 16)
+            {
+                int ext = read_byte(r);
+                if (ext < 0)
+                    return false;
+                n = 15 + ext;
+            }
+        }
+        else
+        {
+            if (!odd && (last = read_byte(r)) < 0)
+                return false;
+            v = odd ? (last >> 4) : (last & 0x0F);
+            odd = !odd && (x + 1 < width); // The padding nibble of an odd width is dropped
+        }
+        while (n > 0 && y < height)
+        {
+            int k = min(n, width - x);
+            span(ctx, x, y, k, v);
+            x += k;
+            n -= k;
+            if (x == width)
+            {
+                x = 0;
+                y++;
+            }
+        }
+    }
+    return true;
+}
+
+// n pixels of value v from x on, whole bytes in the middle are set at once
+static void put_span(uint8_t *row, int x, int n, uint8_t v)
+{
+    if (n > 0 && (x & 1))
+    {
+        row[x / 2] = (row[x / 2] & 0x0F) | (v << 4);
+        x++;
+        n--;
+    }
+    if (n >= 2)
+    {
+        memset(row + x / 2, v * 0x11, n / 2);
+        x += n & ~1;
+        n &= 1;
+    }
+    if (n > 0)
+        row[x / 2] = (row[x / 2] & 0xF0) | v;
+}
+
+static void span_draw(void *ctx, int x, int y, int n, uint8_t v)
+{
+    draw_ctx_t *c = (draw_ctx_t *)ctx;
+    int sx = c->x + x, sy = c->y + y;
+    if (v == 0x0F || sy < c->top || sy >= c->bottom)
+        return;
+    int x0 = max(sx, 0), x1 = min(sx + n, EPD_WIDTH);
+    if (x1 > x0)
+        put_span(c->framebuffer + sy * ROW_BYTES, x0, x1 - x0, v);
+}
+
+static void span_store(void *ctx, int x, int y, int n, uint8_t v)
+{
+    store_ctx_t *c = (store_ctx_t *)ctx;
+    put_span(c->data + y * c->rowBytes, x, n, v);
+}
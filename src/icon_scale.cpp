@@ -0,0 +1,202 @@
+#include "icon_scale.h"
+#include "icon_atlas.h"
+
+typedef struct
+{
+    uint32_t hash;   // Of the large image
+    uint32_t offset; // Of the large image, changes when the atlas does
+    uint16_t width;
+    uint16_t height;
+    uint16_t size; // RLE bytes, 0 - empty slot
+    bool sharpen;
+    uint8_t age; // 0 - used last
+    uint8_t data[SCALE_CACHE_BYTES];
+} scale_slot_t;
+
+// Forecast icons change a few times a day, the same ones are drawn wake after wake
+RTC_DATA_ATTR static scale_slot_t scaleCache[SCALE_CACHE_SLOTS];
+
+static int pixel(const uint8_t *img, int rowBytes, int x, int y);
+static void sharpen_pass(uint8_t *img, int w, int h);
+static scale_slot_t *cache_find(const atlas_entry_t &entry, int w, int h, bool sharpen);
+static scale_slot_t *cache_victim();
+static void cache_touch(scale_slot_t *slot);
+
+void icon_downscale(const uint8_t *src, int sw, int sh, uint8_t *dst, int dw, int dh, bool sharpen)
+{
+    // Source pixel i spans [i * dw, (i + 1) * dw) and destination pixel j spans [j * sw, (j + 1) * sw),
+    // so overlaps are integers and the weights of a destination pixel add up to sw * sh
+    int srcRow = (sw + 1) / 2, dstRow = (dw + 1) / 2;
+    uint32_t norm = (uint32_t)sw * sh;
+    uint32_t *acc = (uint32_t *)malloc(dw * sizeof(uint32_t));
+    uint16_t *line = (uint16_t *)malloc(dw * sizeof(uint16_t));
+    if (acc == NULL || line == NULL)
+    {
+        free(acc);
+        free(line);
+        return;
+    }
+    memset(dst, 0xFF, dstRow * dh);
+    int sy = 0;
+    for (int dy = 0; dy < dh; dy++)
+    {
+        memset(acc, 0, dw * sizeof(uint32_t));
+        int32_t top = dy * sh, bottom = (dy + 1) * sh;
+        for (; sy < sh; sy++)
+        {
+            int32_t wy = min((sy + 1) * dh, bottom) - max(sy * dh, top);
+            if (wy <= 0)
+                break;
+            // Horizontal pass over source row sy, the source pixel that straddles two columns is split
+            memset(line, 0, dw * sizeof(uint16_t));
+            int dx = 0;
+            for (int sx = 0; sx < sw; sx++)
+            {
+                int p = pixel(src, srcRow, sx, sy);
+                int32_t left = sx * dw, right = (sx + 1) * dw;
+                while (dx < dw && (dx + 1) * sw <= left)
+                    dx++;
+                for (int j = dx; j < dw && j * sw < right; j++)
+                    line[j] += p * (min(right, (int32_t)(j + 1) * sw) - max(left, (int32_t)j * sw));
+            }
+            for (int j = 0; j < dw; j++)
+                acc[j] += (uint32_t)line[j] * wy;
+            if ((sy + 1) * dh > bottom)
+                break; // The row straddles two destination rows, it is used again by the next one
+        }
+        for (int dx = 0; dx < dw; dx++)
+        {
+            uint8_t v = (acc[dx] + norm / 2) / norm;
+            uint8_t *b = &dst[dy * dstRow + dx / 2];
+            *b = (dx & 1) ? ((*b & 0x0F) | (v << 4)) : ((*b & 0xF0) | v);
+        }
+    }
+    free(acc);
+    free(line);
+    if (sharpen)
+        sharpen_pass(dst, dw, dh);
+}
+
+uint8_t *icon_scaled(fs::FS &fs, const char *large, int w, int h, size_t &size, uint8_t &encoding, bool sharpen)
+{
+    atlas_entry_t entry;
+    if (!atlas_find(fs, large, entry))
+        return NULL;
+    scale_slot_t *slot = cache_find(entry, w, h, sharpen);
+    if (slot != NULL)
+    {
+        cache_touch(slot);
+        uint8_t *data = (uint8_t *)ps_malloc(slot->size);
+        if (data != NULL)
+            memcpy(data, slot->data, slot->size);
+        size = slot->size;
+        encoding = ICON_RLE;
+        return data;
+    }
+
+    uint32_t start = micros();
+    uint8_t *src = atlas_load(fs, large);
+    size = (w + 1) / 2 * h;
+    uint8_t *dst = (uint8_t *)ps_malloc(size);
+    if (src == NULL || dst == NULL)
+    {
+        free(src);
+        free(dst);
+        return NULL;
+    }
+    icon_downscale(src, entry.width, entry.height, dst, w, h, sharpen);
+    free(src);
+    slot = cache_victim();
+    slot->size = rle_encode(dst, w, h, slot->data, SCALE_CACHE_BYTES);
+    if (slot->size > 0)
+    {
+        slot->hash = entry.hash;
+        slot->offset = entry.offset;
+        slot->width = w;
+        slot->height = h;
+        slot->sharpen = sharpen;
+        cache_touch(slot);
+    }
+    log_i("%s scaled to %dx%d in %u us, %u bytes cached", large, w, h, micros() - start, slot->size);
+    (void)start; // Only logged
+    encoding = ICON_RAW;
+    return dst;
+}
+
+bool icon_draw_scaled(fs::FS &fs, const char *large, int w, int h, int x, int y, uint8_t *framebuffer,
+                      bool sharpen)
+{
+    size_t size;
+    uint8_t encoding;
+    uint8_t *data = icon_scaled(fs, large, w, h, size, encoding, sharpen);
+    if (data == NULL)
+        return false;
+    bool res = image_draw(data, size, encoding, w, h, x, y, framebuffer);
+    free(data);
+    return res;
+}
+
+static int pixel(const uint8_t *img, int rowBytes, int x, int y)
+{
+    uint8_t b = img[y * rowBytes + x / 2];
+    return (x & 1) ? (b >> 4) : (b & 0x0F);
+}
+
+// c + (4c - the four neighbours) / 4, the edges of the image repeat outwards
+static void sharpen_pass(uint8_t *img, int w, int h)
+{
+    int rowBytes = (w + 1) / 2;
+    uint8_t *copy = (uint8_t *)malloc(rowBytes * h);
+    if (copy == NULL)
+        return;
+    memcpy(copy, img, rowBytes * h);
+    for (int y = 0; y < h; y++)
+    {
+        for (int x = 0; x < w; x++)
+        {
+            int c = pixel(copy, rowBytes, x, y);
+            int n = pixel(copy, rowBytes, x, max(y - 1, 0)) + pixel(copy, rowBytes, x, min(y + 1, h - 1)) +
+                    pixel(copy, rowBytes, max(x - 1, 0), y) + pixel(copy, rowBytes, min(x + 1, w - 1), y);
+            int v = constrain(c + (4 * c - n) / 4, 0, 15);
+            uint8_t *b = &img[y * rowBytes + x / 2];
+            *b = (x & 1) ? ((*b & 0x0F) | (v << 4)) : ((*b & 0xF0) | v);
+        }
+    }
+    free(copy);
+}
+
+static scale_slot_t *cache_find(const atlas_entry_t &entry, int w, int h, bool sharpen)
+{
+    for (uint8_t i = 0; i < SCALE_CACHE_SLOTS; i++)
+    {
+        scale_slot_t &s = scaleCache[i];
+        if (s.size > 0 && s.hash == entry.hash && s.offset == entry.offset && s.width == w && s.height == h &&
+            s.sharpen == sharpen)
+            return &s;
+    }
+    return NULL;
+}
+
+static scale_slot_t *cache_victim()
+{
+    scale_slot_t *victim = &scaleCache[0];
+    for (uint8_t i = 0; i < SCALE_CACHE_SLOTS; i++)
+    {
+        if (scaleCache[i].size == 0)
+            return &scaleCache[i];
+        if (scaleCache[i].age > victim->age)
+            victim = &scaleCache[i];
+    }
+    victim->size = 0;
+    return victim;
+}
+
+static void cache_touch(scale_slot_t *slot)
+{
+    for (uint8_t i = 0; i < SCALE_CACHE_SLOTS; i++)
+    {
+        if (scaleCache[i].age < UINT8_MAX)
+            scaleCache[i].age++;
+    }
+    slot->age = 0;
+}
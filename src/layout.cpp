@@ -0,0 +1,356 @@
+#include "layout.h"
+#include <ArduinoJson.h>
+#include "render.h"
+#include "layout_default.h"
+#include <rom/crc.h>
+
+#define CACHE_MAGIC 0x4F4C5759 // "YWLO" read as a little endian word
+#define CACHE_VERSION 3        // Goes up with any change of layout_op_t or the enums it holds
+
+#define FACT 0x01 // The field is in the current weather
+#define PART 0x02 // ... in a forecast part; neither - one value for the whole screen
+
+enum field_kind
+{
+    KIND_INT,
+    KIND_FLOAT,
+    KIND_STR
+};
+
+typedef struct
+{
+    const char *name;
+    uint8_t kind;
+    uint8_t scope;
+} field_info_t;
+
+typedef struct
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;
+    uint16_t infoCount;
+    uint16_t poolSize;
+    uint32_t source; // crc32 of the text the ops are compiled from, /layout.json or the built-in one
+} cache_header_t;
+
+static_assert(sizeof(layout_op_t) == 16 && sizeof(cache_header_t) == 16, "layout of /layout.bin");
+
+static const char *const widgetNames[WIDGET_COUNT] = {"text", "image", "icon", "compass", "sun", "battery", "rssi", "line"};
+// In the order of the font table in render.cpp
+static const char *const fontNames[LAYOUT_FONTS] = {"osans6b", "osans8b", "osans10b", "osans12b", "osans16b",
+                                                    "osans18b", "osans24b", "osans26b", "osans32b", "osans48b"};
+static const char *const alignNames[] = {"left", "right", "center"}; // enum alignment
+static const field_info_t fields[FIELD_COUNT] = {
+    {"", KIND_STR, 0},
+    {"city", KIND_STR, 0},
+    {"time", KIND_STR, 0},
+    {"season", KIND_STR, FACT},
+    {"temp", KIND_INT, FACT | PART},
+    {"feels_like", KIND_INT, FACT | PART},
+    {"humidity", KIND_INT, FACT | PART},
+    {"pressure", KIND_INT, FACT | PART},
+    {"condition", KIND_STR, FACT | PART},
+    {"wind_dir", KIND_STR, FACT | PART},
+    {"wind_speed", KIND_FLOAT, FACT | PART},
+    {"wind_gust", KIND_FLOAT, FACT | PART},
+    {"sunrise", KIND_STR, 0},
+    {"sunset", KIND_STR, 0},
+    {"part_name", KIND_STR, PART},
+    {"prec_mm", KIND_FLOAT, PART},
+    {"prec_prob", KIND_INT, PART},
+};
+static const char *const defaultFormats[] = {"%d", "%.1f", "%s"}; // enum field_kind
+
+static layout_t layout;
+static bool layoutReady = false; // layout holds the ops for this wake
+
+static int lookup(const char *name, const char *const *names, int count);
+static bool format_ok(const char *format, uint8_t kind);
+static uint16_t pool_add(layout_t &layout, const char *str);
+static const char *compile_widget(JsonObject widget, layout_t &layout, layout_op_t &op);
+static bool ops_valid(const layout_t &layout);
+static bool read_cache(fs::FS &fs, uint32_t source);
+static void write_cache(fs::FS &fs, uint32_t source);
+static bool load(fs::FS &fs, const char *json, size_t size);
+
+const layout_t &layout_get(fs::FS &fs)
+{
+    if (layoutReady)
+        return layout;
+    layoutReady = true;
+    uint32_t start = micros();
+    (void)start; // Only logged
+    if (fs.exists(LAYOUT_FILE))
+    {
+        File f = fs.open(LAYOUT_FILE, FILE_READ);
+        size_t size = f.size();
+        char *json = (char *)ps_malloc(size);
+        bool loaded = json != NULL && f.read((uint8_t *)json, size) == size && load(fs, json, size);
+        free(json);
+        if (loaded)
+        {
+            log_i("layout: %u ops of %s in %u us", layout.count, LAYOUT_FILE, micros() - start);
+            return layout;
+        }
+        log_i("layout: %s is broken, the built-in one is used", LAYOUT_FILE);
+    }
+    if (load(fs, layoutDefault, strlen(layoutDefault)))
+        log_i("layout: %u built-in ops in %u us", layout.count, micros() - start);
+    else
+        layout.count = layout.infoCount = 0;
+    return layout;
+}
+
+bool layout_compile(const char *json, size_t size, layout_t &layout)
+{
+    DynamicJsonDocument jsonDoc(LAYOUT_DOC_SIZE);
+    DeserializationError error = deserializeJson(jsonDoc, json, size);
+    if (error)
+    {
+        log_i("layout: %s", error.c_str());
+        return false;
+    }
+    const char *sections[2] = {"info", "weather"};
+    layout.count = layout.infoCount = layout.poolSize = 0;
+    for (int s = 0; s < 2; s++)
+    {
+        int n = 0;
+        for (JsonObject widget : jsonDoc[sections[s]].as<JsonArray>())
+        {
+            if (layout.count == LAYOUT_MAX_OPS)
+            {
+                log_i("layout: more than %d widgets", LAYOUT_MAX_OPS);
+                return false;
+            }
+            const char *error = compile_widget(widget, layout, layout.ops[layout.count]);
+            if (error != NULL)
+            {
+                log_i("layout: %s[%d]: %s", sections[s], n, error);
+                return false;
+            }
+            layout.count++;
+            n++;
+        }
+        if (s == 0)
+            layout.infoCount = layout.count;
+    }
+    log_i("layout: %u ops, %u bytes of text", layout.count, layout.poolSize);
+    return true;
+}
+
+void layout_invalidate(fs::FS &fs)
+{
+    layoutReady = false;
+    if (fs.exists(LAYOUT_CACHE))
+        fs.remove(LAYOUT_CACHE);
+}
+
+static int lookup(const char *name, const char *const *names, int count)
+{
+    for (int i = 0; i < count; i++)
+        if (strcmp(name, names[i]) == 0)
+            return i;
+    return -1;
+}
+
+// One printf conversion that takes a value of the kind, %% aside
+static bool format_ok(const char *format, uint8_t kind)
+{
+    const char *types = (kind == KIND_INT) ? "diuxX" : (kind == KIND_FLOAT) ? "feg" : "s";
+    int conversions = 0;
+    for (const char *p = format; *p; p++)
+    {
+        if (*p != '%')
+            continue;
+        if (*++p == '%')
+            continue;
+        while (*p && strchr("-+ #0", *p))
+            p++;
+        while (isdigit(*p))
+            p++;
+        if (*p == '.')
+            while (isdigit(*++p))
+                ;
+        if (*p == 0 || strchr(types, *p) == NULL)
+            return false;
+        conversions++;
+    }
+    return conversions == 1;
+}
+
+// The same string is kept once, LAYOUT_NONE if the pool is full
+static uint16_t pool_add(layout_t &layout, const char *str)
+{
+    size_t len = strlen(str) + 1;
+    for (uint16_t i = 0; i < layout.poolSize; i += strlen(layout.pool + i) + 1)
+        if (strcmp(layout.pool + i, str) == 0)
+            return i;
+    if (len > LAYOUT_TEXT_SIZE || layout.poolSize + len > LAYOUT_POOL)
+        return LAYOUT_NONE;
+    uint16_t offset = layout.poolSize;
+    memcpy(layout.pool + offset, str, len);
+    layout.poolSize += len;
+    return offset;
+}
+
+// NULL if the widget is fine, what is wrong with it otherwise
+static const char *compile_widget(JsonObject widget, layout_t &layout, layout_op_t &op)
+{
+    memset(&op, 0, sizeof(op));
+    int type = lookup(widget["type"] | "", widgetNames, WIDGET_COUNT);
+    if (type < 0)
+        return "unknown type";
+    op.type = type;
+    op.str = LAYOUT_NONE;
+    op.x = widget["x"] | 0;
+    op.y = widget["y"] | 0;
+    int part = widget["part"] | -1;
+    if (part < -1 || part > 1)
+        return "part is -1 (now), 0 or 1";
+    op.part = part;
+    int align = lookup(widget["align"] | "left", alignNames, 3);
+    if (align < 0)
+        return "align is left, right or center";
+    op.align = align;
+    const char *from = widget["from"] | "";
+    if (strcmp(from, "left") == 0)
+        op.flags |= LAYOUT_FROM_LEFT;
+    else if (strcmp(from, "right") == 0)
+        op.flags |= LAYOUT_FROM_RIGHT;
+    else if (*from)
+        return "from is left or right";
+    if (widget["large"] | false)
+        op.flags |= LAYOUT_LARGE;
+    int font = lookup(widget["font"] | "", fontNames, LAYOUT_FONTS);
+    if (font < 0 && (type == WIDGET_TEXT || type == WIDGET_BATTERY))
+        return "unknown font";
+    op.font = max(font, 0);
+
+    switch (type)
+    {
+    case WIDGET_TEXT:
+    {
+        const char *name = widget["field"] | "";
+        int field = 0;
+        while (field < FIELD_COUNT && strcmp(name, fields[field].name) != 0)
+            field++;
+        if (field == FIELD_COUNT)
+            return "unknown field";
+        op.field = field;
+        const field_info_t &info = fields[field];
+        if (field == FIELD_NONE)
+        {
+            const char *text = widget["text"] | "";
+            if (*text == 0)
+                return "no field or text";
+            op.str = pool_add(layout, text);
+        }
+        else
+        {
+            if (info.scope != 0 && !(info.scope & ((part < 0) ? FACT : PART)))
+                return (part < 0) ? "the field is only in the forecast" : "the field is only in the current weather";
+            const char *format = widget["format"] | defaultFormats[info.kind];
+            if (!format_ok(format, info.kind))
+                return "the format does not fit the field";
+            op.str = pool_add(layout, format);
+        }
+        if (op.str == LAYOUT_NONE)
+            return "the text is too long or there is too much text";
+        if (widget["wrap"] | false)
+            op.flags |= LAYOUT_WRAP;
+        if (widget.containsKey("rule"))
+        {
+            op.flags |= LAYOUT_RULE;
+            op.b = widget["rule"] | 0;
+        }
+        break;
+    }
+    case WIDGET_IMAGE:
+        op.a = widget["w"] | 0;
+        op.b = widget["h"] | 0;
+        if (op.a <= 0 || op.b <= 0)
+            return "no w or h";
+        op.str = pool_add(layout, widget["name"] | "");
+        if (op.str == LAYOUT_NONE || layout.pool[op.str] == 0)
+            return "no name or too much text";
+        break;
+    case WIDGET_COMPASS:
+    case WIDGET_SUN:
+        op.a = widget["r"] | 0;
+        if (op.a <= 0)
+            return "no r";
+        break;
+    case WIDGET_LINE:
+        op.a = widget["x2"] | 0;
+        op.b = widget["y2"] | 0;
+        break;
+    }
+    // Fixed texts, images and lines are all chrome, the compass and the sun have the rose and the path
+    bool fixed = (type == WIDGET_TEXT && op.field == FIELD_NONE) || type == WIDGET_IMAGE || type == WIDGET_COMPASS ||
+                 type == WIDGET_SUN || type == WIDGET_LINE;
+    if (fixed && !(op.flags & (LAYOUT_FROM_LEFT | LAYOUT_FROM_RIGHT)))
+        op.flags |= LAYOUT_CHROME;
+    return NULL;
+}
+
+// The ops of the text from /layout.bin when they are compiled from this very text, compiled and cached otherwise
+static bool load(fs::FS &fs, const char *json, size_t size)
+{
+    uint32_t source = crc32_le(0, (const uint8_t *)json, size);
+    if (read_cache(fs, source))
+        return true;
+    if (!layout_compile(json, size, layout))
+        return false;
+    write_cache(fs, source);
+    return true;
+}
+
+// What the executor relies on, against a damaged cache file: what layout_compile() checks, printf formats too
+static bool ops_valid(const layout_t &layout)
+{
+    if (layout.poolSize > 0 && layout.pool[layout.poolSize - 1] != 0)
+        return false;
+    for (uint16_t i = 0; i < layout.count; i++)
+    {
+        const layout_op_t &op = layout.ops[i];
+        if (op.type >= WIDGET_COUNT || op.field >= FIELD_COUNT || op.font >= LAYOUT_FONTS || op.align > CENTER ||
+            op.part < -1 || op.part > 1 || (op.str != LAYOUT_NONE && op.str >= layout.poolSize))
+            return false;
+        if ((op.type == WIDGET_TEXT || op.type == WIDGET_IMAGE) && op.str == LAYOUT_NONE)
+            return false;
+        if (op.type == WIDGET_TEXT && op.field != FIELD_NONE && !format_ok(layout.pool + op.str, fields[op.field].kind))
+            return false;
+    }
+    return true;
+}
+
+static bool read_cache(fs::FS &fs, uint32_t source)
+{
+    if (!fs.exists(LAYOUT_CACHE))
+        return false;
+    File f = fs.open(LAYOUT_CACHE, FILE_READ);
+    cache_header_t header;
+    if (!f || f.read((uint8_t *)&header, sizeof(header)) != sizeof(header) || header.magic != CACHE_MAGIC ||
+        header.version != CACHE_VERSION || header.source != source || header.count > LAYOUT_MAX_OPS ||
+        header.infoCount > header.count || header.poolSize > LAYOUT_POOL)
+        return false;
+    size_t size = header.count * sizeof(layout_op_t);
+    if (f.read((uint8_t *)layout.ops, size) != size || f.read((uint8_t *)layout.pool, header.poolSize) != header.poolSize)
+        return false;
+    layout.count = header.count;
+    layout.infoCount = header.infoCount;
+    layout.poolSize = header.poolSize;
+    return ops_valid(layout);
+}
+
+static void write_cache(fs::FS &fs, uint32_t source)
+{
+    cache_header_t header = {CACHE_MAGIC, CACHE_VERSION, layout.count, layout.infoCount, layout.poolSize, source};
+    File f = fs.open(LAYOUT_CACHE, FILE_WRITE);
+    size_t size = layout.count * sizeof(layout_op_t);
+    if (!f || f.write((uint8_t *)&header, sizeof(header)) != sizeof(header) ||
+        f.write((uint8_t *)layout.ops, size) != size ||
+        f.write((uint8_t *)layout.pool, layout.poolSize) != layout.poolSize)
+        log_i("layout: can't write %s", LAYOUT_CACHE);
+}
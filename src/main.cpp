@@ -2,257 +2,195 @@
 #include <ArduinoJson.h>
 #include <HTTPClient.h>
 #include <WiFi.h>
+#include <WiFiUdp.h>
 #include <Wire.h>
 #include <SPIFFS.h>
 #include <time.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "epd_driver.h"
 #include "lang.h"
 #include "weather_data.h"
+#include "weather_vocab.h"
+#include "weather_json.h"
 #include "ftp_server.h"
 #include "web_server.h"
 #include "esp_adc_cal.h"
+#include "esp_timer.h"
 #include "param_data.h"
+#include "weather_snapshot.h"
+#include "panel.h"
+#include "render.h"
+#include "glyph_cache.h"
+#include "display_list.h"
+#include "icon_atlas.h"
+#include "layout.h"
+#include "wake_profile.h"
+#include "clock_sync.h"
+#include "param_cache.h"
+#include "param_json.h"
+#include "refresh_policy.h"
 
-#include "osans6b.h"
-#include "osans8b.h"
-#include "osans10b.h"
-#include "osans12b.h"
-#include "osans16b.h"
-#include "osans18b.h"
-#include "osans24b.h"
-#include "osans26b.h"
-#include "osans32b.h"
-#include "osans48b.h"
-
-#define PRINT_PARAM 1
 #define PRINT_DATA 0
-#define SAVE_LAST_DATA 1
+#define SAVE_LAST_DATA 1 // Keep the last answer as a binary snapshot for test mode and as a fallback
+#define STREAM_DECODE 1 // Deserialize the answer straight from the HTTP stream, 0 - buffer the whole body first
+
+#define WIFI_TIMEOUT 10000     // ms for one association with a scan and DHCP
+#define WIFI_FAST_TIMEOUT 3000 // ms for the cached AP, then it is scanned for
+#define WIFI_LEASE_WAKES 48    // Fast connects on a cached IP before it is renewed over DHCP
+#define NTP_PORT 123
+#define NTP_LOCAL_PORT 2390
+#define NTP_TIMEOUT 1500       // ms for the answer
+#define NTP_EPOCH 2208988800LL // s from 1900 to 1970
+#define CHROME_STACK 8192 // layout_get() can compile /layout.json on it
+
+// Weather documents go to PSRAM
+struct SpiRamAllocator
+{
+  void *allocate(size_t size) { return ps_malloc(size); }
+  void deallocate(void *pointer) { free(pointer); }
+  void *reallocate(void *pointer, size_t size) { return ps_realloc(pointer, size); }
+};
+typedef BasicJsonDocument<SpiRamAllocator> SpiRamJsonDocument;
 
 #define AP_SSID "WEATHER_STATION"
 #define AP_PASS "0123456789"
 
-#define White 0xFF
-#define LightGrey 0xBB
-#define Grey 0x88
-#define DarkGrey 0x44
-#define Black 0x00
-
 const char *ntpServer = "0.europe.pool.ntp.org";
 
-enum alignment
-{
-  LEFT,
-  RIGHT,
-  CENTER
-};
-
-enum icon_size
-{
-  SmallIcon,
-  LargeIcon
-};
-
 uint8_t currentHour = 0, currentMin = 0, currentSec = 0, eventCnt = 0;
-long sleepDuration = 60; // Sleep time in minutes, aligned to the nearest minute boundary, so if 30 will always update at 00 or 30 past the hour
-uint8_t wakeupHour = 5;  // Don't wakeup until after 05:00 to save battery power
-uint8_t sleepHour = 1;   // Sleep after 01:00 to save battery power
-long startTime = 0;
+long sleepDuration = 60; // Base sleep time in minutes, the refresh policy stretches or shortens it
 long sleepTimer = 0;
-long delta = 30; // ESP32 rtc speed compensation, prevents display at xx:59:yy and then xx:00:yy (one minute later) to save power
-
-#define L_SIZE 250
-#define S_SIZE 100
-
-// #define Large 20 // For icon drawing
-// #define Small 8  // For icon drawing
+SemaphoreHandle_t chromeDone = NULL;
+SemaphoreHandle_t fsLock = NULL;
+bool fsMounted = false;
+
+RTC_DATA_ATTR uint32_t inputsHash = 0;     // Weather model and status line values of the frame on the panel
+RTC_DATA_ATTR uint32_t frameHash = 0;      // Display list of the frame on the panel
+RTC_DATA_ATTR uint32_t refreshSkipped = 0; // Wakes that left the panel untouched
+RTC_DATA_ATTR uint32_t refreshDone = 0;    // Wakes that refreshed the panel
+
+// The AP and the DHCP lease of the last full connect, the next wakes skip the scan and DHCP
+typedef struct
+{
+  uint32_t key; // Of the SSID and password the cache is for, 0 - empty
+  uint8_t bssid[6];
+  uint8_t channel;
+  uint8_t uses; // Fast connects since the lease
+  uint32_t ip;
+  uint32_t gateway;
+  uint32_t subnet;
+  uint32_t dns1;
+  uint32_t dns2;
+} wifi_cache_t;
+
+RTC_DATA_ATTR wifi_cache_t wifiCache;
+RTC_DATA_ATTR uint32_t wifiFastCnt = 0; // Connects by the cache and the ms they took
+RTC_DATA_ATTR uint32_t wifiFastMs = 0;
+RTC_DATA_ATTR uint32_t wifiFullCnt = 0; // ... with a scan and DHCP
+RTC_DATA_ATTR uint32_t wifiFullMs = 0;
 
 Web_Server server;
 FTP_Server ftp;
 param_t param;
 weather_t weather;
 int wifi_signal = -120;
-
-GFXfont currentFont;
+float battery_voltage = 0;
 uint8_t *displayBuffer;
 
+bool mount_fs();
 uint8_t start_WiFi();
+bool wait_WiFi(uint32_t timeout);
+void log_WiFi_saving();
+void cache_WiFi(uint32_t key);
 void stop_WiFi();
 boolean setup_time();
+void set_timezone();
+bool quiet_wake();
+bool ntp_offset(const char *server, int64_t &offset);
+int64_t ntp_us(const uint8_t *timestamp);
 boolean update_local_time();
 void begin_sleep();
 void ap_config();
 bool decode_json(char *jsonStr, int size);
+bool decode_stream(Stream &stream);
 bool getWeather();
-void display_weather();
-void display_info();
-bool getIcon(String iconName);
-String convert_unix_time(int unix_time);
-String get_description_condition(String str);
-void draw_battery(int x, int y);
-void draw_RSSI(int x, int y, int rssi);
-void display_fact_weather();
-String getSeason(String season);
-String get_partName(String pName);
-void display_forecast_weather();
-void draw_wind_section(int x, int y, String dir, float speed, float gust, int Cradius, bool fact);
-void draw_thp_section(uint16_t x, uint16_t y);
-void draw_sun_section(uint16_t x, uint16_t y);
-void draw_moon_section(uint16_t x, uint16_t y, String hemisphere);
-void draw_thp_forecast_section(uint16_t x, uint16_t y, uint8_t part);
-uint8_t *load_file(String fileName);
-void drawStringWithLB(int x, int y, String str, GFXfont font, alignment align);
-void draw_conditions_section(int x, int y, String IconName, uint8_t forecast_part, bool IconSize);
-void arrow(int x, int y, int asize, float aangle, int pwidth, int plength);
-void fillCircle(int x, int y, int r, uint8_t color);
-int drawString(int x, int y, String text, alignment align);
-void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color);
-void drawCircle(int x0, int y0, int r, uint8_t color, bool fill);
-void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
-void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
-void fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color);
-void drawPixel(int x, int y, uint8_t color);
-void setFont(GFXfont const &font);
-void edp_update();
+void show_weather();
+void start_chrome();
+void chrome_task(void *arg);
+void draw_chrome();
+void wait_chrome();
+uint32_t fnv1a(const void *data, size_t size, uint32_t hash);
+uint32_t weather_hash(uint32_t hash);
+float read_battery_voltage();
 
 void setup()
 {
   bool _settingsEn = false;
+  profile_begin(esp_sleep_get_wakeup_cause());
   pinMode(39, INPUT_PULLUP);
-  if (SPIFFS.begin())
+  fsLock = xSemaphoreCreateMutex();
+  profile_start(PHASE_PARAM);
+  bool _ready = param_restore(param); // SPIFFS is left for the chrome task on all but the first wake
+  if (!_ready && mount_fs())
+  {
+    _ready = true;
+    if (param_read(SPIFFS, param))
+      param_store(param);
+  }
+  profile_stop(PHASE_PARAM);
+  if (_ready)
   {
     epd_init();
     displayBuffer = (uint8_t *)ps_calloc(sizeof(uint8_t), EPD_WIDTH * EPD_HEIGHT / 2);
     if (!displayBuffer)
       log_i("Memory alloc failed!");
     memset(displayBuffer, 0xFF, EPD_WIDTH * EPD_HEIGHT / 2);
-    log_i("SPIFFS begin");
-
-    if (SPIFFS.exists("/param.json"))
-    {
-      File f = SPIFFS.open("/param.json", FILE_READ);
-      int _size = f.size();
-      char _param[_size];
-      f.readBytes(_param, _size);
-      DynamicJsonDocument jsonDoc(_size);                            // allocate the JsonDocument
-      DeserializationError error = deserializeJson(jsonDoc, _param); // Deserialize the JSON document
-      if (error)
-      {
-        log_i("deserializeJson() failed: %s", error.c_str());
-      }
-      else
-      {
-        // convert it to a JsonObject
-        JsonObject jo = jsonDoc.as<JsonObject>();
-        param.city = jo["city"].as<char *>();
-        param.lat = jo["lat"].as<float>();
-        param.lon = jo["lon"].as<float>();
-        param.test_data = jo["test_data"].as<bool>();
-        param.api_key = jo["api_key"].as<char *>();
-        param.update_interval = jo["update_interval"].as<uint8_t>();
-        param.time_zone = jo["time_zone"].as<int8_t>();
-        param.ap_ssid = jo["ap_ssid"].as<char *>();
-        param.ap_pass = jo["ap_pass"].as<char *>();
-#if PRINT_PARAM
-        log_i("\tcity: %s", param.city.c_str());
-        log_i("\tlat: %s", String(param.lat, 6).c_str());
-        log_i("\tlon: %s", String(param.lon, 6).c_str());
-        log_i("\ttest_data: %d", param.test_data);
-        log_i("\tapi_key: %s", param.api_key.c_str());
-        log_i("\tupdate_interval: %d", param.update_interval);
-        log_i("\ttime_zone: %d", param.time_zone);
-        log_i("\tap_ssid: %s", param.ap_ssid.c_str());
-        log_i("\tap_pass: %s", param.ap_pass.c_str());
-        log_i("param deserializeJson() success");
-#endif
-      }
-    }
-    else
-    {
-      log_i("param.json file not found");
-    }
 
     if ((!digitalRead(39)) || (param.api_key == ""))
     {
       _settingsEn = true;
+      frameHash = 0; // The panel no longer shows the weather frame
+      inputsHash = 0;
       if (!digitalRead(39))
         log_i("IO39 is pressing");
       if (param.api_key == "")
         log_i("api_key is empty");
+      for (uint8_t i = profile_count(); i > 1; i--)
+        profile_log(i - 1); // The wakes before this one, also at /wakes
+      log_WiFi_saving();
+      param_invalidate(); // param.json can be changed from the web page or over FTP
+      mount_fs();
       ap_config();
       server.begin(&SPIFFS);
       ftp.addFilesystem("SPIFFS", &SPIFFS);
       ftp.begin();
+      panel_invalidate();
+      atlas_invalidate(); // A new atlas can come over FTP
+      layout_invalidate(SPIFFS); // And a new layout
       epd_poweron();
       epd_clear();
+      display_settings(AP_SSID, AP_PASS); // The QR codes too, the screen goes to the panel in one push
       edp_update();
-
-      int x = 20;
-      int y = 20;
-      setFont(osans16b);
-      drawString(x, y, F("WEB-метеостанция не настроена!"), LEFT);
-      y += osans16b.advance_y;
-
-      drawString(x, y, F("Wi-Fi точка доступа запущена!"), LEFT);
-      y += osans16b.advance_y;
-
-      drawString(x, y, "SSID: " + String(AP_SSID), LEFT);
-      y += osans16b.advance_y;
-
-      drawString(x, y, "PASSWORD: " + String(AP_PASS), LEFT);
-      y += osans16b.advance_y;
-
-      setFont(osans12b);
-      drawString(x, y, "Адрес страницы настройки: http://192.168.4.1/index.html", LEFT);
-      y += osans12b.advance_y;
-
-      drawString(x, y, "FTP-сервер запущен. user: esp32, pass: esp32", LEFT);
-      edp_update();
-
-      uint8_t *_data;
-      _data = load_file("wifi_img.bin");
-      if (_data != NULL)
-      {
-        Rect_t area = {
-            .x = 80, .y = 300, .width = 200, .height = 200};
-        epd_draw_grayscale_image(area, (uint8_t *)_data);
-        free(_data);
-      }
-      _data = load_file("url_img.bin");
-      if (_data != NULL)
-      {
-        Rect_t area = {
-            .x = 680, .y = 300, .width = 200, .height = 200};
-        epd_draw_grayscale_image(area, (uint8_t *)_data);
-        free(_data);
-      }
       delay(5000);
       epd_poweroff_all();
     }
+    else if (!param.test_data && quiet_wake())
+      log_i("quiet hours, nothing is drawn or fetched");
     else
     {
+      start_chrome(); // Drawn while WiFi, NTP and the weather request wait
       if (param.test_data)
       {
         if (getWeather())
-        {
-          epd_poweron();
-          epd_clear();
-          display_info();
-          display_weather();
-          edp_update();
-          delay(5000);
-          epd_poweroff_all();
-        }
+          show_weather();
       }
       else
       {
         if (start_WiFi() == WL_CONNECTED && setup_time() == true)
         {
-          bool _wakeUp = false;
-          if (wakeupHour > sleepHour)
-            _wakeUp = (currentHour >= wakeupHour || currentHour <= sleepHour);
-          else
-            _wakeUp = (currentHour >= wakeupHour && currentHour <= sleepHour);
-          if (_wakeUp)
+          if (!policy_quiet(time(NULL), param))
           {
             byte _attempts = 1;
             bool _rxWeather = false;
@@ -263,39 +201,62 @@ void setup()
                 _rxWeather = getWeather();
               _attempts++;
             }
+            bool _fresh = _rxWeather;
+            if (!_rxWeather)
+            {
+              _rxWeather = mount_fs() && snapshot_load(SPIFFS, weather); // Last known good
+              if (_rxWeather)
+                log_i("weather fetch failed, showing the last snapshot");
+            }
             if (_rxWeather)
             {
-              epd_poweron();
-              epd_clear();
-              display_info();
-              display_weather();
-              stop_WiFi();
-              edp_update();
-              delay(5000);
-              epd_poweroff_all();
+              wait_chrome(); // The chrome task is on the atlas too, and the atlas has one File and index
+              prefetch_icons(); // Still connected, the frame is drawn with the radio off
             }
+            stop_WiFi();
+            if (_rxWeather)
+              show_weather();
+            if (_fresh)
+              policy_observe(weather, battery_percentage(battery_voltage)); // The change rates for the next wake
           }
         }
       }
-      begin_sleep();
     }
   }
-  else
-  {
-    log_i("SPIFFS begin failed");
-  }
   if (!_settingsEn)
     begin_sleep();
 }
 
+// SPIFFS is mounted by the first one to need it, a wake on the cached param_t can do without
+bool mount_fs()
+{
+  if (fsLock != NULL)
+    xSemaphoreTake(fsLock, portMAX_DELAY); // The chrome task and the fetch can get here together
+  if (!fsMounted)
+  {
+    profile_start(PHASE_SPIFFS);
+    fsMounted = SPIFFS.begin();
+    profile_stop(PHASE_SPIFFS);
+    log_i("SPIFFS begin%s", fsMounted ? "" : " failed");
+  }
+  if (fsLock != NULL)
+    xSemaphoreGive(fsLock);
+  return fsMounted;
+}
+
 void begin_sleep()
 {
+  wait_chrome(); // Every way here, the chrome task can still be on SPIFFS
   epd_poweroff_all();
-  update_local_time();
-  sleepTimer = ((param.update_interval * sleepDuration * 60) - ((currentMin % sleepDuration) * 60 + currentSec)) + delta; // Some ESP32 have a RTC that is too fast to maintain accurate time, so add an offset
-  esp_sleep_enable_timer_wakeup(sleepTimer * 1000000LL);                                                                  // in Secs, 1000000LL converts to Secs as unit = 1uSec
-  esp_sleep_enable_ext0_wakeup(GPIO_NUM_39, 0);                                                                           // 1 = High, 0 = Low
-  log_i("Awake for: %d -secs", ((millis() - startTime) / 1000.0, 3));
+  // The wake time is by the clock, clock_sleep() makes up for the RTC drift
+  policy_decision_t _decision = policy_next(time(NULL), param.update_interval * sleepDuration * 60, param);
+  policy_log(_decision);
+  uint64_t _sleep = clock_sleep(_decision.next * 1000000LL);
+  sleepTimer = _sleep / 1000000;
+  esp_sleep_enable_timer_wakeup(_sleep);
+  esp_sleep_enable_ext0_wakeup(GPIO_NUM_39, 0); // 1 = High, 0 = Low
+  profile_end(); // Logs the timeline of the wake
+  log_i("Awake for: %.3f secs", esp_timer_get_time() / 1000000.0);
   log_i("Entering %d (secs) of sleep time", sleepTimer);
   log_i("Starting deep-sleep period...");
   esp_deep_sleep_start(); // Sleep for e.g. 30 minutes
@@ -312,23 +273,129 @@ void ap_config()
   log_i("AP IP address: %s", myIP.toString().c_str());
 }
 
-void display_weather()
+void show_weather()
+{
+  battery_voltage = read_battery_voltage();
+  // Everything the frame is drawn from, quantized the way it is printed
+  int32_t _status[] = {battery_percentage(battery_voltage), (int32_t)lroundf(battery_voltage * 10), (wifi_signal + 100) / 20};
+  uint32_t _inputs = weather_hash(2166136261u);
+  _inputs = fnv1a(_status, sizeof(_status), _inputs);
+  _inputs = fnv1a(param.city.c_str(), param.city.length(), _inputs);
+  bool _refresh = false;
+  if (_inputs != inputsHash)
+  {
+    wait_chrome();
+    profile_start(PHASE_RENDER);
+    display_info();
+    display_weather();
+    profile_stop(PHASE_RENDER);
+    uint32_t _frame = dl_hash();
+    _refresh = (_frame != frameHash);
+    inputsHash = _inputs;
+    frameHash = _frame;
+  }
+  if (_refresh)
+  {
+    profile_start(PHASE_PANEL);
+    epd_poweron();
+    if (!panel_update(SPIFFS, displayBuffer))
+    {
+      frameHash = 0; // Not on the panel, the next wake must not skip it as unchanged
+      inputsHash = 0;
+    }
+    const glyph_cache_stats_t &_glyphs = glyph_cache_stats();
+    log_i("glyph cache: %u hits, %u misses, %u evictions, %u bytes", _glyphs.hits, _glyphs.misses, _glyphs.evictions, _glyphs.bytes);
+    delay(5000);
+    epd_poweroff_all();
+    profile_stop(PHASE_PANEL);
+    refreshDone++;
+  }
+  else
+    refreshSkipped++;
+  log_i("panel %s, refreshes: %u done, %u skipped", _refresh ? "refreshed" : "unchanged", refreshDone, refreshSkipped);
+}
+
+// The weather-independent part of the frame goes to displayBuffer on a task of its own
+void start_chrome()
+{
+  chromeDone = xSemaphoreCreateBinary();
+  if (chromeDone != NULL &&
+      xTaskCreatePinnedToCore(chrome_task, "chrome", CHROME_STACK, NULL, uxTaskPriorityGet(NULL), NULL, xPortGetCoreID()) == pdPASS)
+    return;
+  log_i("chrome: no task, drawn before the fetch");
+  if (chromeDone != NULL)
+    vSemaphoreDelete(chromeDone);
+  chromeDone = NULL;
+  draw_chrome();
+}
+
+void chrome_task(void *arg)
 {
-  drawLine(0, 50, EPD_WIDTH, 50, Black);
-  display_fact_weather();
-  display_forecast_weather();
+  draw_chrome();
+  xSemaphoreGive(chromeDone);
+  vTaskDelete(NULL);
 }
 
-void display_info()
+void draw_chrome()
 {
-  setFont(osans12b);
-  drawString(10, 15, param.city, LEFT);
-  drawString(400, 15, convert_unix_time(weather.now), LEFT);
-  draw_battery(680, 30);
-  draw_RSSI(900, 35, wifi_signal);
+  profile_start(PHASE_CHROME);
+  mount_fs(); // Off the main task, while WiFi connects
+  display_chrome();
+  dl_draw_ahead(SPIFFS, displayBuffer);
+  profile_stop(PHASE_CHROME);
 }
 
-bool getIcon(String iconName)
+// The weather goes over the chrome, in the same display list
+void wait_chrome()
+{
+  uint32_t _start = millis();
+  if (chromeDone != NULL)
+  {
+    xSemaphoreTake(chromeDone, portMAX_DELAY);
+    vSemaphoreDelete(chromeDone);
+    chromeDone = NULL;
+  }
+  log_i("chrome: %u commands, waited %u ms for them", dl_count(), millis() - _start);
+}
+
+uint32_t fnv1a(const void *data, size_t size, uint32_t hash)
+{
+  const uint8_t *_data = (const uint8_t *)data;
+  for (size_t i = 0; i < size; i++)
+    hash = (hash ^ _data[i]) * 16777619u;
+  return hash;
+}
+
+// The weather fields the frame is drawn from, by value: the answer's own timestamps, the URL and the padding of
+// weather_t would make every fetch look new. The answer time is printed to the minute
+uint32_t weather_hash(uint32_t hash)
+{
+  const fact_weather_t &_fact = weather.fact;
+  int32_t _values[] = {weather.now / 60, _fact.condition, _fact.season, _fact.wind_dir, _fact.feels_like, _fact.humidity,
+                       _fact.pressure_mm, _fact.temp};
+  float _floats[] = {_fact.wind_gust, _fact.wind_speed};
+  const char *_strings[] = {_fact.condition_token, _fact.season_token, icon_name(_fact.icon), weather.forecast.sunrise,
+                            weather.forecast.sunset};
+  hash = fnv1a(_values, sizeof(_values), hash);
+  hash = fnv1a(_floats, sizeof(_floats), hash);
+  for (uint8_t i = 0; i < sizeof(_strings) / sizeof(_strings[0]); i++)
+    hash = fnv1a(_strings[i], strlen(_strings[i]) + 1, hash);
+  for (uint8_t i = 0; i < 2; i++)
+  {
+    const forecast_part_t &_part = weather.forecast.parts[i];
+    int32_t _partValues[] = {_part.condition, _part.part_name, _part.wind_dir, _part.feels_like, _part.humidity,
+                             _part.pressure_mm, _part.prec_prob, _part.temp_avg};
+    float _partFloats[] = {_part.prec_mm, _part.wind_gust, _part.wind_speed};
+    const char *_partStrings[] = {_part.condition_token, _part.part_name_token, icon_name(_part.icon)};
+    hash = fnv1a(_partValues, sizeof(_partValues), hash);
+    hash = fnv1a(_partFloats, sizeof(_partFloats), hash);
+    for (uint8_t j = 0; j < sizeof(_partStrings) / sizeof(_partStrings[0]); j++)
+      hash = fnv1a(_partStrings[j], strlen(_partStrings[j]) + 1, hash);
+  }
+  return hash;
+}
+
+bool getIcon(const char *iconName)
 {
   HTTPClient _http;
   String _host = "yastatic.net";
@@ -336,107 +403,37 @@ bool getIcon(String iconName)
   WiFiClient _client;
   _client.stop();
 
-  _http.begin(_client, _host, 80, String(_uri + iconName + ".svg"), true);
+  _http.begin(_client, _host, 80, _uri + iconName + ".svg", true);
   int _httpCode = _http.GET();
 
   if (_httpCode == HTTP_CODE_OK)
   {
-    int _size = _client.available();
-    log_i("icon size: %d", _size);
-
-    File f = SPIFFS.open(String("/" + iconName + ".svg"), FILE_WRITE);
-    uint8_t *_data;
-    _data = (uint8_t *)ps_calloc(sizeof(uint8_t), _size);
-    _client.readBytes(_data, _size);
-    f.write(_data, _size);
+    // The whole body: available() is only what has arrived so far, and a cut SVG is not drawn
+    String _fileName = "/" + String(iconName) + ".svg";
+    File f = SPIFFS.open(_fileName, FILE_WRITE);
+    int _size = _http.writeToStream(&f);
     f.close();
+    _http.end();
+    log_i("icon size: %d", _size);
+    if (_size <= 0)
+    {
+      SPIFFS.remove(_fileName);
+      return false;
+    }
     log_i("icon file saved!");
-    free(_data);
     return true;
   }
   else
   {
     log_i("get icon error: %s(%d)", _http.errorToString(_httpCode).c_str(), _httpCode);
+    _http.end();
     return false;
   }
 }
 
-String convert_unix_time(int unix_time)
-{
-  time_t tm = unix_time;
-  struct tm *now_tm = localtime(&tm);
-  char output[40];
-  strftime(output, sizeof(output), "%H:%M %d.%m.%y", now_tm);
-  return output;
-}
-
-void drawStringWithLB(int x, int y, String str, GFXfont font, alignment align)
-{
-  int8_t _index = str.indexOf(' ');
-  //_index /= 2;
-  log_i("str: %s, lenght: %d", str.c_str(), str.length());
-  log_i("str.indexOf(\" \"): %d", _index);
-  setFont(font);
-  if (_index == -1)
-  {
-    drawString(x, y + font.advance_y / 2, str, align);
-    return;
-  }
-  String _str = str.substring(0, _index);
-  drawString(x, y, _str, align);
-
-  _str = str.substring(_index + 1, str.length());
-  drawString(x, y + font.advance_y, _str, align);
-}
-
-String get_description_condition(String str)
-{
-  String retStr = str;
-  if (str == "clear")
-    retStr = "Ясно";
-  if (str == "partly-cloudy")
-    retStr = "Малооблачно";
-  if (str == "cloudy")
-    retStr = "Облачно с прояснениями";
-  if (str == "overcast")
-    retStr = "Пасмурно";
-  if (str == "drizzle")
-    retStr = "Моросящий дождь";
-  if (str == "light-rain")
-    retStr = "Небольшой дождь";
-  if (str == "rain")
-    retStr = "Дождь";
-  if (str == "moderate-rain")
-    retStr = "Умеренно сильный дождь";
-  if (str == "heavy-rain")
-    retStr = "Сильный дождь";
-  if (str == "continuous-heavy-rain")
-    retStr = "Длительный сильный дождь";
-  if (str == "showers")
-    retStr = "Ливень";
-  if (str == "wet-snow")
-    retStr = "Дождь со снегом";
-  if (str == "light-snow")
-    retStr = "Небольшой снег";
-  if (str == "snow")
-    retStr = "Снег";
-  if (str == "snow-showers")
-    retStr = "Снегопад";
-  if (str == "hail")
-    retStr = "Град";
-  if (str == "thunderstorm")
-    retStr = "Гроза";
-  if (str == "thunderstorm-with-rain")
-    retStr = "Дождь с грозой";
-  if (str == "thunderstorm-with-hail")
-    retStr = "Гроза с градом";
-  return retStr;
-}
-
-void draw_battery(int x, int y)
+float read_battery_voltage()
 {
   int vref = 1100;
-  uint8_t _percentage = 100;
   esp_adc_cal_characteristics_t adc_chars;
   esp_adc_cal_value_t val_type = esp_adc_cal_characterize(ADC_UNIT_1, ADC_ATTEN_DB_11, ADC_WIDTH_BIT_12, 1100, &adc_chars);
   if (val_type == ESP_ADC_CAL_VAL_EFUSE_VREF)
@@ -445,431 +442,187 @@ void draw_battery(int x, int y)
     vref = adc_chars.vref;
   }
   float _voltage = analogRead(36) / 4096.0 * 6.566 * (vref / 1000.0);
-  if (_voltage > 1)
-  { // Only display if there is a valid reading
-    log_i("Voltage = %.2f", _voltage);
-    _percentage = 2836.9625 * pow(_voltage, 4) - 43987.4889 * pow(_voltage, 3) + 255233.8134 * pow(_voltage, 2) - 656689.7123 * _voltage + 632041.7303;
-    if (_voltage >= 4.20)
-      _percentage = 100;
-    if (_voltage <= 3.20)
-      _percentage = 0; // orig 3.5
-    drawRect(x + 25, y - 14, 40, 15, Black);
-    fillRect(x + 65, y - 10, 4, 7, Black);
-    fillRect(x + 27, y - 12, 36 * _percentage / 100.0, 11, Black);
-    drawString(x + 85, y - 14, String(_percentage) + "%  " + String(_voltage, 1) + "v", LEFT);
-  }
+  log_i("Voltage = %.2f", _voltage);
+  return _voltage;
 }
 
-void draw_RSSI(int x, int y, int rssi)
-{
-  int WIFIsignal = 0;
-  int xpos = 1;
-  for (int _rssi = -100; _rssi <= rssi; _rssi = _rssi + 20)
-  {
-    if (_rssi <= -20)
-      WIFIsignal = 20; //            <-20dbm displays 5-bars
-    if (_rssi <= -40)
-      WIFIsignal = 16; //  -40dbm to  -21dbm displays 4-bars
-    if (_rssi <= -60)
-      WIFIsignal = 12; //  -60dbm to  -41dbm displays 3-bars
-    if (_rssi <= -80)
-      WIFIsignal = 8; //  -80dbm to  -61dbm displays 2-bars
-    if (_rssi <= -100)
-      WIFIsignal = 4; // -100dbm to  -81dbm displays 1-bar
-    fillRect(x + xpos * 8, y - WIFIsignal, 6, WIFIsignal, Black);
-    xpos++;
-  }
-}
-
-String getSeason(String season)
-{
-  if (season == "summer")
-    return "Лето";
-  if (season == "autumn")
-    return "Осень";
-  if (season == "winter")
-    return "Зима";
-  if (season == "spring")
-    return "Весна";
-  return season;
-}
-
-void display_fact_weather()
-{
-  draw_wind_section(830, 200, weather.fact.wind_dir, weather.fact.wind_speed, weather.fact.wind_gust, 100, true);
-  setFont(osans18b);
-  drawString(20, 60, getSeason(weather.fact.season), LEFT);
-  draw_thp_section(480, 70);
-  draw_conditions_section(20, 50, weather.fact.icon, 0, LargeIcon);
-  draw_sun_section(480, 330);
-}
-
-void draw_thp_section(uint16_t x, uint16_t y) // temperature, humidity, pressure section
+uint8_t start_WiFi()
 {
-  int xOffset = 20;
-  setFont(osans48b);
-  drawString(x, y, String(weather.fact.temp) + " °C", CENTER);
-  y += osans26b.advance_y + 4;
-
-  setFont(osans16b);
-  drawString(x, y, String(weather.fact.feels_like) + " °C", CENTER);
-  y += osans8b.advance_y;
-
-  setFont(osans8b);
-  drawString(x, y, "(ощущается)", CENTER);
-  y += osans12b.advance_y;
-
-  setFont(osans24b);
-  int sw = drawString(x - xOffset, y, String(weather.fact.humidity) + "%", RIGHT);
-
-  uint8_t *data = load_file("blob.bin");
-  if (data != NULL)
+  WiFi.disconnect();
+  WiFi.persistent(false); // The credentials are in param.json, not written to flash on every wake
+  WiFi.mode(WIFI_STA); // switch off AP
+  WiFi.setAutoConnect(true);
+  WiFi.setAutoReconnect(true);
+  profile_start(PHASE_WIFI);
+  uint32_t _start = millis();
+  uint32_t _key = fnv1a(param.ap_ssid.c_str(), param.ap_ssid.length(), 2166136261u);
+  _key = fnv1a(param.ap_pass.c_str(), param.ap_pass.length(), _key) | 1;
+  bool _fast = (wifiCache.key == _key && wifiCache.uses < WIFI_LEASE_WAKES);
+  if (_fast)
   {
-    Rect_t area = {
-        .x = x - xOffset - sw - 40,
-        .y = y,
-        .width = 36,
-        .height = 40};
-    epd_draw_grayscale_image(area, (uint8_t *)data);
-    free(data);
+    WiFi.config(IPAddress(wifiCache.ip), IPAddress(wifiCache.gateway), IPAddress(wifiCache.subnet),
+                IPAddress(wifiCache.dns1), IPAddress(wifiCache.dns2));
+    WiFi.begin(param.ap_ssid.c_str(), param.ap_pass.c_str(), wifiCache.channel, wifiCache.bssid);
+    _fast = wait_WiFi(WIFI_FAST_TIMEOUT);
+    if (!_fast)
+    {
+      log_i("WiFi: the cached AP did not answer, scanning");
+      WiFi.disconnect();
+      WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE); // Back to DHCP
+    }
   }
-
-  int ex;
-  ex = drawString(x + xOffset, y, String(weather.fact.pressure_mm), LEFT) + 5;
-
-  setFont(osans10b);
-  //drawString(x + xOffset + ex, y, "mm/Hg", LEFT);
-  int exx = drawString(x + xOffset + ex, y, "mm", LEFT);
-  y += osans10b.advance_y / 2;
-  drawLine(x + xOffset + ex, y + 2, x + xOffset + ex + exx, y + 2, Black);
-  drawString(x + xOffset + ex, y, "Hg", LEFT);
-}
-
-void draw_sun_section(uint16_t x, uint16_t y)
-{
-  float x1, y1;
-  int16_t r = 100;
-  y += 25;
-
-  bool pen = true;
-  for (uint8_t i = 0; i < 1; i++)
+  for (uint8_t _attempt = 0; _attempt < 2 && WiFi.status() != WL_CONNECTED; _attempt++)
   {
-    for (float a = 30; a <= 150;)
+    if (_attempt > 0)
     {
-      x1 = (r + i) * cos((a - 180.0) / 180.0 * PI) + x;
-      y1 = (r + i) * sin((a - 180.0) / 180.0 * PI) + y;
-      drawPixel(x1, y1, Black);
-      a += 0.01;
+      Serial.printf("STA: Failed!\n");
+      WiFi.disconnect(false);
+      delay(500);
     }
+    WiFi.begin(param.ap_ssid.c_str(), param.ap_pass.c_str());
+    wait_WiFi(WIFI_TIMEOUT);
   }
-
-  uint8_t *data;
-  data = load_file("sunrise.bin");
-  if (data != NULL)
+  profile_stop(PHASE_WIFI);
+  uint32_t _elapsed = millis() - _start;
+  if (WiFi.status() == WL_CONNECTED)
   {
-    Rect_t area = {.x = x - r - 10, .y = y - 50, .width = 47, .height = 35};
-    epd_draw_grayscale_image(area, (uint8_t *)data);
-    free(data);
+    wifi_signal = WiFi.RSSI();
+    if (_fast)
+    {
+      wifiCache.uses++;
+      wifiFastCnt++;
+      wifiFastMs += _elapsed;
+    }
+    else
+    {
+      cache_WiFi(_key);
+      wifiFullCnt++;
+      wifiFullMs += _elapsed;
+    }
+    log_i("WiFi connected at: %s, %s connect in %u ms (mean: fast %u ms of %u, full %u ms of %u)",
+          WiFi.localIP().toString().c_str(), _fast ? "fast" : "full", _elapsed,
+          wifiFastCnt ? wifiFastMs / wifiFastCnt : 0, wifiFastCnt, wifiFullCnt ? wifiFullMs / wifiFullCnt : 0, wifiFullCnt);
+    log_WiFi_saving();
   }
-  data = load_file("sunset.bin");
-  if (data != NULL)
+  else
   {
-    Rect_t area = {.x = x + r - 35, .y = y - 50, .width = 47, .height = 40};
-    epd_draw_grayscale_image(area, (uint8_t *)data);
-    free(data);
+    wifiCache.key = 0;
+    log_i("WiFi connection *** FAILED ***");
   }
-  setFont(osans10b);
-  drawString(x - r - 20, y - 35, weather.forecast.sunrise, RIGHT);
-  drawString(x + r + 20, y - 35, weather.forecast.sunset, LEFT);
-}
-
-int JulianDate(int d, int m, int y)
-{
-  int mm, yy, k1, k2, k3, j;
-  yy = y - (int)((12 - m) / 10);
-  mm = m + 9;
-  if (mm >= 12)
-    mm = mm - 12;
-  k1 = (int)(365.25 * (yy + 4712));
-  k2 = (int)(30.6001 * mm + 0.5);
-  k3 = (int)((int)((yy / 100) + 49) * 0.75) - 38;
-  j = k1 + k2 + d + 59 + 1;
-  if (j > 2299160)
-    j = j - k3;
-  return j;
+  return WiFi.status();
 }
 
-void draw_thp_forecast_section(uint16_t x, uint16_t y, uint8_t part)
+// Like waitForConnectResult(), with a timeout
+bool wait_WiFi(uint32_t timeout)
 {
-  setFont(osans24b);
-  drawString(x, y, String(weather.forecast.parts[part].temp_avg) + " °C", CENTER);
-
-  setFont(osans18b);
-  drawString(x, y + 45, String(weather.forecast.parts[part].feels_like) + " °C", CENTER);
-
-  setFont(osans6b);
-  drawString(x, y + 73, "(ощущается)", CENTER);
-
-  setFont(osans10b);
-  drawString(x, y + 95, String(weather.forecast.parts[part].pressure_mm), CENTER);
-
-  setFont(osans6b);
-  drawString(x, y + 110, "mm/Hg", CENTER);
+  uint32_t _start = millis();
+  while ((WiFi.status() == WL_IDLE_STATUS || WiFi.status() >= WL_DISCONNECTED) && millis() - _start < timeout)
+    delay(10);
+  return WiFi.status() == WL_CONNECTED;
 }
 
-uint8_t *load_file(String fileName)
+// What the cached AP and lease save a wake: the mean full connect less the mean fast one, and over all fast connects
+void log_WiFi_saving()
 {
-  String _fileName = "/" + fileName;
-  uint8_t *data;
-  log_i("file name: %s", _fileName.c_str());
-  if (SPIFFS.exists(_fileName))
+  if (wifiFastCnt == 0 || wifiFullCnt == 0)
   {
-    log_i("file %s is exist", _fileName.c_str());
-    File f = SPIFFS.open(_fileName, FILE_READ);
-    int size = f.size();
-    log_i("file size: %d", size);
-    data = (uint8_t *)ps_calloc(sizeof(uint8_t), size);
-    f.readBytes((char *)data, size);
-    f.close();
-    return data;
-  }
-  else
-  {
-    log_i("file not found");
-    data = NULL;
-    return data;
+    log_i("WiFi: no saving yet, %u fast and %u full connect(s)", wifiFastCnt, wifiFullCnt);
+    return;
   }
-};
+  int32_t _saving = (int32_t)(wifiFullMs / wifiFullCnt) - (int32_t)(wifiFastMs / wifiFastCnt);
+  log_i("WiFi: the fast connect saves %d ms a wake, %d ms over %u wakes", _saving, _saving * (int32_t)wifiFastCnt,
+        wifiFastCnt);
+}
 
-void draw_conditions_section(int x, int y, String IconName, uint8_t forecast_part, bool IconSize)
+// The AP and the lease of this connect, for the next wakes
+void cache_WiFi(uint32_t key)
 {
-  String fileName = "";
-  fileName += IconName + ((IconSize == LargeIcon) ? ("L") : (""));
-  fileName += ".bin";
-  log_i("icon name: %s | file name: %s", IconName.c_str(), fileName.c_str());
-  uint8_t *data = load_file(fileName);
-  if (data != NULL)
-  {
-    Rect_t area = {
-        .x = x,
-        .y = y,
-        .width = ((IconSize == LargeIcon) ? (L_SIZE) : (S_SIZE)),
-        .height = ((IconSize == LargeIcon) ? (L_SIZE) : (S_SIZE))};
-    epd_draw_grayscale_image(area, (uint8_t *)data);
-    free(data);
-  }
-  else
-  {
-    if (IconSize == LargeIcon)
-      setFont(osans18b);
-    else
-      setFont(osans10b);
-    drawString(x, y, IconName, LEFT);
-    getIcon(IconName);
-  }
-
-  if (IconSize == LargeIcon)
-  {
-    drawStringWithLB(x + L_SIZE / 2, y + L_SIZE + 5, get_description_condition(weather.fact.condition), osans8b, CENTER);
-  }
-  else
-  {
-    drawStringWithLB(x + 10, y + S_SIZE - 5, get_description_condition(weather.forecast.parts[forecast_part].condition), osans6b, LEFT);
-    uint8_t prec_prob = weather.forecast.parts[forecast_part].prec_prob;
-    drawString(x + S_SIZE / 2, y + S_SIZE + 30, String(weather.forecast.parts[forecast_part].prec_mm, 1) + "mm", CENTER);
-    drawString(x + S_SIZE / 2, y + S_SIZE + 45, String(prec_prob) + "%", CENTER);
-  }
+  memcpy(wifiCache.bssid, WiFi.BSSID(), sizeof(wifiCache.bssid));
+  wifiCache.channel = WiFi.channel();
+  wifiCache.uses = 0;
+  wifiCache.ip = WiFi.localIP();
+  wifiCache.gateway = WiFi.gatewayIP();
+  wifiCache.subnet = WiFi.subnetMask();
+  wifiCache.dns1 = WiFi.dnsIP(0);
+  wifiCache.dns2 = WiFi.dnsIP(1);
+  wifiCache.key = key;
 }
 
-String get_partName(String pName)
+void stop_WiFi()
 {
-  if (pName == "night")
-    return "Ночь";
-  if (pName == "morning")
-    return "Утро";
-  if (pName == "day")
-    return "День";
-  if (pName == "evening")
-    return "Вечер";
-  return pName;
+  WiFi.disconnect();
+  WiFi.mode(WIFI_OFF);
+  log_i("WiFi switched Off");
 }
 
-void display_forecast_weather()
+boolean setup_time()
 {
-  int y = 350;
-  drawLine(0, y, EPD_WIDTH, y, Black);
-  drawLine(EPD_WIDTH / 2, y, EPD_WIDTH / 2, EPD_HEIGHT, Black);
-  int xOffSet = EPD_WIDTH / 2;
-  for (uint8_t i = 0; i < 2; i++)
+  profile_start(PHASE_NTP);
+  set_timezone();
+  clock_wake();
+  if (clock_sync_due())
   {
-    setFont(osans10b);
-    drawString(i * xOffSet + 10, y + 5, get_partName(weather.forecast.parts[i].part_name), LEFT);
-    draw_conditions_section(i * xOffSet + 10, y + 20, weather.forecast.parts[i].icon, i, SmallIcon);
-    draw_wind_section((i * xOffSet) + (i + xOffSet - 90), y + 90,
-                      weather.forecast.parts[i].wind_dir,
-                      weather.forecast.parts[i].wind_speed,
-                      weather.forecast.parts[i].wind_gust,
-                      60, false);
-    draw_thp_forecast_section(i * xOffSet + 210, y + 30, i);
+    int64_t _offset;
+    if (ntp_offset(ntpServer, _offset) || ntp_offset("time.nist.gov", _offset))
+      clock_sync(_offset);
+    else
+      log_i("NTP: no answer, the clock goes by its drift");
   }
+  bool _synced = update_local_time();
+  profile_stop(PHASE_NTP);
+  return _synced;
 }
 
-int16_t get_wind_angle(String dir)
+void set_timezone()
 {
-  if (dir == "nw")
-    return 315;
-  if (dir == "n")
-    return 0;
-  if (dir == "ne")
-    return 45;
-  if (dir == "e")
-    return 90;
-  if (dir == "se")
-    return 135;
-  if (dir == "s")
-    return 180;
-  if (dir == "sw")
-    return 225;
-  if (dir == "w")
-    return 270;
-  if (dir == "c")
-    return -1;
+  char _tz[16];
+  snprintf(_tz, sizeof(_tz), "UTC%+d", -param.time_zone); // POSIX counts the offset westwards
+  setenv("TZ", _tz, 1);
+  tzset();
 }
 
-void arrow(int x, int y, int asize, float aangle, int pwidth, int plength)
+// Quiet hours by the clock as it woke up, before WiFi and NTP: the hours go by 15 minute slots, the drift
+// does not matter. A clock that was never set is not trusted, NTP decides on that wake
+bool quiet_wake()
 {
-  float arr;
-  if (aangle > 180.0)
-    arr = aangle - 180.0;
-  else
-    arr = aangle + 180.0;
-
-  float dx = (float)(asize - 10) * cos((arr - 90) * PI / 180) + x; // calculate X position
-  float dy = (float)(asize - 10) * sin((arr - 90) * PI / 180) + y; // calculate Y position
-  float x1 = 0;
-  float y1 = plength;
-  float x2 = pwidth / 2;
-  float y2 = pwidth / 2;
-  float x3 = -pwidth / 2;
-  float y3 = pwidth / 2;
-  float angle = arr * PI / 180 - 135;
-  float xx1 = x1 * cos(angle) - y1 * sin(angle) + dx;
-  float yy1 = y1 * cos(angle) + x1 * sin(angle) + dy;
-  float xx2 = x2 * cos(angle) - y2 * sin(angle) + dx;
-  float yy2 = y2 * cos(angle) + x2 * sin(angle) + dy;
-  float xx3 = x3 * cos(angle) - y3 * sin(angle) + dx;
-  float yy3 = y3 * cos(angle) + x3 * sin(angle) + dy;
-  fillTriangle(xx1, yy1, xx3, yy3, xx2, yy2, Black);
+  set_timezone();
+  time_t _now = time(NULL);
+  return _now >= POLICY_CLOCK_SET && policy_quiet(_now, param);
 }
 
-void draw_wind_section(int x, int y, String dir, float speed, float gust, int Cradius, bool fact)
+// One SNTP exchange: us the server's time is ahead of the system clock, half the round trip taken out
+bool ntp_offset(const char *server, int64_t &offset)
 {
-  if (fact)
-  {
-    if (dir != "c")
-      arrow(x, y, Cradius - 22, get_wind_angle(dir), 16, 33);
-  }
-  else
-  {
-    if (dir != "c")
-      arrow(x, y, Cradius - 10, get_wind_angle(dir), 8, 20);
-  }
-  setFont(osans8b);
-  int dxo, dyo, dxi, dyi;
-  drawCircle(x, y, Cradius, Black, false);       // Draw compass circle
-  drawCircle(x, y, Cradius + 1, Black, false);   // Draw compass circle
-  drawCircle(x, y, Cradius + 2, Black, false);   // Draw compass circle
-  drawCircle(x, y, Cradius * 0.7, Black, false); // Draw compass inner circle
-  for (float a = 0; a < 360; a = a + 22.5)
-  {
-    dxo = Cradius * cos((a - 90) * PI / 180);
-    dyo = Cradius * sin((a - 90) * PI / 180);
-    if (a == 45)
-      drawString(dxo + x + 15, dyo + y - 18, TXT_NE, CENTER);
-    if (a == 135)
-      drawString(dxo + x + 20, dyo + y - 2, TXT_SE, CENTER);
-    if (a == 225)
-      drawString(dxo + x - 20, dyo + y - 2, TXT_SW, CENTER);
-    if (a == 315)
-      drawString(dxo + x - 15, dyo + y - 18, TXT_NW, CENTER);
-    dxi = dxo * 0.9;
-    dyi = dyo * 0.9;
-    drawLine(dxo + x, dyo + y, dxi + x, dyi + y, Black);
-    dxo = dxo * 0.7;
-    dyo = dyo * 0.7;
-    dxi = dxo * 0.9;
-    dyi = dyo * 0.9;
-    drawLine(dxo + x, dyo + y, dxi + x, dyi + y, Black);
-  }
-  drawString(x, y - Cradius - 20, TXT_N, CENTER);
-  drawString(x, y + Cradius + 10, TXT_S, CENTER);
-  drawString(x - Cradius - 15, y - 5, TXT_W, CENTER);
-  drawString(x + Cradius + 10, y - 5, TXT_E, CENTER);
-
-  if (fact)
-  {
-    setFont(osans12b);
-    String wind = dir;
-    wind.toUpperCase();
-    drawString(x, y - 55, wind, CENTER);
-    setFont(osans24b);
-    drawString(x, y - 33, String(speed, 1), CENTER);
-    setFont(osans12b);
-    drawString(x, y + 14, String(gust, 1), CENTER);
-    setFont(osans12b);
-    drawString(x, y + 40, "м/с", CENTER);
-  }
-  else
-  {
-    setFont(osans8b);
-    String wind = dir;
-    wind.toUpperCase();
-    drawString(x, y - 35, wind, CENTER);
-    setFont(osans12b);
-    drawString(x, y - 17, String(speed, 1), CENTER);
-    setFont(osans8b);
-    drawString(x, y + 5, String(gust, 1), CENTER);
-    setFont(osans8b);
-    drawString(x, y + 20, "м/с", CENTER);
-  }
-}
-
-uint8_t start_WiFi()
-{
-  WiFi.disconnect();
-  WiFi.mode(WIFI_STA); // switch off AP
-  WiFi.setAutoConnect(true);
-  WiFi.setAutoReconnect(true);
-  WiFi.begin(param.ap_ssid.c_str(), param.ap_pass.c_str());
-  if (WiFi.waitForConnectResult() != WL_CONNECTED)
+  WiFiUDP _udp;
+  uint8_t _packet[48] = {0x23}; // Version 4, client
+  if (!_udp.begin(NTP_LOCAL_PORT))
+    return false;
+  int64_t _sent = clock_now();
+  bool _ok = _udp.beginPacket(server, NTP_PORT) && _udp.write(_packet, sizeof(_packet)) == sizeof(_packet) && _udp.endPacket();
+  uint32_t _start = millis();
+  while (_ok && _udp.parsePacket() < (int)sizeof(_packet))
   {
-    Serial.printf("STA: Failed!\n");
-    WiFi.disconnect(false);
-    delay(500);
-    WiFi.begin(param.ap_ssid.c_str(), param.ap_pass.c_str());
+    _ok = (millis() - _start < NTP_TIMEOUT);
+    delay(1);
   }
-  if (WiFi.status() == WL_CONNECTED)
+  int64_t _received = clock_now();
+  _ok = _ok && _udp.read(_packet, sizeof(_packet)) == sizeof(_packet) && _packet[1] != 0; // Stratum 0 - go away
+  _udp.stop();
+  if (!_ok)
   {
-    wifi_signal = WiFi.RSSI();
-    log_i("WiFi connected at: %s", WiFi.localIP().toString().c_str());
+    log_i("NTP: %s did not answer", server);
+    return false;
   }
-  else
-    log_i("WiFi connection *** FAILED ***");
-  return WiFi.status();
-}
-
-void stop_WiFi()
-{
-  WiFi.disconnect();
-  WiFi.mode(WIFI_OFF);
-  log_i("WiFi switched Off");
+  offset = ((ntp_us(_packet + 32) - _sent) + (ntp_us(_packet + 40) - _received)) / 2;
+  return true;
 }
 
-boolean setup_time()
+// A big endian NTP timestamp, s since 1900 and a 32 bit fraction, in us since 1970
+int64_t ntp_us(const uint8_t *timestamp)
 {
-  configTime((param.time_zone * 3600), 0, ntpServer, "time.nist.gov");
-  delay(100);
-  return update_local_time();
+  uint32_t _s = (uint32_t)timestamp[0] << 24 | (uint32_t)timestamp[1] << 16 | (uint32_t)timestamp[2] << 8 | timestamp[3];
+  uint32_t _f = (uint32_t)timestamp[4] << 24 | (uint32_t)timestamp[5] << 16 | (uint32_t)timestamp[6] << 8 | timestamp[7];
+  return ((int64_t)_s - NTP_EPOCH) * 1000000 + (((uint64_t)_f * 1000000) >> 32);
 }
 
 boolean update_local_time()
@@ -894,35 +647,35 @@ boolean update_local_time()
 void print_weather()
 {
   log_i("\nfact:");
-  log_i(" condition: %s", weather.fact.condition.c_str());
-  log_i(" daytime: %s", weather.fact.daytime.c_str());
+  log_i(" condition: %s", condition_label(weather.fact.condition));
+  log_i(" daytime: %d", weather.fact.daytime);
   log_i(" feels_like: %d", weather.fact.feels_like);
   log_i(" humidity: %d", weather.fact.humidity);
-  log_i(" icon: %s", weather.fact.icon.c_str());
-  log_i(" obs_time: %s", weather.fact.obs_time);
+  log_i(" icon: %s", icon_name(weather.fact.icon));
+  log_i(" obs_time: %d", weather.fact.obs_time);
   log_i(" polar: %d", weather.fact.polar);
   log_i(" pressure_mm: %d", weather.fact.pressure_mm);
   log_i(" pressure_pa: %d", weather.fact.pressure_pa);
-  log_i(" season: %s", weather.fact.season.c_str());
+  log_i(" season: %s", season_label(weather.fact.season));
   log_i(" temp: %d", weather.fact.temp);
   log_i(" temp_water: %d", weather.fact.temp_water);
-  log_i(" wind_dir: %s", weather.fact.wind_dir.c_str());
+  log_i(" wind_dir: %s", wind_dir_label(weather.fact.wind_dir));
   log_i(" wind_gust: %.1f", weather.fact.wind_gust);
   log_i(" wind_speed: %.1f", weather.fact.wind_speed);
   log_i("\nforecast:");
-  log_i(" date: %s", weather.forecast.date.c_str());
+  log_i(" date: %s", weather.forecast.date);
   log_i(" date_ts: %d", weather.forecast.date_ts);
   log_i(" moon_code: %d", weather.forecast.moon_code);
-  log_i(" moon_text: %s", weather.forecast.moon_text.c_str());
+  log_i(" moon_text: %s", weather.forecast.moon_text);
   for (uint8_t i = 0; i < 2; i++)
   {
     log_i("\n part[%d]:", i);
-    log_i("condition: %s", weather.forecast.parts[i].condition.c_str());
-    log_i("daytime: %s", weather.forecast.parts[i].daytime.c_str());
+    log_i("condition: %s", condition_label(weather.forecast.parts[i].condition));
+    log_i("daytime: %d", weather.forecast.parts[i].daytime);
     log_i("feels_like: %d", weather.forecast.parts[i].feels_like);
     log_i("humidity: %d", weather.forecast.parts[i].humidity);
-    log_i("icon: %s", weather.forecast.parts[i].icon.c_str());
-    log_i("part_name: %s", weather.forecast.parts[i].part_name.c_str());
+    log_i("icon: %s", icon_name(weather.forecast.parts[i].icon));
+    log_i("part_name: %s", part_name_label(weather.forecast.parts[i].part_name));
     log_i("polar: %d", weather.forecast.parts[i].polar);
     log_i("prec_mm: %.1f", weather.forecast.parts[i].prec_mm);
     log_i("prec_period: %d", weather.forecast.parts[i].prec_period);
@@ -933,87 +686,52 @@ void print_weather()
     log_i("temp_max: %d", weather.forecast.parts[i].temp_max);
     log_i("temp_min: %d", weather.forecast.parts[i].temp_min);
     log_i("temp_water: %d", weather.forecast.parts[i].temp_water);
-    log_i("wind_dir: %s", weather.forecast.parts[i].wind_dir.c_str());
+    log_i("wind_dir: %s", wind_dir_label(weather.forecast.parts[i].wind_dir));
     log_i("wind_gust: %.1f", weather.forecast.parts[i].wind_gust);
     log_i("wind_speed: %.1f", weather.forecast.parts[i].wind_speed);
   }
-  log_i("sunrise: %s", weather.forecast.sunrise.c_str());
-  log_i("sunset: %s", weather.forecast.sunset.c_str());
+  log_i("sunrise: %s", weather.forecast.sunrise);
+  log_i("sunset: %s", weather.forecast.sunset);
   log_i("week: %d", weather.forecast.week);
   log_i("\ninfo:");
   log_i("lat: %f", weather.info.lat);
   log_i("lon: %f", weather.info.lon);
-  log_i("url: %s", weather.info.url.c_str());
+  log_i("url: %s", weather.info.url);
 
   log_i("now: %d", weather.now);
-  log_i("now_dt: %s", weather.now_dt.c_str());
+  log_i("now_dt: %s", weather.now_dt);
 }
 #endif
 
 bool decode_json(char *jsonStr, int size)
 {
   log_i("weather data:");
-  log_i("%s", jsonStr);
-  DynamicJsonDocument jsonDoc(size);                              // allocate the JsonDocument
-  DeserializationError error = deserializeJson(jsonDoc, jsonStr); // Deserialize the JSON document
+  log_i("%.*s", size, jsonStr);
+  SpiRamJsonDocument jsonDoc(size);                                     // allocate the JsonDocument
+  DeserializationError error = deserializeJson(jsonDoc, jsonStr, size); // Deserialize the JSON document
   if (error)
   { // Test if parsing succeeds.
     log_i("deserializeJson() failed: %s", error.c_str());
     return false;
   }
-  // convert it to a JsonObject
-  JsonObject jo = jsonDoc.as<JsonObject>();
-  // read from JsonObject
-  weather.fact.condition = jo["fact"]["condition"].as<char *>();
-  weather.fact.daytime = jo["fact"]["daytime"].as<char *>();
-  weather.fact.feels_like = jo["fact"]["feels_like"].as<int8_t>();
-  weather.fact.humidity = jo["fact"]["humidity"].as<uint8_t>();
-  weather.fact.icon = jo["fact"]["icon"].as<char *>();
-  weather.fact.obs_time = jo["fact"]["obs_time"].as<int>();
-  weather.fact.polar = jo["fact"]["polar"].as<bool>();
-  weather.fact.pressure_mm = jo["fact"]["pressure_mm"].as<uint16_t>();
-  weather.fact.pressure_pa = jo["fact"]["pressure_pa"].as<uint16_t>();
-  weather.fact.season = jo["fact"]["season"].as<char *>();
-  weather.fact.temp = jo["fact"]["temp"].as<int8_t>();
-  weather.fact.temp_water = jo["fact"]["temp_water"].as<int8_t>();
-  weather.fact.wind_dir = jo["fact"]["wind_dir"].as<char *>();
-  weather.fact.wind_gust = jo["fact"]["wind_gust"].as<float>();
-  weather.fact.wind_speed = jo["fact"]["wind_speed"].as<float>();
+  decode_weather(jsonDoc.as<JsonObject>(), weather);
+#if PRINT_DATA
+  print_weather();
+#endif
+  return true;
+}
 
-  weather.forecast.date = jo["forecast"]["date"].as<String>();
-  weather.forecast.date_ts = jo["forecast"]["date_ts"].as<int>();
-  weather.forecast.moon_code = jo["forecast"]["moon_code"].as<uint8_t>();
-  weather.forecast.moon_text = jo["forecast"]["moon_text"].as<char *>();
-  for (uint8_t i = 0; i < 2; i++)
+bool decode_stream(Stream &stream)
+{
+  SpiRamJsonDocument jsonDoc(WEATHER_DOC_SIZE); // Off loopTask's stack and the internal heap
+  DeserializationError error = deserializeJson(jsonDoc, stream, DeserializationOption::Filter(weather_filter()));
+  if (error)
   {
-    weather.forecast.parts[i].condition = jo["forecast"]["parts"][i]["condition"].as<char *>();
-    weather.forecast.parts[i].daytime = jo["forecast"]["parts"][i]["daytime"].as<char *>();
-    weather.forecast.parts[i].feels_like = jo["forecast"]["parts"][i]["feels_like"].as<int8_t>();
-    weather.forecast.parts[i].humidity = jo["forecast"]["parts"][i]["humidity"].as<uint8_t>();
-    weather.forecast.parts[i].icon = jo["forecast"]["parts"][i]["icon"].as<char *>();
-    weather.forecast.parts[i].part_name = jo["forecast"]["parts"][i]["part_name"].as<char *>();
-    weather.forecast.parts[i].polar = jo["forecast"]["parts"][i]["polar"].as<bool>();
-    weather.forecast.parts[i].prec_mm = jo["forecast"]["parts"][i]["prec_mm"].as<float>();
-    weather.forecast.parts[i].prec_period = jo["forecast"]["parts"][i]["prec_period"].as<uint16_t>();
-    weather.forecast.parts[i].prec_prob = jo["forecast"]["parts"][i]["prec_prob"].as<uint8_t>();
-    weather.forecast.parts[i].pressure_mm = jo["forecast"]["parts"][i]["pressure_mm"].as<uint16_t>();
-    weather.forecast.parts[i].pressure_pa = jo["forecast"]["parts"][i]["pressure_pa"].as<uint16_t>();
-    weather.forecast.parts[i].temp_avg = jo["forecast"]["parts"][i]["temp_avg"].as<int8_t>();
-    weather.forecast.parts[i].temp_max = jo["forecast"]["parts"][i]["temp_max"].as<int8_t>();
-    weather.forecast.parts[i].temp_min = jo["forecast"]["parts"][i]["temp_min"].as<int8_t>();
-    weather.forecast.parts[i].temp_water = jo["forecast"]["parts"][i]["temp_water"].as<uint8_t>();
-    weather.forecast.parts[i].wind_dir = jo["forecast"]["parts"][i]["wind_dir"].as<char *>();
-    weather.forecast.parts[i].wind_gust = jo["forecast"]["parts"][i]["wind_gust"].as<float>();
-    weather.forecast.parts[i].wind_speed = jo["forecast"]["parts"][i]["wind_speed"].as<float>();
+    log_i("deserializeJson() failed: %s", error.c_str());
+    return false;
   }
-  weather.forecast.sunrise = jo["forecast"]["sunrise"].as<char *>();
-  weather.forecast.sunset = jo["forecast"]["sunset"].as<char *>();
-  weather.forecast.week = jo["forecast"]["week"].as<uint8_t>();
-  weather.info.lat = jo["info"]["lat"].as<float>();
-  weather.info.lon = jo["info"]["lon"].as<float>();
-  weather.info.url = jo["info"]["url"].as<char *>();
-  weather.now = jo["now"].as<int>();
-  weather.now_dt = jo["now_dt"].as<char *>();
+  log_i("weather doc: %d of %d bytes used", jsonDoc.memoryUsage(), jsonDoc.capacity());
+  decode_weather(jsonDoc.as<JsonObject>(), weather);
 #if PRINT_DATA
   print_weather();
 #endif
@@ -1022,24 +740,40 @@ bool decode_json(char *jsonStr, int size)
 
 bool getWeather()
 {
-  int _size;
+  bool _res = false;
+  uint32_t _heapBefore = ESP.getFreeHeap();
+  uint32_t _minBefore = ESP.getMinFreeHeap(); // The low-water mark since boot, the fetch can only move it down
   if (param.test_data)
   {
-    if (SPIFFS.exists("/test_data.json"))
+    mount_fs();
+    profile_start(PHASE_DECODE);
+    // test_data.json is parsed only when there is no valid snapshot yet (delete /weather.snap to reload it)
+    if (snapshot_load(SPIFFS, weather))
+    {
+      _res = true;
+    }
+    else if (SPIFFS.exists("/test_data.json"))
     {
       File f = SPIFFS.open("/test_data.json", FILE_READ);
-      _size = f.size();
-      char _data[_size];
+#if STREAM_DECODE
+      _res = decode_stream(f);
+      f.close();
+#else
+      int _size = f.size();
+      char *_data = (char *)ps_calloc(sizeof(char), _size);
       f.readBytes(_data, _size);
       f.close();
-      decode_json(_data, _size);
-      return true;
+      _res = decode_json(_data, _size);
+      free(_data);
+#endif
+      if (_res)
+        snapshot_save(SPIFFS, weather);
     }
     else
     {
       log_i("test_data file not found");
-      return false;
     }
+    profile_stop(PHASE_DECODE);
   }
   else
   {
@@ -1049,98 +783,46 @@ bool getWeather()
     WiFiClient _client;
     _client.stop();
 
+    profile_start(PHASE_HTTP);
     _http.begin(_client, _host, 80, _uri, true);
+    _http.useHTTP10(true); // No chunked transfer encoding, the body can be parsed right from the socket
     _http.addHeader("X-Yandex-API-Key", param.api_key);
     int _httpCode = _http.GET();
+    profile_stop(PHASE_HTTP);
 
     if (_httpCode == HTTP_CODE_OK)
     {
-      _size = _client.available();
-      char _data[_size];
-      _http.getStream().readBytes(_data, _size);
+      profile_start(PHASE_DECODE);
+#if STREAM_DECODE
+      _res = decode_stream(_http.getStream());
+#else
+      int _size = _http.getSize();
+      if (_size <= 0)
+        _size = _client.available();
+      char *_data = (char *)ps_calloc(sizeof(char), _size);
+      _size = _http.getStream().readBytes(_data, _size);
+      _res = decode_json(_data, _size);
+      free(_data);
+#endif
+      profile_stop(PHASE_DECODE);
 #if SAVE_LAST_DATA
-      File f = SPIFFS.open("/test_data.json", FILE_WRITE);
-      f.write((uint8_t *)_data, _size);
-      f.close();
+      if (_res && mount_fs())
+        snapshot_save(SPIFFS, weather);
 #endif
-      decode_json(_data, _size);
-      _client.stop();
-      _http.end();
-      return true;
     }
     else
     {
       log_i("\nconnection failed, error[%d]: %s\n", _httpCode, _http.errorToString(_httpCode).c_str());
-      _client.stop();
-      _http.end();
-      return false;
     }
-  }
-}
-
-int drawString(int x, int y, String text, alignment align)
-{
-  char *data = const_cast<char *>(text.c_str());
-  int x1, y1; // the bounds of x,y and w and h of the variable 'text' in pixels.
-  int w, h;
-  int xx = x, yy = y;
-  get_text_bounds(&currentFont, data, &xx, &yy, &x1, &y1, &w, &h, NULL);
-  if (align == RIGHT)
-    x = x - w;
-  if (align == CENTER)
-    x = x - w / 2;
-  int cursor_y = y + h;
-  write_string(&currentFont, data, &x, &cursor_y, displayBuffer);
-  return w;
-}
-
-void fillCircle(int x, int y, int r, uint8_t color)
-{
-  epd_fill_circle(x, y, r, color, displayBuffer);
-}
-
-void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color)
-{
-  epd_write_line(x0, y0, x1, y1, color, displayBuffer);
-}
-
-void drawCircle(int x0, int y0, int r, uint8_t color, bool fill)
-{
-  if (fill)
-    epd_fill_circle(x0, y0, r, color, displayBuffer);
-  else
-    epd_draw_circle(x0, y0, r, color, displayBuffer);
-}
-
-void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
-{
-  epd_draw_rect(x, y, w, h, color, displayBuffer);
-}
-
-void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
-{
-  epd_fill_rect(x, y, w, h, color, displayBuffer);
-}
-
-void fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
-                  int16_t x2, int16_t y2, uint16_t color)
-{
-  epd_fill_triangle(x0, y0, x1, y1, x2, y2, color, displayBuffer);
-}
-
-void drawPixel(int x, int y, uint8_t color)
-{
-  epd_draw_pixel(x, y, color, displayBuffer);
-}
-
-void setFont(GFXfont const &font)
-{
-  currentFont = font;
-}
-
-void edp_update()
-{
-  epd_draw_grayscale_image(epd_full_screen(), displayBuffer); // Update the screen
+    _client.stop();
+    _http.end();
+  }
+  // Without a new low-water mark the fetch took no more than what was free down to the old one
+  uint32_t _minAfter = ESP.getMinFreeHeap();
+  log_i("fetch: peak heap %s%u bytes (free before %u, lowest %u), stack high-water mark %u bytes",
+        (_minAfter < _minBefore) ? "" : "<= ", _heapBefore - _minAfter, _heapBefore, _minAfter,
+        uxTaskGetStackHighWaterMark(NULL));
+  return _res;
 }
 
 void loop()
@@ -0,0 +1,114 @@
+#include "panel.h"
+#include "display_list.h"
+
+#define ROW_BYTES (EPD_WIDTH / 2)
+
+RTC_DATA_ATTR static uint8_t partialCnt = 0;
+RTC_DATA_ATTR static bool frameOnPanel = false; // The saved display list is what the panel shows
+
+static damage_t bound(const damage_t &a, const damage_t &b);
+static int32_t area(const damage_t &r);
+static int merge_regions(damage_t *r, int n);
+static bool push_region(const damage_t &r, const uint8_t *frame);
+
+void panel_invalidate()
+{
+    frameOnPanel = false;
+}
+
+bool panel_update(fs::FS &fs, uint8_t *frame)
+{
+    uint32_t start = millis();
+    bool full = !frameOnPanel || partialCnt >= FULL_REFRESH_EVERY;
+    damage_t *regions = NULL;
+    int regionCnt = 0;
+    int32_t changed = 0;
+    bool pushed = true;
+    if (!full)
+    {
+        // A pixel can only differ inside a command that is new or gone
+        regions = dl_diff(fs, regionCnt);
+        full = (regions == NULL);
+    }
+    if (!full)
+    {
+        regionCnt = merge_regions(regions, regionCnt);
+        for (int i = 0; i < regionCnt; i++)
+            changed += area(regions[i]);
+        full = (changed * 100 > (int32_t)EPD_WIDTH * EPD_HEIGHT * FULL_REFRESH_AREA);
+    }
+
+    if (full)
+    {
+        dl_draw(fs, frame);
+        epd_clear();
+        epd_draw_grayscale_image(epd_full_screen(), frame);
+        partialCnt = 0;
+    }
+    else
+    {
+        // Only the commands that touch a region, what they draw outside it is not pushed
+        dl_draw(fs, frame, regions, regionCnt);
+        for (int i = 0; i < regionCnt && pushed; i++)
+            pushed = push_region(regions[i], frame);
+        if (pushed)
+            partialCnt++;
+        else
+            log_i("panel: no memory for a region, the next update is a full one");
+    }
+    free(regions);
+    log_i("panel: %s update, %d region(s), %d%% of the screen, %u ms", full ? "full" : "partial", regionCnt,
+          full ? 100 : changed * 100 / (EPD_WIDTH * EPD_HEIGHT), millis() - start);
+    (void)start; // Only logged
+
+    // A region that did not get to the panel must not be taken as there by the next dl_diff()
+    frameOnPanel = pushed && dl_save(fs);
+    return pushed;
+}
+
+static damage_t bound(const damage_t &a, const damage_t &b)
+{
+    int16_t x0 = min(a.x, b.x);
+    int16_t y0 = min(a.y, b.y);
+    int16_t x1 = max(a.x + a.w, b.x + b.w);
+    int16_t y1 = max(a.y + a.h, b.y + b.h);
+    return {x0, y0, (int16_t)(x1 - x0), (int16_t)(y1 - y0)};
+}
+
+static int32_t area(const damage_t &r)
+{
+    return (int32_t)r.w * r.h;
+}
+
+// Overlapping or close regions are refreshed as one, every refresh has a fixed cost
+static int merge_regions(damage_t *r, int n)
+{
+    for (int i = 0; i < n; i++)
+    {
+        for (int j = i + 1; j < n; j++)
+        {
+            if (r[j].x <= r[i].x + r[i].w + DAMAGE_MERGE_GAP && r[i].x <= r[j].x + r[j].w + DAMAGE_MERGE_GAP &&
+                r[j].y <= r[i].y + r[i].h + DAMAGE_MERGE_GAP && r[i].y <= r[j].y + r[j].h + DAMAGE_MERGE_GAP)
+            {
+                r[i] = bound(r[i], r[j]);
+                r[j] = r[--n];
+                j = i; // r[i] grew, check it against everything again
+            }
+        }
+    }
+    return n;
+}
+
+static bool push_region(const damage_t &r, const uint8_t *frame)
+{
+    uint8_t *data = (uint8_t *)ps_malloc(r.w / 2 * r.h);
+    if (data == NULL)
+        return false;
+    for (int y = 0; y < r.h; y++)
+        memcpy(data + y * r.w / 2, frame + (r.y + y) * ROW_BYTES + r.x / 2, r.w / 2);
+    Rect_t area = {.x = r.x, .y = r.y, .width = r.w, .height = r.h};
+    epd_clear_area(area);
+    epd_draw_grayscale_image(area, data);
+    free(data);
+    return true;
+}
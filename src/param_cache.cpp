@@ -0,0 +1,86 @@
+#include "param_cache.h"
+#include <rom/crc.h>
+
+typedef struct
+{
+    uint32_t crc; // crc32 of everything after it, 0 - empty
+    uint32_t generation;
+    float lat;
+    float lon;
+    uint8_t update_interval;
+    int8_t time_zone;
+    bool test_data;
+    uint8_t quiet_cnt;
+    quiet_hours_t quiet[QUIET_MAX];
+    char city[PARAM_CITY_SIZE];
+    char api_key[PARAM_API_KEY_SIZE];
+    char ap_ssid[PARAM_SSID_SIZE];
+    char ap_pass[PARAM_PASS_SIZE];
+} param_copy_t;
+
+RTC_DATA_ATTR static param_copy_t copy;
+
+static uint32_t copy_crc();
+static bool put(char *dst, size_t size, const String &src);
+
+bool param_restore(param_t &param)
+{
+    if (copy.crc == 0 || copy.crc != copy_crc())
+        return false;
+    param.generation = copy.generation;
+    param.lat = copy.lat;
+    param.lon = copy.lon;
+    param.update_interval = copy.update_interval;
+    param.time_zone = copy.time_zone;
+    param.test_data = copy.test_data;
+    param.quiet_cnt = copy.quiet_cnt;
+    memcpy(param.quiet, copy.quiet, sizeof(param.quiet));
+    param.city = copy.city;
+    param.api_key = copy.api_key;
+    param.ap_ssid = copy.ap_ssid;
+    param.ap_pass = copy.ap_pass;
+    log_i("param: generation %u from RTC memory", copy.generation);
+    return true;
+}
+
+bool param_store(const param_t &param)
+{
+    memset(&copy, 0, sizeof(copy));
+    if (!put(copy.city, sizeof(copy.city), param.city) || !put(copy.api_key, sizeof(copy.api_key), param.api_key) ||
+        !put(copy.ap_ssid, sizeof(copy.ap_ssid), param.ap_ssid) || !put(copy.ap_pass, sizeof(copy.ap_pass), param.ap_pass))
+    {
+        memset(&copy, 0, sizeof(copy));
+        log_i("param: too long for RTC memory, read from SPIFFS on every wake");
+        return false;
+    }
+    copy.generation = param.generation;
+    copy.lat = param.lat;
+    copy.lon = param.lon;
+    copy.update_interval = param.update_interval;
+    copy.time_zone = param.time_zone;
+    copy.test_data = param.test_data;
+    copy.quiet_cnt = param.quiet_cnt;
+    memcpy(copy.quiet, param.quiet, sizeof(copy.quiet));
+    copy.crc = copy_crc();
+    return true;
+}
+
+void param_invalidate()
+{
+    copy.crc = 0;
+}
+
+static uint32_t copy_crc()
+{
+    // The size goes in too, a firmware with another layout does not take the copy
+    const uint8_t *data = (const uint8_t *)&copy + sizeof(copy.crc);
+    return crc32_le(sizeof(copy), data, sizeof(copy) - sizeof(copy.crc)) | 1;
+}
+
+static bool put(char *dst, size_t size, const String &src)
+{
+    if (src.length() >= size)
+        return false;
+    memcpy(dst, src.c_str(), src.length() + 1);
+    return true;
+}
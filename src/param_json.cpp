@@ -0,0 +1,54 @@
+#include "param_json.h"
+#include <ArduinoJson.h>
+#include "refresh_policy.h"
+
+#define PRINT_PARAM 1
+
+bool param_read(fs::FS &fs, param_t &param)
+{
+    if (!fs.exists(PARAM_FILE))
+    {
+        log_i("param.json file not found");
+        return false;
+    }
+    File f = fs.open(PARAM_FILE, FILE_READ);
+    int size = f.size();
+    char json[size];
+    f.readBytes(json, size);
+    DynamicJsonDocument jsonDoc(size * 2);                                           // allocate the JsonDocument
+    DeserializationError error = deserializeJson(jsonDoc, (const char *)json, size); // Deserialize the JSON document
+    if (error)
+    {
+        log_i("deserializeJson() failed: %s", error.c_str());
+        return false;
+    }
+    // convert it to a JsonObject
+    JsonObject jo = jsonDoc.as<JsonObject>();
+    param.city = jo["city"].as<char *>();
+    param.lat = jo["lat"].as<float>();
+    param.lon = jo["lon"].as<float>();
+    param.test_data = jo["test_data"].as<bool>();
+    param.api_key = jo["api_key"].as<char *>();
+    param.update_interval = jo["update_interval"].as<uint8_t>();
+    param.time_zone = jo["time_zone"].as<int8_t>();
+    param.ap_ssid = jo["ap_ssid"].as<char *>();
+    param.ap_pass = jo["ap_pass"].as<char *>();
+    param.generation = jo["generation"].as<uint32_t>();
+    policy_quiet_hours(jo["quiet"], param);
+#if PRINT_PARAM
+    log_i("\tcity: %s", param.city.c_str());
+    log_i("\tlat: %s", String(param.lat, 6).c_str());
+    log_i("\tlon: %s", String(param.lon, 6).c_str());
+    log_i("\ttest_data: %d", param.test_data);
+    log_i("\tapi_key: %s", param.api_key.c_str());
+    log_i("\tupdate_interval: %d", param.update_interval);
+    log_i("\ttime_zone: %d", param.time_zone);
+    log_i("\tap_ssid: %s", param.ap_ssid.c_str());
+    log_i("\tap_pass: %s", param.ap_pass.c_str());
+    log_i("\tgeneration: %u", param.generation);
+    for (uint8_t i = 0; i < param.quiet_cnt; i++)
+        log_i("\tquiet: %02d:00 - %02d:00, days 0x%02x", param.quiet[i].from, param.quiet[i].to, param.quiet[i].days);
+    log_i("param deserializeJson() success");
+#endif
+    return true;
+}
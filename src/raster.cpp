@@ -0,0 +1,426 @@
+#include "raster.h"
+#include "trig.h"
+
+typedef struct
+{
+    int32_t sx, sy; // Start direction
+    int32_t ex, ey; // End direction
+    int16_t sweep;
+} sweep_t;
+
+static sweep_t sweep_of(int16_t start, int16_t end);
+static bool in_sweep(const sweep_t &s, int dx, int dy);
+static uint32_t isqrt(uint32_t n);
+static void plot(int x, int y, uint8_t color, uint8_t *framebuffer, int top, int bottom);
+static void blend(int x, int y, uint8_t color, int cover, uint8_t *framebuffer, int top, int bottom);
+static void hline(int x, int y, int length, uint8_t color, uint8_t *framebuffer, int top, int bottom);
+static void vline(int x, int y, int length, uint8_t color, uint8_t *framebuffer, int top, int bottom);
+static void arc_thin(int x, int y, int r, const sweep_t &s, uint8_t color, uint8_t *framebuffer, int top, int bottom);
+static void arc_band(int x, int y, int r, const sweep_t &s, uint8_t thickness, uint8_t color, bool aa,
+                     uint8_t *framebuffer, int top, int bottom);
+static void circle_quarters(int x0, int y0, int r, uint8_t color, uint8_t *framebuffer, int top, int bottom);
+static void blit_pixel(uint8_t *row, int x, uint8_t v);
+
+void arc_draw(int x, int y, int r, int16_t start, int16_t end, uint8_t thickness, uint8_t color, bool aa,
+              uint8_t *framebuffer, int top, int bottom)
+{
+    if (r < 0 || thickness == 0)
+        return;
+    top = max(top, 0);
+    bottom = min(bottom, EPD_HEIGHT);
+    sweep_t s = sweep_of(start, end);
+    if (thickness == 1 && !aa)
+        arc_thin(x, y, r, s, color, framebuffer, top, bottom);
+    else
+        arc_band(x, y, r, s, thickness, color, aa, framebuffer, top, bottom);
+}
+
+void image_blit(const uint8_t *data, int w, int h, int x, int y, uint8_t *framebuffer, int top, int bottom)
+{
+    int rowBytes = (w + 1) / 2;
+    int sx0 = max(0, -x), sx1 = min(w, EPD_WIDTH - x);
+    int sy0 = max(max(0, top) - y, 0), sy1 = min(h, min(bottom, EPD_HEIGHT) - y);
+    for (int sy = sy0; sy < sy1; sy++)
+    {
+        const uint8_t *src = data + sy * rowBytes;
+        uint8_t *dst = framebuffer + (y + sy) * (EPD_WIDTH / 2);
+        int sx = sx0;
+        // Pixel by pixel up to a 32-bit word of the framebuffer (8 pixels), then a word at a time
+        for (; sx < sx1 && ((x + sx) & 7) != 0; sx++)
+            blit_pixel(dst, x + sx, (sx & 1) ? (src[sx / 2] >> 4) : (src[sx / 2] & 0x0F));
+        for (; sx + 8 <= sx1; sx += 8)
+        {
+            // Little endian: pixel k of the word is nibble k, like in the framebuffer
+            uint32_t v;
+            memcpy(&v, src + sx / 2, 4);
+            if (sx & 1) // The image is half a byte off the framebuffer
+                v = (v >> 4) | ((uint32_t)src[sx / 2 + 4] << 28);
+            uint32_t t = v & (v >> 1) & (v >> 2) & (v >> 3) & 0x11111111; // 1 in each 0xF nibble
+            if (t == 0x11111111)
+                continue;
+            t *= 0x0F;
+            uint32_t *d = (uint32_t *)(dst + (x + sx) / 2);
+            *d = (*d & t) | (v & ~t);
+        }
+        for (; sx < sx1; sx++)
+            blit_pixel(dst, x + sx, (sx & 1) ? (src[sx / 2] >> 4) : (src[sx / 2] & 0x0F));
+    }
+}
+
+void line_draw(int x0, int y0, int x1, int y1, uint8_t color, uint8_t *framebuffer, int top, int bottom)
+{
+    top = max(top, 0);
+    bottom = min(bottom, EPD_HEIGHT);
+    bool steep = abs(y1 - y0) > abs(x1 - x0);
+    if (steep)
+    {
+        std::swap(x0, y0);
+        std::swap(x1, y1);
+    }
+    if (x0 > x1)
+    {
+        std::swap(x0, x1);
+        std::swap(y0, y1);
+    }
+    int dx = x1 - x0;
+    int dy = abs(y1 - y0);
+    int err = dx / 2;
+    int ystep = (y0 < y1) ? 1 : -1;
+    for (; x0 <= x1; x0++)
+    {
+        if (steep)
+            plot(y0, x0, color, framebuffer, top, bottom);
+        else
+            plot(x0, y0, color, framebuffer, top, bottom);
+        err -= dy;
+        if (err < 0)
+        {
+            y0 += ystep;
+            err += dx;
+        }
+    }
+}
+
+void rect_draw(int x, int y, int w, int h, uint8_t color, bool fill, uint8_t *framebuffer, int top, int bottom)
+{
+    top = max(top, 0);
+    bottom = min(bottom, EPD_HEIGHT);
+    if (fill)
+    {
+        for (int yy = max(y, top); yy < min(y + h, bottom); yy++)
+            hline(x, yy, w, color, framebuffer, top, bottom);
+        return;
+    }
+    hline(x, y, w, color, framebuffer, top, bottom);
+    hline(x, y + h - 1, w, color, framebuffer, top, bottom);
+    vline(x, y, h, color, framebuffer, top, bottom);
+    vline(x + w - 1, y, h, color, framebuffer, top, bottom);
+}
+
+// Midpoint circle; filled, it is the column through the centre and the columns of the octants around it
+void circle_draw(int x, int y, int r, uint8_t color, bool fill, uint8_t *framebuffer, int top, int bottom)
+{
+    top = max(top, 0);
+    bottom = min(bottom, EPD_HEIGHT);
+    if (fill)
+    {
+        vline(x, y - r, 2 * r + 1, color, framebuffer, top, bottom);
+        circle_quarters(x, y, r, color, framebuffer, top, bottom);
+        return;
+    }
+    int f = 1 - r;
+    int ddx = 1, ddy = -2 * r;
+    int px = 0, py = r;
+    plot(x, y + r, color, framebuffer, top, bottom);
+    plot(x, y - r, color, framebuffer, top, bottom);
+    plot(x + r, y, color, framebuffer, top, bottom);
+    plot(x - r, y, color, framebuffer, top, bottom);
+    while (px < py)
+    {
+        if (f >= 0)
+        {
+            py--;
+            ddy += 2;
+            f += ddy;
+        }
+        px++;
+        ddx += 2;
+        f += ddx;
+        plot(x + px, y + py, color, framebuffer, top, bottom);
+        plot(x - px, y + py, color, framebuffer, top, bottom);
+        plot(x + px, y - py, color, framebuffer, top, bottom);
+        plot(x - px, y - py, color, framebuffer, top, bottom);
+        plot(x + py, y + px, color, framebuffer, top, bottom);
+        plot(x - py, y + px, color, framebuffer, top, bottom);
+        plot(x + py, y - px, color, framebuffer, top, bottom);
+        plot(x - py, y - px, color, framebuffer, top, bottom);
+    }
+}
+
+// Scanlines between the edges, the same steps as epd_fill_triangle()
+void triangle_fill(int x0, int y0, int x1, int y1, int x2, int y2, uint8_t color, uint8_t *framebuffer, int top,
+                   int bottom)
+{
+    top = max(top, 0);
+    bottom = min(bottom, EPD_HEIGHT);
+    // Sort by y: y0 <= y1 <= y2
+    if (y0 > y1)
+    {
+        std::swap(y0, y1);
+        std::swap(x0, x1);
+    }
+    if (y1 > y2)
+    {
+        std::swap(y2, y1);
+        std::swap(x2, x1);
+    }
+    if (y0 > y1)
+    {
+        std::swap(y0, y1);
+        std::swap(x0, x1);
+    }
+    if (y2 < top || y0 >= bottom)
+        return;
+    if (y0 == y2)
+    {
+        int a = min(x0, min(x1, x2)), b = max(x0, max(x1, x2));
+        hline(a, y0, b - a + 1, color, framebuffer, top, bottom);
+        return;
+    }
+    int dx01 = x1 - x0, dy01 = y1 - y0, dx02 = x2 - x0, dy02 = y2 - y0, dx12 = x2 - x1, dy12 = y2 - y1;
+    int32_t sa = 0, sb = 0;
+    int y;
+    // Upper part, scanline y1 is in it if the lower part is flat
+    int last = (y1 == y2) ? y1 : y1 - 1;
+    for (y = y0; y <= last; y++)
+    {
+        int a = x0 + sa / dy01;
+        int b = x0 + sb / dy02;
+        sa += dx01;
+        sb += dx02;
+        if (a > b)
+            std::swap(a, b);
+        hline(a, y, b - a + 1, color, framebuffer, top, bottom);
+    }
+    sa = (int32_t)dx12 * (y - y1);
+    sb = (int32_t)dx02 * (y - y0);
+    for (; y <= y2; y++)
+    {
+        int a = x1 + sa / dy12;
+        int b = x0 + sb / dy02;
+        sa += dx12;
+        sb += dx02;
+        if (a > b)
+            std::swap(a, b);
+        hline(a, y, b - a + 1, color, framebuffer, top, bottom);
+    }
+}
+
+// Two directions are enough to tell whether a pixel is inside, no table lookups per pixel
+static sweep_t sweep_of(int16_t start, int16_t end)
+{
+    sweep_t s;
+    s.sweep = end - start; // Equal angles are a full circle
+    while (s.sweep <= 0)
+        s.sweep += 360;
+    s.sweep = min(s.sweep, (int16_t)360);
+    s.sx = trig_cos(trig_angle(start));
+    s.sy = trig_sin(trig_angle(start));
+    s.ex = trig_cos(trig_angle(end));
+    s.ey = trig_sin(trig_angle(end));
+    return s;
+}
+
+static bool in_sweep(const sweep_t &s, int dx, int dy)
+{
+    if (s.sweep >= 360)
+        return true;
+    // The cross product is positive when the second vector is clockwise from the first
+    bool afterStart = s.sx * dy - s.sy * dx >= 0;
+    bool beforeEnd = dx * s.ey - dy * s.ex >= 0;
+    return (s.sweep <= 180) ? (afterStart && beforeEnd) : (afterStart || beforeEnd);
+}
+
+static uint32_t isqrt(uint32_t n)
+{
+    uint32_t root = 0;
+    uint32_t bit = 1UL << 30;
+    while (bit > n)
+        bit >>= 2;
+    while (bit != 0)
+    {
+        if (n >= root + bit)
+        {
+            n -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+            root >>= 1;
+        bit >>= 2;
+    }
+    return root;
+}
+
+// top and bottom are within the screen here, the public functions clamp them
+static void plot(int x, int y, uint8_t color, uint8_t *framebuffer, int top, int bottom)
+{
+    if (x < 0 || x >= EPD_WIDTH || y < top || y >= bottom)
+        return;
+    epd_draw_pixel(x, y, color, framebuffer);
+}
+
+// cover is 0..64, the pixel moves that far from what is under it to the color
+static void blend(int x, int y, uint8_t color, int cover, uint8_t *framebuffer, int top, int bottom)
+{
+    if (x < 0 || x >= EPD_WIDTH || y < top || y >= bottom || cover <= 0)
+        return;
+    uint8_t p = framebuffer[y * EPD_WIDTH / 2 + x / 2];
+    int old = (x & 1) ? (p >> 4) : (p & 0x0F);
+    int v = old + ((color >> 4) - old) * min(cover, 64) / 64;
+    epd_draw_pixel(x, y, v << 4, framebuffer);
+}
+
+static void hline(int x, int y, int length, uint8_t color, uint8_t *framebuffer, int top, int bottom)
+{
+    if (y < top || y >= bottom)
+        return;
+    for (int xx = max(x, 0); xx < min(x + length, EPD_WIDTH); xx++)
+        epd_draw_pixel(xx, y, color, framebuffer);
+}
+
+static void vline(int x, int y, int length, uint8_t color, uint8_t *framebuffer, int top, int bottom)
+{
+    if (x < 0 || x >= EPD_WIDTH)
+        return;
+    for (int yy = max(y, top); yy < min(y + length, bottom); yy++)
+        epd_draw_pixel(x, yy, color, framebuffer);
+}
+
+// Midpoint circle, the same steps as epd_draw_circle()
+static void arc_thin(int x, int y, int r, const sweep_t &s, uint8_t color, uint8_t *framebuffer, int top, int bottom)
+{
+    int f = 1 - r;
+    int ddx = 1, ddy = -2 * r;
+    int px = 0, py = r;
+    const int8_t sign[4][2] = {{1, 1}, {-1, 1}, {1, -1}, {-1, -1}};
+    if (in_sweep(s, 0, r))
+        plot(x, y + r, color, framebuffer, top, bottom);
+    if (in_sweep(s, 0, -r))
+        plot(x, y - r, color, framebuffer, top, bottom);
+    if (in_sweep(s, r, 0))
+        plot(x + r, y, color, framebuffer, top, bottom);
+    if (in_sweep(s, -r, 0))
+        plot(x - r, y, color, framebuffer, top, bottom);
+    while (px < py)
+    {
+        if (f >= 0)
+        {
+            py--;
+            ddy += 2;
+            f += ddy;
+        }
+        px++;
+        ddx += 2;
+        f += ddx;
+        for (uint8_t i = 0; i < 4; i++)
+        {
+            int dx = sign[i][0] * px, dy = sign[i][1] * py;
+            if (in_sweep(s, dx, dy))
+                plot(x + dx, y + dy, color, framebuffer, top, bottom);
+            if (in_sweep(s, dy, dx))
+                plot(x + dy, y + dx, color, framebuffer, top, bottom);
+        }
+    }
+}
+
+// Pixels whose centres lie between r - 0.5 and r + thickness - 0.5, scanned row by row.
+// With aa a pixel is shaded by how far its centre is inside the band, in 1/64 of a pixel.
+static void arc_band(int x, int y, int r, const sweep_t &s, uint8_t thickness, uint8_t color, bool aa,
+                     uint8_t *framebuffer, int top, int bottom)
+{
+    int32_t inner = 2 * r - 1; // Doubled radii keep the half pixel in integers
+    int32_t outer = 2 * (r + thickness) - 1;
+    if (aa)
+    {
+        inner = max(inner - 2, (int32_t)0); // Pixels up to one away from the edge get some grey
+        outer += 2;
+    }
+    int32_t inner2 = inner * inner, outer2 = outer * outer;
+    int rows = outer / 2;
+    for (int dy = max(-rows, top - y); dy <= min(rows, bottom - 1 - y); dy++)
+    {
+        int32_t m = outer2 - 4 * dy * dy; // 4 * dx * dx has to stay below this
+        if (m <= 0)
+            continue;
+        int xOut = isqrt(m - 1) / 2;
+        int32_t k = inner2 - 4 * dy * dy; // and reach this
+        int xIn = 0;
+        if (k > 0)
+        {
+            int32_t root = isqrt(k);
+            if (root * root < k)
+                root++;
+            xIn = (root + 1) / 2;
+        }
+        for (int dx = xIn; dx <= xOut; dx++)
+        {
+            for (int side = (dx == 0) ? 1 : -1; side <= 1; side += 2)
+            {
+                int sdx = side * dx;
+                if (!in_sweep(s, sdx, dy))
+                    continue;
+                if (!aa)
+                {
+                    plot(x + sdx, y + dy, color, framebuffer, top, bottom);
+                    continue;
+                }
+                int32_t d = isqrt((uint32_t)(dx * dx + dy * dy) << 12); // Distance in 1/64
+                int32_t in = d - (2 * r - 1) * 32;
+                int32_t out = (2 * (r + thickness) - 1) * 32 - d;
+                blend(x + sdx, y + dy, color, 32 + min(in, out), framebuffer, top, bottom);
+            }
+        }
+    }
+}
+
+// fill_circle_helper() of the epd driver for both halves
+static void circle_quarters(int x0, int y0, int r, uint8_t color, uint8_t *framebuffer, int top, int bottom)
+{
+    int f = 1 - r;
+    int ddx = 1, ddy = -2 * r;
+    int x = 0, y = r;
+    int px = x, py = y;
+    while (x < y)
+    {
+        if (f >= 0)
+        {
+            y--;
+            ddy += 2;
+            f += ddy;
+        }
+        x++;
+        ddx += 2;
+        f += ddx;
+        // These checks avoid drawing some columns twice
+        if (x < y + 1)
+        {
+            vline(x0 + x, y0 - y, 2 * y + 1, color, framebuffer, top, bottom);
+            vline(x0 - x, y0 - y, 2 * y + 1, color, framebuffer, top, bottom);
+        }
+        if (y != py)
+        {
+            vline(x0 + py, y0 - px, 2 * px + 1, color, framebuffer, top, bottom);
+            vline(x0 - py, y0 - px, 2 * px + 1, color, framebuffer, top, bottom);
+            py = y;
+        }
+        px = x;
+    }
+}
+
+static void blit_pixel(uint8_t *row, int x, uint8_t v)
+{
+    if (v == 0x0F)
+        return;
+    uint8_t *b = &row[x / 2];
+    *b = (x & 1) ? ((*b & 0x0F) | (v << 4)) : ((*b & 0xF0) | v);
+}
@@ -0,0 +1,150 @@
+#include "refresh_policy.h"
+
+typedef struct
+{
+    time_t time; // fact.obs_time
+    int8_t temp;
+    uint8_t precProb;
+} policy_obs_t;
+
+static const char *const reasonNames[] = {"volatile", "calm", "battery", "quiet", "no data"};
+
+RTC_DATA_ATTR static policy_obs_t history[POLICY_HISTORY]; // history[0] is the newest
+RTC_DATA_ATTR static uint8_t historyCnt = 0;
+RTC_DATA_ATTR static uint8_t battery = UINT8_MAX; // %, UINT8_MAX - not measured yet
+
+static bool temp_slope(float &slope);
+
+void policy_observe(const weather_t &w, uint8_t percent)
+{
+    battery = percent;
+    log_i("policy: observed %ld,%d,%u,%u", (long)w.fact.obs_time, w.fact.temp, w.forecast.parts[0].prec_prob, percent);
+    policy_obs_t obs = {(time_t)w.fact.obs_time, w.fact.temp, w.forecast.parts[0].prec_prob};
+    if (historyCnt > 0 && history[0].time == obs.time)
+    {
+        history[0] = obs; // The same observation, the forecast can be newer
+        return;
+    }
+    memmove(history + 1, history, sizeof(policy_obs_t) * (POLICY_HISTORY - 1));
+    history[0] = obs;
+    if (historyCnt < POLICY_HISTORY)
+        historyCnt++;
+}
+
+bool policy_quiet(time_t time, const param_t &param)
+{
+    time_t slot = (time + POLICY_STEP / 2) / POLICY_STEP * POLICY_STEP;
+    struct tm tm;
+    localtime_r(&slot, &tm);
+    for (uint8_t i = 0; i < param.quiet_cnt; i++)
+    {
+        const quiet_hours_t &q = param.quiet[i];
+        if (tm.tm_hour >= q.from && (tm.tm_hour < q.to || q.from > q.to) && (q.days & (1 << tm.tm_wday)))
+            return true;
+        // The morning of the quiet hours that started the day before
+        if (tm.tm_hour < q.to && q.from > q.to && (q.days & (1 << (tm.tm_wday + 6) % 7)))
+            return true;
+    }
+    return false;
+}
+
+void policy_quiet_hours(JsonVariant quiet, param_t &param)
+{
+    param.quiet_cnt = 0;
+    if (quiet.isNull())
+    {
+        param.quiet[param.quiet_cnt++] = {0x7F, QUIET_FROM, QUIET_TO};
+        return;
+    }
+    for (JsonVariant q : quiet.as<JsonArray>())
+    {
+        if (param.quiet_cnt == QUIET_MAX)
+            break;
+        quiet_hours_t &entry = param.quiet[param.quiet_cnt++];
+        const char *days = q["days"] | "0123456";
+        entry.days = 0;
+        for (; *days; days++)
+        {
+            if (*days >= '0' && *days <= '6')
+                entry.days |= 1 << (*days - '0');
+        }
+        entry.from = (q["from"] | 0) % 24;
+        entry.to = (q["to"] | 0) % 24;
+    }
+}
+
+policy_decision_t policy_next(time_t now, uint32_t base, const param_t &param)
+{
+    policy_decision_t d = {};
+    d.time = now;
+    d.battery = battery;
+    d.precProb = (historyCnt > 0) ? history[0].precProb : 0;
+    // Each rate at its limit makes 1; a slope not known yet counts as halfway
+    float tempRate = 0.5;
+    if (temp_slope(d.tempSlope))
+        tempRate = min(fabsf(d.tempSlope) / (float)POLICY_TEMP_SLOPE, 1.0f);
+    else
+        d.reasons |= POLICY_NO_DATA;
+    d.volatility = max(tempRate, min(d.precProb / (float)POLICY_PREC_PROB, 1.0f));
+    // 0 - twice the base, 0.5 - the base, 1 - half of it
+    float interval = base * exp2f(1 - 2 * d.volatility);
+    if (d.volatility > 0.5)
+        d.reasons |= POLICY_VOLATILE;
+    else if (d.volatility < 0.5)
+        d.reasons |= POLICY_CALM;
+    if (battery < POLICY_BATTERY_LOW)
+    {
+        interval *= (battery < POLICY_BATTERY_CRITICAL) ? 4 : 2;
+        d.reasons |= POLICY_BATTERY;
+    }
+    d.interval = constrain(interval, (float)POLICY_MIN_INTERVAL, (float)POLICY_MAX_INTERVAL);
+    // The nearest slot, at least half a step away
+    d.next = (now + d.interval + POLICY_STEP / 2) / POLICY_STEP * POLICY_STEP;
+    for (time_t end = d.next + 7 * 24 * 3600; now >= POLICY_CLOCK_SET && policy_quiet(d.next, param) && d.next < end;
+         d.next += POLICY_STEP)
+        d.reasons |= POLICY_QUIET;
+    return d;
+}
+
+void policy_log(const policy_decision_t &decision)
+{
+    struct tm tm;
+    localtime_r(&decision.next, &tm);
+    char line[192];
+    int len = snprintf(line, sizeof(line),
+                       "policy: next wake at %02d:%02d in %ld min (%u asked), volatility %.2f: temp %+.1f/h, "
+                       "precipitation %u%%",
+                       tm.tm_hour, tm.tm_min, (long)(decision.next - decision.time) / 60, decision.interval / 60,
+                       decision.volatility, decision.tempSlope, decision.precProb);
+    if (decision.battery != UINT8_MAX)
+        len += snprintf(line + len, sizeof(line) - len, ", battery %u%%", decision.battery);
+    for (uint8_t i = 0; i < sizeof(reasonNames) / sizeof(reasonNames[0]) && len < (int)sizeof(line); i++)
+    {
+        if (decision.reasons & (1 << i))
+            len += snprintf(line + len, sizeof(line) - len, ", %s", reasonNames[i]);
+    }
+    log_i("%s", line);
+}
+
+void policy_reset()
+{
+    historyCnt = 0;
+    battery = UINT8_MAX;
+}
+
+// Degrees an hour from the oldest observation within POLICY_MAX_INTERVAL of the newest, false - too few
+static bool temp_slope(float &slope)
+{
+    slope = 0;
+    for (int8_t i = historyCnt - 1; i > 0; i--)
+    {
+        time_t span = history[0].time - history[i].time;
+        if (span > POLICY_MAX_INTERVAL)
+            continue;
+        if (span < POLICY_MIN_SPAN)
+            return false;
+        slope = (history[0].temp - history[i].temp) * 3600.0f / span;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,687 @@
+#include "render.h"
+#include <SPIFFS.h>
+#include <time.h>
+#include "lang.h"
+#include "weather_vocab.h"
+#include "panel.h"
+#include "text_run.h"
+#include "trig.h"
+#include "icon_atlas.h"
+#include "svg_raster.h"
+#include "layout.h"
+#include "display_list.h"
+
+#include "osans6b.h"
+#include "osans8b.h"
+#include "osans10b.h"
+#include "osans12b.h"
+#include "osans16b.h"
+#include "osans18b.h"
+#include "osans24b.h"
+#include "osans26b.h"
+#include "osans32b.h"
+#include "osans48b.h"
+
+#define SUN_ARC_START 210 // Angles of the sunrise and sunset ends of the arc
+#define SUN_ARC_END 330
+
+GFXfont currentFont;
+
+// In the order of the font names in layout.cpp
+static const GFXfont *const layoutFonts[LAYOUT_FONTS] = {&osans6b, &osans8b, &osans10b, &osans12b, &osans16b,
+                                                       &osans18b, &osans24b, &osans26b, &osans32b, &osans48b};
+
+enum compass_point
+{
+  POINT_N,
+  POINT_NE,
+  POINT_E,
+  POINT_SE,
+  POINT_S,
+  POINT_SW,
+  POINT_W,
+  POINT_NW,
+  POINT_COUNT
+};
+
+String convert_unix_time(int unix_time);
+void draw_battery(int x, int y);
+void draw_RSSI(int x, int y, int rssi);
+void run_layout(const layout_t &layout, int first, int last, bool chrome);
+void field_text(const layout_op_t &op, const char *format, char *text, size_t size);
+void draw_compass_rose(int x, int y, int Cradius);
+void draw_wind_section(int x, int y, wind_dir_t dir, float speed, float gust, int Cradius, bool fact);
+void draw_sun_path(int x, int y, int r);
+void draw_sun_arc(int x, int y, int r);
+int16_t sun_progress();
+void draw_moon_section(uint16_t x, uint16_t y, String hemisphere);
+void draw_condition_icon(int x, int y, uint8_t icon, bool IconSize);
+bool svg_icon(const char *name);
+void arrow(int x, int y, int asize, int16_t aangle, int pwidth, int plength);
+const text_run_t *compass_points();
+int drawRun(int x, int y, const text_run_t &run, alignment align);
+void fillCircle(int x, int y, int r, uint8_t color);
+void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color);
+void drawCircle(int x0, int y0, int r, uint8_t color, bool fill);
+void drawArc(int x, int y, int r, int16_t start, int16_t end, uint8_t thickness, uint8_t color, bool aa);
+void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+void fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint16_t color);
+void drawPixel(int x, int y, uint8_t color);
+
+// The screen is described by /layout.json, see layout.h
+void display_weather()
+{
+  const layout_t &_layout = layout_get(SPIFFS);
+  run_layout(_layout, _layout.infoCount, _layout.count, false);
+}
+
+void display_info()
+{
+  const layout_t &_layout = layout_get(SPIFFS);
+  run_layout(_layout, 0, _layout.infoCount, false);
+}
+
+void display_chrome()
+{
+  const layout_t &_layout = layout_get(SPIFFS);
+  run_layout(_layout, 0, _layout.count, true);
+}
+
+void display_settings(const char *ssid, const char *pass)
+{
+  int x = 20;
+  int y = 20;
+  setFont(osans16b);
+  drawString(x, y, F("WEB-метеостанция не настроена!"), LEFT);
+  y += osans16b.advance_y;
+
+  drawString(x, y, F("Wi-Fi точка доступа запущена!"), LEFT);
+  y += osans16b.advance_y;
+
+  drawString(x, y, "SSID: " + String(ssid), LEFT);
+  y += osans16b.advance_y;
+
+  drawString(x, y, "PASSWORD: " + String(pass), LEFT);
+  y += osans16b.advance_y;
+
+  setFont(osans12b);
+  drawString(x, y, "Адрес страницы настройки: http://192.168.4.1/index.html", LEFT);
+  y += osans12b.advance_y;
+
+  drawString(x, y, "FTP-сервер запущен. user: esp32, pass: esp32", LEFT);
+
+  draw_image("wifi_img", 80, 300, 200, 200);
+  draw_image("url_img", 680, 300, 200, 200);
+}
+
+String convert_unix_time(int unix_time)
+{
+  time_t tm = unix_time;
+  struct tm *now_tm = localtime(&tm);
+  char output[40];
+  strftime(output, sizeof(output), "%H:%M %d.%m.%y", now_tm);
+  return output;
+}
+
+// Runs ops first .. last - 1, x of an op can be counted from the ends of the text drawn before it.
+// chrome - only what the LAYOUT_CHROME ops draw whatever the weather is; otherwise everything else.
+void run_layout(const layout_t &layout, int first, int last, bool chrome)
+{
+  char _text[LAYOUT_TEXT_SIZE];
+  text_run_t _run;
+  int _left = 0, _right = 0;
+  for (int i = first; i < last; i++)
+  {
+    const layout_op_t &_op = layout.ops[i];
+    bool _fixed = _op.flags & LAYOUT_CHROME;
+    if (chrome && !_fixed)
+      continue; // The weather may not be there yet
+    bool _draw = (chrome == _fixed); // The chrome of the op, if it has any, is drawn by one of the passes
+    const char *_str = (_op.str != LAYOUT_NONE) ? layout.pool + _op.str : "";
+    const forecast_part_t *_part = (_op.part >= 0) ? &weather.forecast.parts[_op.part] : NULL;
+    int _x = _op.x;
+    if (_op.flags & LAYOUT_FROM_LEFT)
+      _x += _left;
+    if (_op.flags & LAYOUT_FROM_RIGHT)
+      _x += _right;
+    switch (_op.type)
+    {
+    case WIDGET_TEXT:
+    {
+      const GFXfont *_font = layoutFonts[_op.font];
+      if (_op.field == FIELD_NONE)
+        strlcpy(_text, _str, sizeof(_text));
+      else
+        field_text(_op, _str, _text, sizeof(_text));
+      int _y = _op.y;
+      char *_second = (_op.flags & LAYOUT_WRAP) ? strchr(_text, ' ') : NULL;
+      if (_second != NULL)
+        *_second++ = 0;
+      else if (_op.flags & LAYOUT_WRAP)
+        _y += _font->advance_y / 2; // One line is centred on the two
+      text_shape(_run, _font, _text);
+      int _w = _draw ? drawRun(_x, _y, _run, (alignment)_op.align) : _run.w; // The ops after it can need the ends
+      _left = (_op.align == RIGHT) ? _x - _w : (_op.align == CENTER) ? _x - _w / 2 : _x;
+      _right = _left + _w;
+      if (!_draw)
+        break;
+      if (_op.flags & LAYOUT_RULE)
+        drawLine(_left, _y + _op.b, _right, _y + _op.b, Black);
+      if (_second != NULL)
+      {
+        text_shape(_run, _font, _second);
+        drawRun(_x, _y + _font->advance_y, _run, (alignment)_op.align);
+      }
+      break;
+    }
+    case WIDGET_IMAGE:
+      if (_draw)
+        draw_image(_str, _x, _op.y, _op.a, _op.b);
+      break;
+    case WIDGET_ICON:
+      draw_condition_icon(_x, _op.y, _part ? _part->icon : weather.fact.icon, (_op.flags & LAYOUT_LARGE) ? LargeIcon : SmallIcon);
+      break;
+    case WIDGET_COMPASS:
+      if (_draw)
+        draw_compass_rose(_x, _op.y, _op.a);
+      if (chrome)
+        break;
+      if (_part)
+        draw_wind_section(_x, _op.y, _part->wind_dir, _part->wind_speed, _part->wind_gust, _op.a, _op.flags & LAYOUT_LARGE);
+      else
+        draw_wind_section(_x, _op.y, weather.fact.wind_dir, weather.fact.wind_speed, weather.fact.wind_gust, _op.a, _op.flags & LAYOUT_LARGE);
+      break;
+    case WIDGET_SUN:
+      if (_draw)
+        draw_sun_path(_x, _op.y, _op.a);
+      if (!chrome)
+        draw_sun_arc(_x, _op.y, _op.a);
+      break;
+    case WIDGET_BATTERY:
+      setFont(*layoutFonts[_op.font]);
+      draw_battery(_x, _op.y);
+      break;
+    case WIDGET_RSSI:
+      draw_RSSI(_x, _op.y, wifi_signal);
+      break;
+    case WIDGET_LINE:
+      if (_draw)
+        drawLine(_x, _op.y, _op.a, _op.b, Black);
+      break;
+    }
+  }
+}
+
+// The field printed by the format, the layout compiler has checked that they fit
+void field_text(const layout_op_t &op, const char *format, char *text, size_t size)
+{
+  const fact_weather_t &_fact = weather.fact;
+  const forecast_part_t *_part = (op.part >= 0) ? &weather.forecast.parts[op.part] : NULL;
+  switch (op.field)
+  {
+  case FIELD_CITY:
+    snprintf(text, size, format, param.city.c_str());
+    break;
+  case FIELD_TIME:
+    snprintf(text, size, format, convert_unix_time(weather.now).c_str());
+    break;
+  case FIELD_SEASON:
+    snprintf(text, size, format, label_or_token(season_label(_fact.season), _fact.season_token));
+    break;
+  case FIELD_TEMP:
+    snprintf(text, size, format, _part ? _part->temp_avg : _fact.temp);
+    break;
+  case FIELD_FEELS_LIKE:
+    snprintf(text, size, format, _part ? _part->feels_like : _fact.feels_like);
+    break;
+  case FIELD_HUMIDITY:
+    snprintf(text, size, format, _part ? _part->humidity : _fact.humidity);
+    break;
+  case FIELD_PRESSURE:
+    snprintf(text, size, format, _part ? _part->pressure_mm : _fact.pressure_mm);
+    break;
+  case FIELD_CONDITION:
+    if (_part)
+      snprintf(text, size, format, label_or_token(condition_label(_part->condition), _part->condition_token));
+    else
+      snprintf(text, size, format, label_or_token(condition_label(_fact.condition), _fact.condition_token));
+    break;
+  case FIELD_WIND_DIR:
+    snprintf(text, size, format, wind_dir_label(_part ? _part->wind_dir : _fact.wind_dir));
+    break;
+  case FIELD_WIND_SPEED:
+    snprintf(text, size, format, _part ? _part->wind_speed : _fact.wind_speed);
+    break;
+  case FIELD_WIND_GUST:
+    snprintf(text, size, format, _part ? _part->wind_gust : _fact.wind_gust);
+    break;
+  case FIELD_SUNRISE:
+    snprintf(text, size, format, weather.forecast.sunrise);
+    break;
+  case FIELD_SUNSET:
+    snprintf(text, size, format, weather.forecast.sunset);
+    break;
+  case FIELD_PART_NAME:
+    snprintf(text, size, format, label_or_token(part_name_label(_part->part_name), _part->part_name_token));
+    break;
+  case FIELD_PREC_MM:
+    snprintf(text, size, format, _part->prec_mm);
+    break;
+  case FIELD_PREC_PROB:
+    snprintf(text, size, format, _part->prec_prob);
+    break;
+  default:
+    text[0] = 0;
+  }
+}
+
+uint8_t battery_percentage(float voltage)
+{
+  if (voltage >= 4.20)
+    return 100;
+  if (voltage <= 3.20)
+    return 0; // orig 3.5
+  return 2836.9625 * pow(voltage, 4) - 43987.4889 * pow(voltage, 3) + 255233.8134 * pow(voltage, 2) - 656689.7123 * voltage + 632041.7303;
+}
+
+void draw_battery(int x, int y)
+{
+  if (battery_voltage > 1)
+  { // Only display if there is a valid reading
+    uint8_t _percentage = battery_percentage(battery_voltage);
+    drawRect(x + 25, y - 14, 40, 15, Black);
+    fillRect(x + 65, y - 10, 4, 7, Black);
+    fillRect(x + 27, y - 12, 36 * _percentage / 100.0, 11, Black);
+    drawString(x + 85, y - 14, String(_percentage) + "%  " + String(battery_voltage, 1) + "v", LEFT);
+  }
+}
+
+void draw_RSSI(int x, int y, int rssi)
+{
+  int WIFIsignal = 0;
+  int xpos = 1;
+  for (int _rssi = -100; _rssi <= rssi; _rssi = _rssi + 20)
+  {
+    if (_rssi <= -20)
+      WIFIsignal = 20; //            <-20dbm displays 5-bars
+    if (_rssi <= -40)
+      WIFIsignal = 16; //  -40dbm to  -21dbm displays 4-bars
+    if (_rssi <= -60)
+      WIFIsignal = 12; //  -60dbm to  -41dbm displays 3-bars
+    if (_rssi <= -80)
+      WIFIsignal = 8; //  -80dbm to  -61dbm displays 2-bars
+    if (_rssi <= -100)
+      WIFIsignal = 4; // -100dbm to  -81dbm displays 1-bar
+    fillRect(x + xpos * 8, y - WIFIsignal, 6, WIFIsignal, Black);
+    xpos++;
+  }
+}
+
+void draw_sun_path(int x, int y, int r)
+{
+  drawArc(x, y, r, SUN_ARC_START, SUN_ARC_END, 1, Black, true);
+}
+
+// Over draw_sun_path()
+void draw_sun_arc(int x, int y, int r)
+{
+  int16_t _progress = sun_progress();
+  if (_progress >= 0)
+  {
+    // The part of the day that is over is thicker, the sun sits at its end
+    int16_t _angle = SUN_ARC_START + (int32_t)(SUN_ARC_END - SUN_ARC_START) * _progress / 1000;
+    drawArc(x, y, r - 1, SUN_ARC_START, _angle, 3, Black, true);
+    int32_t _a = trig_angle(_angle);
+    fillCircle(x + trig_scale(r, trig_cos(_a)), y + trig_scale(r, trig_sin(_a)), 8, Black);
+  }
+}
+
+// How much of the day has passed at weather.now, 0..1000, -1 before sunrise and after sunset
+int16_t sun_progress()
+{
+  int _riseH, _riseM, _setH, _setM;
+  if (sscanf(weather.forecast.sunrise, "%d:%d", &_riseH, &_riseM) != 2 ||
+      sscanf(weather.forecast.sunset, "%d:%d", &_setH, &_setM) != 2)
+    return -1;
+  time_t _now = weather.now;
+  struct tm *_tm = localtime(&_now);
+  int _rise = _riseH * 60 + _riseM, _set = _setH * 60 + _setM;
+  int _minute = _tm->tm_hour * 60 + _tm->tm_min;
+  if (_set <= _rise || _minute < _rise || _minute > _set)
+    return -1;
+  return (int32_t)(_minute - _rise) * 1000 / (_set - _rise);
+}
+
+int JulianDate(int d, int m, int y)
+{
+  int mm, yy, k1, k2, k3, j;
+  yy = y - (int)((12 - m) / 10);
+  mm = m + 9;
+  if (mm >= 12)
+    mm = mm - 12;
+  k1 = (int)(365.25 * (yy + 4712));
+  k2 = (int)(30.6001 * mm + 0.5);
+  k3 = (int)((int)((yy / 100) + 49) * 0.75) - 38;
+  j = k1 + k2 + d + 59 + 1;
+  if (j > 2299160)
+    j = j - k3;
+  return j;
+}
+
+uint8_t *load_file(String fileName)
+{
+  // Images come from the atlas, a separate file is the fallback for ones uploaded by hand
+  int _ext = fileName.indexOf(".bin");
+  if (_ext > 0)
+  {
+    uint8_t *_data = atlas_load(SPIFFS, fileName.substring(0, _ext).c_str());
+    if (_data != NULL)
+      return _data;
+  }
+  String _fileName = "/" + fileName;
+  uint8_t *data;
+  log_i("file name: %s", _fileName.c_str());
+  if (SPIFFS.exists(_fileName))
+  {
+    log_i("file %s is exist", _fileName.c_str());
+    File f = SPIFFS.open(_fileName, FILE_READ);
+    int size = f.size();
+    log_i("file size: %d", size);
+    data = (uint8_t *)ps_calloc(sizeof(uint8_t), size + 1);
+    f.readBytes((char *)data, size);
+    f.close();
+    data[size] = White; // The .bin images come one byte short of width * height / 2
+    return data;
+  }
+  else
+  {
+    log_i("file not found");
+    data = NULL;
+    return data;
+  }
+};
+
+// Records the image from the atlas, it is streamed into the frame by dl_draw(). Small icons are made
+// from the large ones (nameL) when the atlas has no image of their own, name.bin of w x h is the last fallback.
+bool draw_image(const char *name, int x, int y, int w, int h)
+{
+  atlas_entry_t _entry;
+  if (atlas_find(SPIFFS, name, _entry))
+  {
+    dl_atlas(_entry, x, y);
+    return true;
+  }
+  String _large = String(name) + "L";
+  if (atlas_find(SPIFFS, _large.c_str(), _entry) && _entry.width > w && _entry.height > h)
+  {
+    dl_scaled(_large.c_str(), w, h, x, y);
+    return true;
+  }
+  uint8_t *_data = load_file(String(name) + ".bin");
+  if (_data == NULL)
+    return false;
+  draw_icon(x, y, w, h, _data);
+  free(_data);
+  return true;
+}
+
+// 4bpp image, rows padded to whole bytes, white (0xF) pixels are transparent
+void draw_icon(int x, int y, int w, int h, const uint8_t *data)
+{
+  dl_bitmap(data, w, h, x, y);
+}
+
+// Renders /name.svg into /nameL.bin and /name.bin, false if there is no SVG or it can't be drawn
+bool svg_icon(const char *name)
+{
+  String _svg = "/" + String(name) + ".svg";
+  if (!SPIFFS.exists(_svg))
+    return false;
+  uint32_t _start = micros();
+  const int _sizes[2] = {L_SIZE, S_SIZE};
+  bool _res = true;
+  for (int i = 0; i < 2 && _res; i++)
+  {
+    size_t _bytes = (_sizes[i] + 1) / 2 * _sizes[i];
+    uint8_t *_data = (uint8_t *)ps_malloc(_bytes);
+    _res = _data != NULL && svg_render(SPIFFS, _svg.c_str(), _sizes[i], _sizes[i], _data);
+    if (_res)
+    {
+      File f = SPIFFS.open("/" + String(name) + ((i == 0) ? "L" : "") + ".bin", FILE_WRITE);
+      _res = f && f.write(_data, _bytes) == _bytes;
+      f.close();
+    }
+    free(_data);
+  }
+  log_i("%s %s in %u us", _svg.c_str(), _res ? "rendered" : "failed", micros() - _start);
+  (void)_start; // Only logged
+  return _res;
+}
+
+// Both sizes can be drawn from the atlas or from .bin files, a small icon can also be scaled from a large one
+bool icon_ready(const char *name)
+{
+  atlas_entry_t _entry;
+  String _large = String(name) + "L";
+  if (atlas_find(SPIFFS, _large.c_str(), _entry))
+    return true;
+  return SPIFFS.exists("/" + _large + ".bin") && (atlas_find(SPIFFS, name, _entry) || SPIFFS.exists("/" + String(name) + ".bin"));
+}
+
+void prefetch_icons()
+{
+  const uint8_t _icons[] = {weather.fact.icon, weather.forecast.parts[0].icon, weather.forecast.parts[1].icon};
+  for (uint8_t i = 0; i < sizeof(_icons); i++)
+  {
+    const char *_name = icon_name(_icons[i]);
+    if (_icons[i] == ICON_NONE || icon_ready(_name))
+      continue;
+    // A new Yandex icon: its SVG is downloaded once and rendered into the .bin icons of both sizes
+    if (!svg_icon(_name) && !(getIcon(_name) && svg_icon(_name)))
+      log_i("icon %s is new and not available", _name);
+  }
+}
+
+void draw_condition_icon(int x, int y, uint8_t icon, bool IconSize)
+{
+  const char *IconName = icon_name(icon);
+  String fileName = IconName;
+  fileName += (IconSize == LargeIcon) ? ("L") : ("");
+  log_i("icon name: %s | image: %s", IconName, fileName.c_str());
+  int _size = (IconSize == LargeIcon) ? (L_SIZE) : (S_SIZE);
+  bool _drawn = draw_image(fileName.c_str(), x, y, _size, _size);
+  // prefetch_icons() has made the .bin icons of a new Yandex icon, an SVG uploaded by hand is rendered here
+  if (!_drawn && icon != ICON_NONE && svg_icon(IconName))
+    _drawn = draw_image(fileName.c_str(), x, y, _size, _size);
+  if (!_drawn)
+  {
+    if (IconSize == LargeIcon)
+      setFont(osans18b);
+    else
+      setFont(osans10b);
+    drawString(x, y, IconName, LEFT);
+  }
+}
+
+void arrow(int x, int y, int asize, int16_t aangle, int pwidth, int plength)
+{
+  int32_t _arr = trig_angle(aangle + 180); // The arrow is on the side the wind blows to
+  // Centre of the arrow base, Q15
+  int32_t _dx = (int32_t)x * TRIG_ONE + (asize - 10) * trig_sin(_arr);
+  int32_t _dy = (int32_t)y * TRIG_ONE - (asize - 10) * trig_cos(_arr);
+  // The tip points away from the compass centre
+  int32_t _angle = _arr - TRIG_TURN / 2;
+  int32_t xx1, yy1, xx2, yy2, xx3, yy3;
+  trig_rotate(0, plength, _angle, xx1, yy1);
+  trig_rotate(pwidth / 2, pwidth / 2, _angle, xx2, yy2);
+  trig_rotate(-pwidth / 2, pwidth / 2, _angle, xx3, yy3);
+  fillTriangle((_dx + xx1) >> 15, (_dy + yy1) >> 15, (_dx + xx3) >> 15, (_dy + yy3) >> 15, (_dx + xx2) >> 15,
+               (_dy + yy2) >> 15, Black);
+}
+
+void draw_compass_rose(int x, int y, int Cradius)
+{
+  const text_run_t *_points = compass_points();
+  int dxo, dyo, dxi, dyi;
+  drawArc(x, y, Cradius, 0, 360, 3, Black, false);       // Draw compass circle
+  drawArc(x, y, Cradius * 0.7, 0, 360, 1, Black, false); // Draw compass inner circle
+  for (uint8_t i = 0; i < 16; i++)
+  {
+    int32_t _a = i * TRIG_TURN / 16; // 0 is north
+    dxo = trig_scale(Cradius, trig_sin(_a));
+    dyo = -trig_scale(Cradius, trig_cos(_a));
+    if (i == 2)
+      drawRun(dxo + x + 15, dyo + y - 18, _points[POINT_NE], CENTER);
+    if (i == 6)
+      drawRun(dxo + x + 20, dyo + y - 2, _points[POINT_SE], CENTER);
+    if (i == 10)
+      drawRun(dxo + x - 20, dyo + y - 2, _points[POINT_SW], CENTER);
+    if (i == 14)
+      drawRun(dxo + x - 15, dyo + y - 18, _points[POINT_NW], CENTER);
+    dxi = dxo * 9 / 10;
+    dyi = dyo * 9 / 10;
+    drawLine(dxo + x, dyo + y, dxi + x, dyi + y, Black);
+    dxo = dxo * 7 / 10;
+    dyo = dyo * 7 / 10;
+    dxi = dxo * 9 / 10;
+    dyi = dyo * 9 / 10;
+    drawLine(dxo + x, dyo + y, dxi + x, dyi + y, Black);
+  }
+  drawRun(x, y - Cradius - 20, _points[POINT_N], CENTER);
+  drawRun(x, y + Cradius + 10, _points[POINT_S], CENTER);
+  drawRun(x - Cradius - 15, y - 5, _points[POINT_W], CENTER);
+  drawRun(x + Cradius + 10, y - 5, _points[POINT_E], CENTER);
+}
+
+// The arrow and the numbers, over draw_compass_rose()
+void draw_wind_section(int x, int y, wind_dir_t dir, float speed, float gust, int Cradius, bool fact)
+{
+  int16_t angle = wind_dir_angle(dir);
+  if (fact)
+  {
+    if (angle >= 0)
+      arrow(x, y, Cradius - 22, angle, 16, 33);
+  }
+  else
+  {
+    if (angle >= 0)
+      arrow(x, y, Cradius - 10, angle, 8, 20);
+  }
+  char _text[16];
+  text_run_t _run;
+  if (fact)
+  {
+    text_shape(_run, &osans12b, wind_dir_label(dir));
+    drawRun(x, y - 55, _run, CENTER);
+    snprintf(_text, sizeof(_text), "%.1f", speed);
+    text_shape(_run, &osans24b, _text);
+    drawRun(x, y - 33, _run, CENTER);
+    snprintf(_text, sizeof(_text), "%.1f", gust);
+    text_shape(_run, &osans12b, _text);
+    drawRun(x, y + 14, _run, CENTER);
+    text_shape(_run, &osans12b, "м/с");
+    drawRun(x, y + 40, _run, CENTER);
+  }
+  else
+  {
+    text_shape(_run, &osans8b, wind_dir_label(dir));
+    drawRun(x, y - 35, _run, CENTER);
+    snprintf(_text, sizeof(_text), "%.1f", speed);
+    text_shape(_run, &osans12b, _text);
+    drawRun(x, y - 17, _run, CENTER);
+    snprintf(_text, sizeof(_text), "%.1f", gust);
+    text_shape(_run, &osans8b, _text);
+    drawRun(x, y + 5, _run, CENTER);
+    text_shape(_run, &osans8b, "м/с");
+    drawRun(x, y + 20, _run, CENTER);
+  }
+}
+
+// The labels are the same on every compass, they are shaped once
+const text_run_t *compass_points()
+{
+  static text_run_t _points[POINT_COUNT];
+  if (_points[0].font == NULL)
+  {
+    const String *_labels[POINT_COUNT] = {&TXT_N, &TXT_NE, &TXT_E, &TXT_SE, &TXT_S, &TXT_SW, &TXT_W, &TXT_NW};
+    for (uint8_t i = 0; i < POINT_COUNT; i++)
+      text_shape(_points[i], &osans8b, _labels[i]->c_str());
+  }
+  return _points;
+}
+
+int drawString(int x, int y, const char *text, alignment align)
+{
+  text_run_t _run;
+  text_shape(_run, &currentFont, text);
+  return drawRun(x, y, _run, align);
+}
+
+int drawString(int x, int y, const String &text, alignment align)
+{
+  return drawString(x, y, text.c_str(), align);
+}
+
+// x,y is the top of the text box, like drawString() always did
+int drawRun(int x, int y, const text_run_t &run, alignment align)
+{
+  if (align == RIGHT)
+    x = x - run.w;
+  if (align == CENTER)
+    x = x - run.w / 2;
+  dl_text(run, x, y + run.h);
+  return run.w;
+}
+
+void fillCircle(int x, int y, int r, uint8_t color)
+{
+  dl_circle(x, y, r, color, true);
+}
+
+void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color)
+{
+  dl_line(x0, y0, x1, y1, color);
+}
+
+void drawCircle(int x0, int y0, int r, uint8_t color, bool fill)
+{
+  dl_circle(x0, y0, r, color, fill);
+}
+
+void drawArc(int x, int y, int r, int16_t start, int16_t end, uint8_t thickness, uint8_t color, bool aa)
+{
+  dl_arc(x, y, r, start, end, thickness, color, aa);
+}
+
+void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+  dl_rect(x, y, w, h, color, false);
+}
+
+void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+  dl_rect(x, y, w, h, color, true);
+}
+
+void fillTriangle(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                  int16_t x2, int16_t y2, uint16_t color)
+{
+  dl_triangle(x0, y0, x1, y1, x2, y2, color);
+}
+
+void drawPixel(int x, int y, uint8_t color)
+{
+  dl_pixel(x, y, color);
+}
+
+void setFont(GFXfont const &font)
+{
+  currentFont = font;
+}
+
+void edp_update()
+{
+  dl_draw(SPIFFS, displayBuffer);
+  epd_draw_grayscale_image(epd_full_screen(), displayBuffer); // Update the screen
+}
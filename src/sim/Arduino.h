@@ -0,0 +1,148 @@
+#ifndef SIM_ARDUINO_H_
+#define SIM_ARDUINO_H_
+
+// The part of the Arduino core the rendering code uses, for the host simulator
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <string>
+
+using std::max;
+using std::min;
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#ifndef PI
+#define PI 3.1415926535897932384626433832795
+#endif
+
+#define RTC_DATA_ATTR
+#define F(string_literal) (string_literal)
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+#if CORE_DEBUG_LEVEL >= 3
+#define log_i(format, ...) fprintf(stderr, "[I] " format "\n", ##__VA_ARGS__)
+#else
+#define log_i(format, ...) \
+    do                     \
+    {                      \
+    } while (0)
+#endif
+
+inline void *ps_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+inline void *ps_calloc(size_t n, size_t size)
+{
+    return calloc(n, size);
+}
+
+inline void *ps_realloc(void *ptr, size_t size)
+{
+    return realloc(ptr, size);
+}
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+
+inline size_t sim_strlcpy(char *dst, const char *src, size_t size)
+{
+    size_t len = strlen(src);
+    if (size > 0)
+    {
+        size_t n = (len < size - 1) ? len : size - 1;
+        memcpy(dst, src, n);
+        dst[n] = 0;
+    }
+    return len;
+}
+#define strlcpy sim_strlcpy
+
+class String
+{
+public:
+    String(const char *str = "") : s(str ? str : "") {}
+    String(const std::string &str) : s(str) {}
+    explicit String(char c) : s(1, c) {}
+    explicit String(unsigned char value, unsigned char base = 10) : s(number(value, base)) {}
+    explicit String(int value, unsigned char base = 10) : s(number(value, base)) {}
+    explicit String(unsigned int value, unsigned char base = 10) : s(number(value, base)) {}
+    explicit String(long value, unsigned char base = 10) : s(number(value, base)) {}
+    explicit String(unsigned long value, unsigned char base = 10) : s(number(value, base)) {}
+    explicit String(float value, unsigned char decimals = 2) : s(fixed(value, decimals)) {}
+    explicit String(double value, unsigned char decimals = 2) : s(fixed(value, decimals)) {}
+
+    const char *c_str() const { return s.c_str(); }
+    unsigned int length() const { return s.length(); }
+    int indexOf(char c) const { return pos(s.find(c)); }
+    int indexOf(const char *str) const { return pos(s.find(str)); }
+    String substring(unsigned int from) const { return substring(from, s.length()); }
+    String substring(unsigned int from, unsigned int to) const
+    {
+        if (from > to)
+            std::swap(from, to);
+        from = min(from, (unsigned int)s.length());
+        to = min(to, (unsigned int)s.length());
+        return String(s.substr(from, to - from));
+    }
+
+    String &operator+=(const String &str)
+    {
+        s += str.s;
+        return *this;
+    }
+    String &operator+=(const char *str)
+    {
+        s += str;
+        return *this;
+    }
+    String &operator+=(char c)
+    {
+        s += c;
+        return *this;
+    }
+    bool operator==(const String &str) const { return s == str.s; }
+    bool operator==(const char *str) const { return s == str; }
+    bool operator!=(const String &str) const { return s != str.s; }
+    bool operator!=(const char *str) const { return s != str; }
+
+    friend String operator+(const String &a, const String &b) { return String(a.s + b.s); }
+    friend String operator+(const String &a, const char *b) { return String(a.s + b); }
+    friend String operator+(const char *a, const String &b) { return String(a + b.s); }
+
+private:
+    std::string s;
+
+    static int pos(size_t p) { return (p == std::string::npos) ? -1 : (int)p; }
+    static std::string fixed(double value, unsigned char decimals)
+    {
+        char buf[48];
+        snprintf(buf, sizeof(buf), "%.*f", decimals, value);
+        return buf;
+    }
+    template <typename T>
+    static std::string number(T value, unsigned char base)
+    {
+        bool negative = value < 0;
+        unsigned long long v = negative ? 0ULL - (unsigned long long)value : (unsigned long long)value;
+        std::string out;
+        do
+        {
+            out.insert(out.begin(), "0123456789abcdefghijklmnopqrstuvwxyz"[v % base]);
+            v /= base;
+        } while (v);
+        if (negative)
+            out.insert(out.begin(), '-');
+        return out;
+    }
+};
+
+#endif /* SIM_ARDUINO_H_ */
@@ -0,0 +1,55 @@
+#ifndef SIM_FS_H_
+#define SIM_FS_H_
+
+// fs::FS on top of a host directory, for the host simulator
+
+#include <Arduino.h>
+#include <memory>
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+
+namespace fs
+{
+    class File
+    {
+    public:
+        File() {}
+        File(FILE *file)
+        {
+            if (file)
+                f.reset(file, fclose);
+        }
+
+        operator bool() const { return f != nullptr; }
+        size_t size() const;
+        int available() const;
+        size_t read(uint8_t *buf, size_t size) { return f ? fread(buf, 1, size, f.get()) : 0; }
+        size_t readBytes(char *buf, size_t length) { return read((uint8_t *)buf, length); }
+        bool seek(uint32_t pos) { return f && fseek(f.get(), pos, SEEK_SET) == 0; }
+        size_t write(const uint8_t *buf, size_t size) { return f ? fwrite(buf, 1, size, f.get()) : 0; }
+        void close() { f.reset(); }
+
+    private:
+        std::shared_ptr<FILE> f;
+    };
+
+    class FS
+    {
+    public:
+        // SPIFFS paths ("/blob.bin") are looked up under root
+        bool begin(const char *root);
+        File open(const char *path, const char *mode = FILE_READ);
+        File open(const String &path, const char *mode = FILE_READ) { return open(path.c_str(), mode); }
+        bool exists(const char *path);
+        bool exists(const String &path) { return exists(path.c_str()); }
+        bool remove(const char *path);
+
+    private:
+        std::string root;
+    };
+}
+
+using fs::File;
+
+#endif /* SIM_FS_H_ */
@@ -0,0 +1,8 @@
+#ifndef SIM_SPIFFS_H_
+#define SIM_SPIFFS_H_
+
+#include "FS.h"
+
+extern fs::FS SPIFFS;
+
+#endif /* SIM_SPIFFS_H_ */
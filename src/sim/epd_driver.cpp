@@ -0,0 +1,477 @@
+#include "epd_driver.h"
+#include "sim.h"
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <zlib.h>
+
+using std::max;
+using std::min;
+using std::swap;
+
+#define FRAME_SIZE (EPD_WIDTH * EPD_HEIGHT / 2)
+
+sim_stats_t simStats;
+static uint8_t panel[FRAME_SIZE];
+static bool panelReady = false;
+
+static void get_glyph(const GFXfont *font, uint32_t code_point, const GFXglyph **glyph);
+static uint32_t next_cp(const uint8_t **string);
+static void draw_char(const GFXfont *font, uint8_t *buffer, int *cursor_x, int cursor_y, uint32_t cp);
+static void fill_circle_helper(int x0, int y0, int r, int corners, int delta, uint8_t color, uint8_t *framebuffer);
+
+const uint8_t *sim_panel()
+{
+    if (!panelReady)
+        epd_clear();
+    return panel;
+}
+
+void epd_init()
+{
+}
+
+void epd_poweron()
+{
+}
+
+void epd_poweroff()
+{
+}
+
+void epd_poweroff_all()
+{
+}
+
+void epd_clear()
+{
+    memset(panel, 0xFF, FRAME_SIZE);
+    panelReady = true;
+    simStats.full++;
+}
+
+void epd_clear_area(Rect_t area)
+{
+    sim_panel();
+    for (int y = max(area.y, 0); y < min(area.y + area.height, EPD_HEIGHT); y++)
+    {
+        for (int x = max(area.x, 0); x < min(area.x + area.width, EPD_WIDTH); x++)
+            epd_draw_pixel(x, y, 0xF0, panel);
+    }
+    simStats.areas++;
+}
+
+Rect_t epd_full_screen()
+{
+    Rect_t area = {.x = 0, .y = 0, .width = EPD_WIDTH, .height = EPD_HEIGHT};
+    return area;
+}
+
+// The waveform only darkens, so the panel keeps the darker of both pixels
+void epd_draw_grayscale_image(Rect_t area, uint8_t *data)
+{
+    sim_panel();
+    int rowBytes = (area.width + 1) / 2;
+    for (int y = 0; y < area.height; y++)
+    {
+        for (int x = 0; x < area.width; x++)
+        {
+            int px = area.x + x, py = area.y + y;
+            if (px < 0 || px >= EPD_WIDTH || py < 0 || py >= EPD_HEIGHT)
+                continue;
+            uint8_t pixel = data[y * rowBytes + x / 2];
+            pixel = (x & 1) ? (pixel >> 4) : (pixel & 0x0F);
+            uint8_t old = panel[py * EPD_WIDTH / 2 + px / 2];
+            old = (px & 1) ? (old >> 4) : (old & 0x0F);
+            epd_draw_pixel(px, py, min(pixel, old) << 4, panel);
+        }
+    }
+    simStats.pushes++;
+    simStats.pixels += (uint64_t)area.width * area.height;
+}
+
+void epd_copy_to_framebuffer(Rect_t image_area, uint8_t *image_data, uint8_t *framebuffer)
+{
+    int rowBytes = (image_area.width + 1) / 2;
+    for (int y = 0; y < image_area.height; y++)
+    {
+        for (int x = 0; x < image_area.width; x++)
+        {
+            uint8_t pixel = image_data[y * rowBytes + x / 2];
+            pixel = (x & 1) ? (pixel >> 4) : (pixel & 0x0F);
+            epd_draw_pixel(image_area.x + x, image_area.y + y, pixel << 4, framebuffer);
+        }
+    }
+}
+
+void epd_draw_pixel(int x, int y, uint8_t color, uint8_t *framebuffer)
+{
+    if (x < 0 || x >= EPD_WIDTH || y < 0 || y >= EPD_HEIGHT)
+        return;
+    uint8_t *buf_ptr = &framebuffer[y * EPD_WIDTH / 2 + x / 2];
+    if (x % 2)
+        *buf_ptr = (*buf_ptr & 0x0F) | (color & 0xF0);
+    else
+        *buf_ptr = (*buf_ptr & 0xF0) | (color >> 4);
+}
+
+void epd_draw_hline(int x, int y, int length, uint8_t color, uint8_t *framebuffer)
+{
+    for (int i = 0; i < length; i++)
+        epd_draw_pixel(x + i, y, color, framebuffer);
+}
+
+void epd_draw_vline(int x, int y, int length, uint8_t color, uint8_t *framebuffer)
+{
+    for (int i = 0; i < length; i++)
+        epd_draw_pixel(x, y + i, color, framebuffer);
+}
+
+void epd_draw_circle(int x0, int y0, int r, uint8_t color, uint8_t *framebuffer)
+{
+    int f = 1 - r;
+    int ddF_x = 1;
+    int ddF_y = -2 * r;
+    int x = 0;
+    int y = r;
+
+    epd_draw_pixel(x0, y0 + r, color, framebuffer);
+    epd_draw_pixel(x0, y0 - r, color, framebuffer);
+    epd_draw_pixel(x0 + r, y0, color, framebuffer);
+    epd_draw_pixel(x0 - r, y0, color, framebuffer);
+    while (x < y)
+    {
+        if (f >= 0)
+        {
+            y--;
+            ddF_y += 2;
+            f += ddF_y;
+        }
+        x++;
+        ddF_x += 2;
+        f += ddF_x;
+        epd_draw_pixel(x0 + x, y0 + y, color, framebuffer);
+        epd_draw_pixel(x0 - x, y0 + y, color, framebuffer);
+        epd_draw_pixel(x0 + x, y0 - y, color, framebuffer);
+        epd_draw_pixel(x0 - x, y0 - y, color, framebuffer);
+        epd_draw_pixel(x0 + y, y0 + x, color, framebuffer);
+        epd_draw_pixel(x0 - y, y0 + x, color, framebuffer);
+        epd_draw_pixel(x0 + y, y0 - x, color, framebuffer);
+        epd_draw_pixel(x0 - y, y0 - x, color, framebuffer);
+    }
+}
+
+void epd_fill_circle(int x, int y, int r, uint8_t color, uint8_t *framebuffer)
+{
+    epd_draw_vline(x, y - r, 2 * r + 1, color, framebuffer);
+    fill_circle_helper(x, y, r, 3, 0, color, framebuffer);
+}
+
+static void fill_circle_helper(int x0, int y0, int r, int corners, int delta, uint8_t color, uint8_t *framebuffer)
+{
+    int f = 1 - r;
+    int ddF_x = 1;
+    int ddF_y = -2 * r;
+    int x = 0;
+    int y = r;
+    int px = x;
+    int py = y;
+
+    delta++; // Avoid some +1's in the loop
+    while (x < y)
+    {
+        if (f >= 0)
+        {
+            y--;
+            ddF_y += 2;
+            f += ddF_y;
+        }
+        x++;
+        ddF_x += 2;
+        f += ddF_x;
+        // These checks avoid double-drawing certain lines
+        if (x < (y + 1))
+        {
+            if (corners & 1)
+                epd_draw_vline(x0 + x, y0 - y, 2 * y + delta, color, framebuffer);
+            if (corners & 2)
+                epd_draw_vline(x0 - x, y0 - y, 2 * y + delta, color, framebuffer);
+        }
+        if (y != py)
+        {
+            if (corners & 1)
+                epd_draw_vline(x0 + py, y0 - px, 2 * px + delta, color, framebuffer);
+            if (corners & 2)
+                epd_draw_vline(x0 - py, y0 - px, 2 * px + delta, color, framebuffer);
+            py = y;
+        }
+        px = x;
+    }
+}
+
+void epd_draw_rect(int x, int y, int width, int height, uint8_t color, uint8_t *framebuffer)
+{
+    epd_draw_hline(x, y, width, color, framebuffer);
+    epd_draw_hline(x, y + height - 1, width, color, framebuffer);
+    epd_draw_vline(x, y, height, color, framebuffer);
+    epd_draw_vline(x + width - 1, y, height, color, framebuffer);
+}
+
+void epd_fill_rect(int x, int y, int width, int height, uint8_t color, uint8_t *framebuffer)
+{
+    for (int i = y; i < y + height; i++)
+        epd_draw_hline(x, i, width, color, framebuffer);
+}
+
+void epd_write_line(int x0, int y0, int x1, int y1, uint8_t color, uint8_t *framebuffer)
+{
+    int steep = abs(y1 - y0) > abs(x1 - x0);
+    if (steep)
+    {
+        swap(x0, y0);
+        swap(x1, y1);
+    }
+    if (x0 > x1)
+    {
+        swap(x0, x1);
+        swap(y0, y1);
+    }
+    int dx = x1 - x0;
+    int dy = abs(y1 - y0);
+    int err = dx / 2;
+    int ystep = (y0 < y1) ? 1 : -1;
+    for (; x0 <= x1; x0++)
+    {
+        if (steep)
+            epd_draw_pixel(y0, x0, color, framebuffer);
+        else
+            epd_draw_pixel(x0, y0, color, framebuffer);
+        err -= dy;
+        if (err < 0)
+        {
+            y0 += ystep;
+            err += dx;
+        }
+    }
+}
+
+void epd_draw_line(int x0, int y0, int x1, int y1, uint8_t color, uint8_t *framebuffer)
+{
+    if (x0 == x1)
+        epd_draw_vline(x0, min(y0, y1), abs(y1 - y0) + 1, color, framebuffer);
+    else if (y0 == y1)
+        epd_draw_hline(min(x0, x1), y0, abs(x1 - x0) + 1, color, framebuffer);
+    else
+        epd_write_line(x0, y0, x1, y1, color, framebuffer);
+}
+
+void epd_draw_triangle(int x0, int y0, int x1, int y1, int x2, int y2, uint8_t color, uint8_t *framebuffer)
+{
+    epd_draw_line(x0, y0, x1, y1, color, framebuffer);
+    epd_draw_line(x1, y1, x2, y2, color, framebuffer);
+    epd_draw_line(x2, y2, x0, y0, color, framebuffer);
+}
+
+void epd_fill_triangle(int x0, int y0, int x1, int y1, int x2, int y2, uint8_t color, uint8_t *framebuffer)
+{
+    int a, b, y, last;
+
+    // Sort coordinates by Y order (y2 >= y1 >= y0)
+    if (y0 > y1)
+    {
+        swap(y0, y1);
+        swap(x0, x1);
+    }
+    if (y1 > y2)
+    {
+        swap(y2, y1);
+        swap(x2, x1);
+    }
+    if (y0 > y1)
+    {
+        swap(y0, y1);
+        swap(x0, x1);
+    }
+
+    if (y0 == y2)
+    { // All on the same line
+        a = b = x0;
+        a = min(a, min(x1, x2));
+        b = max(b, max(x1, x2));
+        epd_draw_hline(a, y0, b - a + 1, color, framebuffer);
+        return;
+    }
+
+    int dx01 = x1 - x0, dy01 = y1 - y0, dx02 = x2 - x0, dy02 = y2 - y0, dx12 = x2 - x1, dy12 = y2 - y1;
+    int32_t sa = 0, sb = 0;
+
+    // Upper part: scanline y1 is included here if the lower part is flat
+    last = (y1 == y2) ? y1 : y1 - 1;
+    for (y = y0; y <= last; y++)
+    {
+        a = x0 + sa / dy01;
+        b = x0 + sb / dy02;
+        sa += dx01;
+        sb += dx02;
+        if (a > b)
+            swap(a, b);
+        epd_draw_hline(a, y, b - a + 1, color, framebuffer);
+    }
+
+    // Lower part
+    sa = (int32_t)dx12 * (y - y1);
+    sb = (int32_t)dx02 * (y - y0);
+    for (; y <= y2; y++)
+    {
+        a = x1 + sa / dy12;
+        b = x0 + sb / dy02;
+        sa += dx12;
+        sb += dx02;
+        if (a > b)
+            swap(a, b);
+        epd_draw_hline(a, y, b - a + 1, color, framebuffer);
+    }
+}
+
+void get_text_bounds(const GFXfont *font, const char *string, int *x, int *y, int *x1, int *y1, int *w, int *h,
+                     const FontProperties *props)
+{
+    if (*string == '\0')
+    {
+        *w = 0;
+        *h = 0;
+        *y1 = *y;
+        *x1 = *x;
+        return;
+    }
+    int minx = 100000, miny = 100000, maxx = -1, maxy = -1;
+    int original_x = *x;
+    const uint8_t *str = (const uint8_t *)string;
+    uint32_t c;
+    while ((c = next_cp(&str)))
+    {
+        const GFXglyph *glyph;
+        get_glyph(font, c, &glyph);
+        if (!glyph && props)
+            get_glyph(font, props->fallback_glyph, &glyph);
+        if (!glyph)
+            continue;
+        int gx1 = *x + glyph->left;
+        int gy1 = *y + (glyph->top - glyph->height);
+        int gx2 = gx1 + glyph->width;
+        int gy2 = gy1 + glyph->height;
+        minx = min(minx, gx1);
+        miny = min(miny, gy1);
+        maxx = max(maxx, gx2);
+        maxy = max(maxy, gy2);
+        *x += glyph->advance_x;
+    }
+    *x1 = min(original_x, minx);
+    *w = maxx - *x1;
+    *y1 = miny;
+    *h = maxy - miny;
+}
+
+void write_string(const GFXfont *font, const char *string, int *cursor_x, int *cursor_y, uint8_t *framebuffer)
+{
+    char *copy = strdup(string);
+    char *rest = copy;
+    char *token;
+    int line_start = *cursor_x;
+    while ((token = strsep(&rest, "\n")) != NULL)
+    {
+        *cursor_x = line_start;
+        writeln(font, token, cursor_x, cursor_y, framebuffer);
+        *cursor_y += font->advance_y;
+    }
+    free(copy);
+}
+
+void writeln(const GFXfont *font, const char *string, int *cursor_x, int *cursor_y, uint8_t *framebuffer)
+{
+    const uint8_t *str = (const uint8_t *)string;
+    uint32_t c;
+    while ((c = next_cp(&str)))
+        draw_char(font, framebuffer, cursor_x, *cursor_y, c);
+}
+
+static void get_glyph(const GFXfont *font, uint32_t code_point, const GFXglyph **glyph)
+{
+    *glyph = NULL;
+    for (uint32_t i = 0; i < font->interval_count; i++)
+    {
+        const UnicodeInterval *interval = &font->intervals[i];
+        if (code_point >= interval->first && code_point <= interval->last)
+        {
+            *glyph = &font->glyph[interval->offset + (code_point - interval->first)];
+            return;
+        }
+        if (code_point < interval->first)
+            return;
+    }
+}
+
+static uint32_t next_cp(const uint8_t **string)
+{
+    if (**string == 0)
+        return 0;
+    if (**string <= 0x7F)
+        return *((*string)++);
+    uint32_t cp;
+    int bytes;
+    if ((**string & 0xE0) == 0xC0)
+    {
+        cp = **string & 0x1F;
+        bytes = 1;
+    }
+    else if ((**string & 0xF0) == 0xE0)
+    {
+        cp = **string & 0x0F;
+        bytes = 2;
+    }
+    else
+    {
+        cp = **string & 0x07;
+        bytes = 3;
+    }
+    (*string)++;
+    for (int i = 0; i < bytes && **string; i++)
+        cp = (cp << 6) | (*((*string)++) & 0x3F);
+    return cp;
+}
+
+// Black on white: the glyph box is opaque, bitmap value v becomes 15 - v
+static void draw_char(const GFXfont *font, uint8_t *buffer, int *cursor_x, int cursor_y, uint32_t cp)
+{
+    const GFXglyph *glyph;
+    get_glyph(font, cp, &glyph);
+    if (!glyph)
+        return;
+    int width = glyph->width, height = glyph->height;
+    int byte_width = (width / 2 + width % 2);
+    unsigned long bitmap_size = byte_width * height;
+    const uint8_t *bitmap = &font->bitmap[glyph->data_offset];
+    uint8_t *inflated = NULL;
+    if (font->compressed && bitmap_size > 0)
+    {
+        inflated = (uint8_t *)malloc(bitmap_size);
+        uncompress(inflated, &bitmap_size, bitmap, glyph->compressed_size);
+        bitmap = inflated;
+        simStats.inflates++;
+    }
+    for (int y = 0; y < height; y++)
+    {
+        int yy = cursor_y - glyph->top + y;
+        if (yy < 0 || yy >= EPD_HEIGHT)
+            continue;
+        int start_pos = *cursor_x + glyph->left;
+        for (int x = max(0, -start_pos); x < width && start_pos + x < EPD_WIDTH; x++)
+        {
+            uint8_t bm = bitmap[y * byte_width + x / 2];
+            bm = (x & 1) ? (bm >> 4) : (bm & 0x0F);
+            epd_draw_pixel(start_pos + x, yy, (15 - bm) << 4, buffer);
+        }
+    }
+    free(inflated);
+    *cursor_x += glyph->advance_x;
+}
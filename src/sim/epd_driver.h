@@ -0,0 +1,85 @@
+#ifndef SIM_EPD_DRIVER_H_
+#define SIM_EPD_DRIVER_H_
+
+// Software implementation of the LilyGo-EPD47 API used by the sketch, for the host simulator.
+// Drawing and text behave like the library; the "panel" is a second 4bpp buffer.
+
+#include <stdint.h>
+
+#define EPD_WIDTH 960
+#define EPD_HEIGHT 540
+
+typedef struct
+{
+    int x;
+    int y;
+    int width;
+    int height;
+} Rect_t;
+
+typedef struct
+{
+    uint8_t width;
+    uint8_t height;
+    uint8_t advance_x;
+    int16_t left;
+    int16_t top;
+    uint16_t compressed_size;
+    uint32_t data_offset;
+} GFXglyph;
+
+typedef struct
+{
+    uint32_t first;
+    uint32_t last;
+    uint32_t offset;
+} UnicodeInterval;
+
+typedef struct
+{
+    uint8_t *bitmap;
+    GFXglyph *glyph;
+    UnicodeInterval *intervals;
+    uint32_t interval_count;
+    bool compressed;
+    uint8_t advance_y;
+    int ascender;
+    int descender;
+} GFXfont;
+
+typedef struct
+{
+    uint8_t fg_color : 4;
+    uint8_t bg_color : 4;
+    uint32_t fallback_glyph;
+    uint32_t flags;
+} FontProperties;
+
+void epd_init();
+void epd_poweron();
+void epd_poweroff();
+void epd_poweroff_all();
+void epd_clear();
+void epd_clear_area(Rect_t area);
+Rect_t epd_full_screen();
+void epd_draw_grayscale_image(Rect_t area, uint8_t *data);
+void epd_copy_to_framebuffer(Rect_t image_area, uint8_t *image_data, uint8_t *framebuffer);
+
+void epd_draw_pixel(int x, int y, uint8_t color, uint8_t *framebuffer);
+void epd_draw_hline(int x, int y, int length, uint8_t color, uint8_t *framebuffer);
+void epd_draw_vline(int x, int y, int length, uint8_t color, uint8_t *framebuffer);
+void epd_draw_circle(int x, int y, int r, uint8_t color, uint8_t *framebuffer);
+void epd_fill_circle(int x, int y, int r, uint8_t color, uint8_t *framebuffer);
+void epd_draw_rect(int x, int y, int width, int height, uint8_t color, uint8_t *framebuffer);
+void epd_fill_rect(int x, int y, int width, int height, uint8_t color, uint8_t *framebuffer);
+void epd_write_line(int x0, int y0, int x1, int y1, uint8_t color, uint8_t *framebuffer);
+void epd_draw_line(int x0, int y0, int x1, int y1, uint8_t color, uint8_t *framebuffer);
+void epd_draw_triangle(int x0, int y0, int x1, int y1, int x2, int y2, uint8_t color, uint8_t *framebuffer);
+void epd_fill_triangle(int x0, int y0, int x1, int y1, int x2, int y2, uint8_t color, uint8_t *framebuffer);
+
+void get_text_bounds(const GFXfont *font, const char *string, int *x, int *y, int *x1, int *y1, int *w, int *h,
+                     const FontProperties *props);
+void write_string(const GFXfont *font, const char *string, int *cursor_x, int *cursor_y, uint8_t *framebuffer);
+void writeln(const GFXfont *font, const char *string, int *cursor_x, int *cursor_y, uint8_t *framebuffer);
+
+#endif /* SIM_EPD_DRIVER_H_ */
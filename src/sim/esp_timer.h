@@ -0,0 +1,10 @@
+#ifndef SIM_ESP_TIMER_H_
+#define SIM_ESP_TIMER_H_
+
+// Sim stand-in for ESP-IDF's esp_timer.h, the clock of micros()
+
+#include <stdint.h>
+
+int64_t esp_timer_get_time();
+
+#endif /* SIM_ESP_TIMER_H_ */
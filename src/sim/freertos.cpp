@@ -0,0 +1,68 @@
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+struct sim_semaphore
+{
+    std::mutex mutex;
+    std::condition_variable cv;
+    UBaseType_t count;
+    UBaseType_t max;
+};
+
+BaseType_t xPortGetCoreID()
+{
+    return 0;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t code, const char *name, uint32_t stackDepth, void *parameters,
+                                   UBaseType_t priority, TaskHandle_t *handle, BaseType_t core)
+{
+    std::thread(code, parameters).detach();
+    if (handle != NULL)
+        *handle = NULL;
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+}
+
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task)
+{
+    return 1;
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t maxCount, UBaseType_t initialCount)
+{
+    sim_semaphore *s = new sim_semaphore;
+    s->count = initialCount;
+    s->max = maxCount;
+    return s;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore)
+{
+    std::lock_guard<std::mutex> lock(semaphore->mutex);
+    if (semaphore->count >= semaphore->max)
+        return pdFALSE;
+    semaphore->count++;
+    semaphore->cv.notify_one();
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks)
+{
+    std::unique_lock<std::mutex> lock(semaphore->mutex);
+    semaphore->cv.wait(lock, [semaphore] { return semaphore->count > 0; });
+    semaphore->count--;
+    return pdTRUE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore)
+{
+    delete semaphore;
+}
@@ -0,0 +1,21 @@
+#ifndef SIM_FREERTOS_H_
+#define SIM_FREERTOS_H_
+
+// The part of FreeRTOS the rendering code uses, on std::thread for the host simulator
+
+#include <stdint.h>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdPASS 1
+#define portMAX_DELAY 0xFFFFFFFF
+#define portNUM_PROCESSORS 2
+
+// Cores are not modelled, threads run wherever the host puts them
+BaseType_t xPortGetCoreID();
+
+#endif /* SIM_FREERTOS_H_ */
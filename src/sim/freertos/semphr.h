@@ -0,0 +1,14 @@
+#ifndef SIM_FREERTOS_SEMPHR_H_
+#define SIM_FREERTOS_SEMPHR_H_
+
+#include "FreeRTOS.h"
+
+typedef struct sim_semaphore *SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t maxCount, UBaseType_t initialCount);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore);
+// Only portMAX_DELAY is supported
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks);
+void vSemaphoreDelete(SemaphoreHandle_t semaphore);
+
+#endif /* SIM_FREERTOS_SEMPHR_H_ */
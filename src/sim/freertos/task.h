@@ -0,0 +1,16 @@
+#ifndef SIM_FREERTOS_TASK_H_
+#define SIM_FREERTOS_TASK_H_
+
+#include "FreeRTOS.h"
+
+typedef void (*TaskFunction_t)(void *);
+typedef struct sim_task *TaskHandle_t;
+
+// A detached thread, stack size, priority and core are ignored; handle is always NULL
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t code, const char *name, uint32_t stackDepth, void *parameters,
+                                   UBaseType_t priority, TaskHandle_t *handle, BaseType_t core);
+// Only vTaskDelete(NULL) at the end of a task function: the thread ends when the function returns
+void vTaskDelete(TaskHandle_t task);
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task);
+
+#endif /* SIM_FREERTOS_TASK_H_ */
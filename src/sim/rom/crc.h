@@ -0,0 +1,14 @@
+#ifndef SIM_ROM_CRC_H_
+#define SIM_ROM_CRC_H_
+
+// The ESP32 ROM crc32, on top of zlib: both are the reflected IEEE CRC-32
+
+#include <stdint.h>
+#include <zlib.h>
+
+static inline uint32_t crc32_le(uint32_t crc, const uint8_t *buf, uint32_t len)
+{
+    return crc32(crc, buf, len);
+}
+
+#endif /* SIM_ROM_CRC_H_ */
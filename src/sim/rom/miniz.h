@@ -0,0 +1,39 @@
+#ifndef SIM_ROM_MINIZ_H_
+#define SIM_ROM_MINIZ_H_
+
+// The tinfl calls used with the ESP32 ROM inflater, on top of zlib
+
+#include <stddef.h>
+#include <stdint.h>
+#include <zlib.h>
+
+#define TINFL_FLAG_PARSE_ZLIB_HEADER 1
+#define TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF 4
+
+typedef enum
+{
+    TINFL_STATUS_FAILED = -1,
+    TINFL_STATUS_DONE = 0
+} tinfl_status;
+
+typedef struct
+{
+    int unused;
+} tinfl_decompressor;
+
+#define tinfl_init(r) \
+    do                \
+    {                 \
+    } while (0)
+
+inline tinfl_status tinfl_decompress(tinfl_decompressor *, const uint8_t *in_buf, size_t *in_buf_size,
+                                     uint8_t *out_buf_start, uint8_t *out_buf_next, size_t *out_buf_size,
+                                     uint32_t)
+{
+    uLongf size = *out_buf_size;
+    int res = uncompress(out_buf_next, &size, in_buf, *in_buf_size);
+    *out_buf_size = size;
+    return (res == Z_OK) ? TINFL_STATUS_DONE : TINFL_STATUS_FAILED;
+}
+
+#endif /* SIM_ROM_MINIZ_H_ */
@@ -0,0 +1,26 @@
+#ifndef SIM_H_
+#define SIM_H_
+
+#include <stdint.h>
+
+typedef struct
+{
+    uint32_t full;      // epd_clear() calls
+    uint32_t areas;     // epd_clear_area() calls
+    uint32_t pushes;    // epd_draw_grayscale_image() calls
+    uint64_t pixels;    // pixels pushed to the panel
+    uint32_t inflates;  // glyph bitmaps inflated
+} sim_stats_t;
+
+extern sim_stats_t simStats;
+
+// What the panel shows, 4bpp like displayBuffer
+const uint8_t *sim_panel();
+// Writes a 4bpp frame as 8-bit grayscale, PNG or PGM by the extension of path
+bool sim_write_image(const char *path, const uint8_t *frame, int width, int height);
+// The refresh policy and the fixed schedule over a recording, base - the fixed period, s
+int schedule_replay(const char *path, uint32_t base);
+// The vocabulary tables against the String == chains they replaced, best of runs
+int vocab_bench(int runs);
+
+#endif /* SIM_H_ */
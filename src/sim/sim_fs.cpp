@@ -0,0 +1,44 @@
+#include "FS.h"
+#include "SPIFFS.h"
+#include <sys/stat.h>
+
+fs::FS SPIFFS;
+
+namespace fs
+{
+    size_t File::size() const
+    {
+        struct stat st;
+        if (!f || fstat(fileno(f.get()), &st) != 0)
+            return 0;
+        return st.st_size;
+    }
+
+    int File::available() const
+    {
+        return f ? size() - ftell(f.get()) : 0;
+    }
+
+    bool FS::begin(const char *root)
+    {
+        struct stat st;
+        this->root = root;
+        return stat(root, &st) == 0 && S_ISDIR(st.st_mode);
+    }
+
+    File FS::open(const char *path, const char *mode)
+    {
+        return File(fopen((root + path).c_str(), (mode[0] == 'w') ? "wb" : "rb"));
+    }
+
+    bool FS::exists(const char *path)
+    {
+        struct stat st;
+        return stat((root + path).c_str(), &st) == 0;
+    }
+
+    bool FS::remove(const char *path)
+    {
+        return ::remove((root + path).c_str()) == 0;
+    }
+}
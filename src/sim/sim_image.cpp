@@ -0,0 +1,74 @@
+#include "sim.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+
+static void put_be32(FILE *f, uint32_t v)
+{
+    uint8_t b[4] = {(uint8_t)(v >> 24), (uint8_t)(v >> 16), (uint8_t)(v >> 8), (uint8_t)v};
+    fwrite(b, 1, 4, f);
+}
+
+static void put_chunk(FILE *f, const char *type, const uint8_t *data, uint32_t size)
+{
+    put_be32(f, size);
+    fwrite(type, 1, 4, f);
+    fwrite(data, 1, size, f);
+    uLong crc = crc32(0, (const Bytef *)type, 4);
+    crc = crc32(crc, data, size);
+    put_be32(f, crc);
+}
+
+static bool write_png(FILE *f, const uint8_t *gray, int width, int height)
+{
+    // Every row starts with filter type 0
+    uLong rawSize = (uLong)(width + 1) * height;
+    uint8_t *raw = (uint8_t *)malloc(rawSize);
+    uLong packedSize = compressBound(rawSize);
+    uint8_t *packed = (uint8_t *)malloc(packedSize);
+    for (int y = 0; y < height; y++)
+    {
+        raw[y * (width + 1)] = 0;
+        memcpy(&raw[y * (width + 1) + 1], &gray[y * width], width);
+    }
+    bool res = (compress2(packed, &packedSize, raw, rawSize, 9) == Z_OK);
+    if (res)
+    {
+        static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+        uint8_t ihdr[13] = {(uint8_t)(width >> 24), (uint8_t)(width >> 16), (uint8_t)(width >> 8), (uint8_t)width,
+                            (uint8_t)(height >> 24), (uint8_t)(height >> 16), (uint8_t)(height >> 8), (uint8_t)height,
+                            8, 0, 0, 0, 0}; // 8 bit grayscale
+        fwrite(signature, 1, sizeof(signature), f);
+        put_chunk(f, "IHDR", ihdr, sizeof(ihdr));
+        put_chunk(f, "IDAT", packed, packedSize);
+        put_chunk(f, "IEND", NULL, 0);
+    }
+    free(raw);
+    free(packed);
+    return res;
+}
+
+bool sim_write_image(const char *path, const uint8_t *frame, int width, int height)
+{
+    FILE *f = fopen(path, "wb");
+    if (f == NULL)
+        return false;
+    uint8_t *gray = (uint8_t *)malloc(width * height);
+    for (int i = 0; i < width * height; i++)
+    {
+        uint8_t pixel = frame[i / 2];
+        gray[i] = ((i & 1) ? (pixel >> 4) : (pixel & 0x0F)) * 17;
+    }
+    bool res;
+    size_t len = strlen(path);
+    if (len > 4 && strcmp(path + len - 4, ".pgm") == 0)
+    {
+        fprintf(f, "P5\n%d %d\n255\n", width, height);
+        res = (fwrite(gray, 1, width * height, f) == (size_t)(width * height));
+    }
+    else
+        res = write_png(f, gray, width, height);
+    free(gray);
+    return (fclose(f) == 0) && res;
+}
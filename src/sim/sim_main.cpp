@@ -0,0 +1,646 @@
+// Host simulator: renders the weather screen from a Yandex answer into a PNG/PGM file
+// and times the rendering, without the LilyGo board.
+//
+//   sim [-d data_dir] [-w weather.json] [-o frame.png] [-n renders] [-c city] [-b volts] [-r rssi] [-s] [-t bands]
+//   sim [-d data_dir] -p prev.json [-w weather.json] [-o frame.png]
+//                                    a partial update from the prev.json frame, checked against a full redraw
+//   sim [-d data_dir] -q icons_dir   compares the scaled down atlas icons with the hand-made small ones
+//   sim -v svg_dir [-n renders]      times the SVG icons at both sizes, previews go next to them
+//   sim [-d data_dir] [-w weather.json] -k [-n runs]
+//                                    times the weather answer parse against loading the snapshot of it
+//   sim -y [-n runs]                 times the Yandex token lookups against the String == chains they replaced
+//   sim [-d data_dir] -m [-n runs]   times the param.json read against restoring its RTC copy
+//   sim [-d data_dir] -w weather.json -i svg_dir [-o frame.png]
+//                                    a wake with icons that are not in data_dir, fetched from svg_dir
+//   sim [-d data_dir] -e recording   replays a week of observations with the refresh policy and the fixed
+//                                    schedule, the quiet hours and the period are from param.json
+
+#include <Arduino.h>
+#include <SPIFFS.h>
+#include <ArduinoJson.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <unistd.h>
+#include <dirent.h>
+#include <vector>
+#include "render.h"
+#include "panel.h"
+#include "display_list.h"
+#include "glyph_cache.h"
+#include "icon_atlas.h"
+#include "icon_scale.h"
+#include "svg_raster.h"
+#include "weather_json.h"
+#include "weather_snapshot.h"
+#include "weather_vocab.h"
+#include "sim.h"
+#include "esp_timer.h"
+#include "refresh_policy.h"
+#include "param_cache.h"
+#include "param_json.h"
+
+param_t param;
+weather_t weather;
+int wifi_signal = -60;
+float battery_voltage = 4.0;
+uint8_t *displayBuffer;
+
+static const auto simStart = std::chrono::steady_clock::now();
+
+// Rows of the sections of the default layout: the status line, the current weather, the forecast
+static const damage_t sections[] = {{0, 0, EPD_WIDTH, 50}, {0, 50, EPD_WIDTH, 300}, {0, 350, EPD_WIDTH, EPD_HEIGHT - 350}};
+#define SECTION_COUNT (sizeof(sections) / sizeof(sections[0]))
+
+uint32_t millis()
+{
+    return micros() / 1000;
+}
+
+uint32_t micros()
+{
+    auto elapsed = std::chrono::steady_clock::now() - simStart;
+    return std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+}
+
+int64_t esp_timer_get_time()
+{
+    return micros();
+}
+
+void delay(uint32_t ms)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+static const char *iconSource = NULL; // -i: the directory getIcon() downloads from
+
+static bool read_file(const char *path, std::string &out)
+{
+    FILE *f = fopen(path, "rb");
+    if (f == NULL)
+        return false;
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+        out.append(buf, n);
+    fclose(f);
+    return true;
+}
+
+// No network here, an icon is copied from the -i directory like yastatic.net gives it, or is missing
+// and printed by name like on the board
+bool getIcon(const char *iconName)
+{
+    std::string svg;
+    if (iconSource == NULL || !read_file((std::string(iconSource) + "/" + iconName + ".svg").c_str(), svg))
+    {
+        log_i("icon %s is not in the data directory", iconName);
+        return false;
+    }
+    File f = SPIFFS.open("/" + String(iconName) + ".svg", FILE_WRITE);
+    bool res = f && f.write((const uint8_t *)svg.data(), svg.size()) == svg.size();
+    f.close();
+    return res;
+}
+
+static void load_param()
+{
+    if (param_read(SPIFFS, param) && !param.update_interval)
+        param.update_interval = 1;
+}
+
+static bool load_weather(const char *path)
+{
+    std::string json;
+    if (!read_file(path, json))
+    {
+        fprintf(stderr, "can't read %s\n", path);
+        return false;
+    }
+    StaticJsonDocument<WEATHER_DOC_SIZE> jsonDoc;
+    DeserializationError error = deserializeJson(jsonDoc, json, DeserializationOption::Filter(weather_filter()));
+    if (error)
+    {
+        fprintf(stderr, "%s: %s\n", path, error.c_str());
+        return false;
+    }
+    decode_weather(jsonDoc.as<JsonObject>(), weather);
+    return true;
+}
+
+static int pixel(const uint8_t *img, int width, int x, int y)
+{
+    uint8_t b = img[y * ((width + 1) / 2) + x / 2];
+    return (x & 1) ? (b >> 4) : (b & 0x0F);
+}
+
+// Like a wake: the chrome is drawn ahead, the weather is recorded over it
+static void render_frame()
+{
+    memset(displayBuffer, 0xFF, EPD_WIDTH * EPD_HEIGHT / 2);
+    dl_clear();
+    display_chrome();
+    dl_draw_ahead(SPIFFS, displayBuffer);
+    display_info();
+    display_weather();
+}
+
+// prev_json goes to the panel in full, the current weather over it in part, like two wakes do; the
+// panel must end up the same as the current frame drawn from scratch
+static int update_check(const char *prevPath, const char *weatherPath)
+{
+    if (!load_weather(prevPath))
+        return 1;
+    render_frame();
+    panel_invalidate();
+    panel_update(SPIFFS, displayBuffer);
+    if (!load_weather(weatherPath))
+        return 1;
+    simStats = {};
+    uint32_t start = micros();
+    render_frame();
+    panel_update(SPIFFS, displayBuffer);
+    uint32_t elapsed = micros() - start;
+    printf("update: %u commands, %u full, %u areas, %u pushes, %llu pixels, %u us\n", dl_count(), simStats.full,
+           simStats.areas, simStats.pushes, (unsigned long long)simStats.pixels, elapsed);
+
+    memset(displayBuffer, 0xFF, EPD_WIDTH * EPD_HEIGHT / 2);
+    dl_clear();
+    display_chrome();
+    display_info();
+    display_weather();
+    dl_draw(SPIFFS, displayBuffer);
+    int off = 0;
+    for (int y = 0; y < EPD_HEIGHT; y++)
+        for (int x = 0; x < EPD_WIDTH; x++)
+            off += pixel(sim_panel(), EPD_WIDTH, x, y) != pixel(displayBuffer, EPD_WIDTH, x, y);
+    if (off > 0)
+    {
+        fprintf(stderr, "the panel differs from a full redraw in %d pixels\n", off);
+        return 1;
+    }
+    printf("the panel is the same as a full redraw\n");
+    return 0;
+}
+
+// The answer parsed like the fetch does against the snapshot the fetch leaves, best of runs each; the snapshot
+// must give back the same weather_t
+static int snapshot_bench(const char *weatherPath, int runs)
+{
+    weather_t parsed, loaded;
+    uint32_t bestParse = UINT32_MAX, bestLoad = UINT32_MAX;
+    for (int i = 0; i < runs; i++)
+    {
+        memset(&weather, 0, sizeof(weather));
+        uint32_t start = micros();
+        if (!load_weather(weatherPath))
+            return 1;
+        bestParse = min(bestParse, micros() - start);
+    }
+    parsed = weather;
+    if (!snapshot_save(SPIFFS, parsed))
+    {
+        fprintf(stderr, "can't save the snapshot\n");
+        return 1;
+    }
+    for (int i = 0; i < runs; i++)
+    {
+        memset(&loaded, 0, sizeof(loaded));
+        uint32_t start = micros();
+        if (!snapshot_load(SPIFFS, loaded))
+        {
+            fprintf(stderr, "can't load the snapshot\n");
+            SPIFFS.remove(SNAPSHOT_FILE);
+            return 1;
+        }
+        bestLoad = min(bestLoad, micros() - start);
+    }
+    SPIFFS.remove(SNAPSHOT_FILE);
+    bool same = memcmp(&parsed, &loaded, sizeof(weather_t)) == 0;
+    printf("weather: parse %u us, snapshot load %u us (%u bytes), best of %d; %s\n", bestParse, bestLoad,
+           (uint32_t)sizeof(snapshot_t), runs, same ? "the same weather_t" : "the weather_t differs");
+    return same ? 0 : 1;
+}
+
+// The first wake reads param.json, the wakes after it restore the RTC copy instead; SPIFFS is mounted
+// before both, on the board its mount is the spiffs phase of the wake profile
+static int param_bench(int runs)
+{
+    param_t read, restored;
+    uint32_t start = micros();
+    for (int i = 0; i < runs; i++)
+    {
+        if (!param_read(SPIFFS, read))
+            return 1;
+    }
+    double readUs = (double)(micros() - start) / runs;
+    if (!param_store(read))
+    {
+        fprintf(stderr, "param.json does not fit the RTC copy\n");
+        return 1;
+    }
+    start = micros();
+    for (int i = 0; i < runs; i++)
+    {
+        if (!param_restore(restored))
+        {
+            fprintf(stderr, "can't restore the RTC copy\n");
+            return 1;
+        }
+    }
+    double restoreUs = (double)(micros() - start) / runs;
+    param_invalidate();
+    bool same = read.city == restored.city && read.lat == restored.lat && read.lon == restored.lon &&
+                read.test_data == restored.test_data && read.api_key == restored.api_key &&
+                read.update_interval == restored.update_interval && read.time_zone == restored.time_zone &&
+                read.ap_ssid == restored.ap_ssid && read.ap_pass == restored.ap_pass &&
+                read.generation == restored.generation && read.quiet_cnt == restored.quiet_cnt &&
+                memcmp(read.quiet, restored.quiet, read.quiet_cnt * sizeof(quiet_hours_t)) == 0;
+    printf("param: read and parse %.2f us, RTC copy restore %.2f us, mean of %d; %s\n", readUs, restoreUs, runs,
+           same ? "the same param_t" : "the param_t differs");
+    return same ? 0 : 1;
+}
+
+// The wake of a weather with icons that are not in data_dir: prefetch_icons() gets them from svg_dir while
+// "connected", then the frame is drawn with getIcon() failing like with the radio off. Every new icon must be
+// drawn as an image; the files the wake made are removed, data_dir is left as it was
+static int icon_check(const char *weatherPath, const char *svgDir, const char *output)
+{
+    if (!load_weather(weatherPath))
+        return 1;
+    const uint8_t icons[] = {weather.fact.icon, weather.forecast.parts[0].icon, weather.forecast.parts[1].icon};
+    std::vector<std::string> fresh;
+    for (uint8_t i = 0; i < sizeof(icons); i++)
+    {
+        std::string name = icon_name(icons[i]);
+        if (icons[i] != ICON_NONE && !icon_ready(name.c_str()) && !SPIFFS.exists(("/" + name + ".svg").c_str()) &&
+            std::find(fresh.begin(), fresh.end(), name) == fresh.end())
+            fresh.push_back(name);
+    }
+    if (fresh.empty())
+    {
+        fprintf(stderr, "every icon of the weather is in the data directory, nothing to fetch\n");
+        return 1;
+    }
+
+    iconSource = svgDir;
+    uint32_t start = micros();
+    prefetch_icons();
+    uint32_t elapsed = micros() - start;
+    iconSource = NULL;
+    render_frame();
+    dl_draw(SPIFFS, displayBuffer);
+    sim_write_image(output, displayBuffer, EPD_WIDTH, EPD_HEIGHT);
+
+    int failed = 0;
+    for (size_t i = 0; i < fresh.size(); i++)
+    {
+        const std::string &name = fresh[i];
+        // Both sizes as images, not the name printed in their place
+        bool drawn = icon_ready(name.c_str());
+        for (int large = 0; large < 2 && drawn; large++)
+            drawn = draw_image((name + (large ? "L" : "")).c_str(), 0, 0, large ? L_SIZE : S_SIZE, large ? L_SIZE : S_SIZE);
+        printf("%-12s %s\n", name.c_str(), drawn ? "fetched, rendered and drawn" : "not drawn");
+        failed += !drawn;
+        SPIFFS.remove(("/" + name + ".svg").c_str());
+        SPIFFS.remove(("/" + name + ".bin").c_str());
+        SPIFFS.remove(("/" + name + "L.bin").c_str());
+    }
+    printf("%u new icon(s), %u us to fetch and render, %d not drawn\n", (uint32_t)fresh.size(), elapsed, failed);
+    return failed ? 1 : 0;
+}
+
+// Every icons_dir/name.bin that the board makes from nameL in the atlas, against what the board makes
+static int quality_check(const char *iconsDir)
+{
+    DIR *dir = opendir(iconsDir);
+    if (dir == NULL)
+    {
+        fprintf(stderr, "can't open %s\n", iconsDir);
+        return 1;
+    }
+    const int size = S_SIZE * S_SIZE / 2;
+    uint8_t *ref = (uint8_t *)malloc(size);
+    uint8_t *out = (uint8_t *)malloc(size);
+    double maeSum[2] = {0, 0};
+    uint32_t timeSum = 0;
+    int icons = 0;
+    printf("%-12s %27s %27s\n", "icon", "mean err / PSNR / >3 levels", "the same, sharpened");
+    dirent *entry;
+    while ((entry = readdir(dir)) != NULL)
+    {
+        std::string file = entry->d_name;
+        if (file.size() < 5 || file.compare(file.size() - 4, 4, ".bin") != 0)
+            continue;
+        std::string name = file.substr(0, file.size() - 4);
+        atlas_entry_t large;
+        if (!atlas_find(SPIFFS, (name + "L").c_str(), large))
+            continue;
+        FILE *f = fopen((std::string(iconsDir) + "/" + file).c_str(), "rb");
+        if (f == NULL)
+            continue;
+        memset(ref, 0xFF, size);
+        fread(ref, 1, size, f);
+        fclose(f);
+        uint8_t *src = atlas_load(SPIFFS, (name + "L").c_str());
+        if (src == NULL)
+            continue;
+        printf("%-12s", name.c_str());
+        for (int sharpen = 0; sharpen < 2; sharpen++)
+        {
+            uint32_t start = micros();
+            icon_downscale(src, large.width, large.height, out, S_SIZE, S_SIZE, sharpen);
+            timeSum += micros() - start;
+            double err = 0, sq = 0;
+            int off = 0;
+            for (int y = 0; y < S_SIZE; y++)
+            {
+                for (int x = 0; x < S_SIZE; x++)
+                {
+                    int d = abs(pixel(out, S_SIZE, x, y) - pixel(ref, S_SIZE, x, y));
+                    err += d;
+                    sq += d * d;
+                    off += d > 3;
+                }
+            }
+            err /= S_SIZE * S_SIZE;
+            sq /= S_SIZE * S_SIZE;
+            maeSum[sharpen] += err;
+            printf("   %5.2f / %5.1f dB / %4.1f%%", err, (sq > 0) ? 10 * log10(225 / sq) : 99.0,
+                   off * 100.0 / (S_SIZE * S_SIZE));
+        }
+        printf("\n");
+        free(src);
+        icons++;
+    }
+    closedir(dir);
+    free(ref);
+    free(out);
+    if (icons == 0)
+    {
+        fprintf(stderr, "no small icons with a large one in the atlas\n");
+        return 1;
+    }
+    printf("%d icons, mean error %.3f plain, %.3f sharpened (grey levels of 15), %u us per scale\n", icons,
+           maeSum[0] / icons, maeSum[1] / icons, timeSum / (2 * icons));
+    return 0;
+}
+
+// Every svg_dir/name.svg rendered like a downloaded icon, best of renders each
+static int svg_bench(const char *svgDir, int renders)
+{
+    fs::FS svgFs;
+    DIR *dir = opendir(svgDir);
+    if (dir == NULL || !svgFs.begin(svgDir))
+    {
+        fprintf(stderr, "can't open %s\n", svgDir);
+        return 1;
+    }
+    const int sizes[2] = {L_SIZE, S_SIZE};
+    uint8_t *image = (uint8_t *)malloc(L_SIZE * L_SIZE / 2);
+    uint32_t sum[2] = {0, 0};
+    int icons = 0, failed = 0;
+    printf("%-12s %10s %10s\n", "icon", "L, us", "S, us");
+    dirent *entry;
+    while ((entry = readdir(dir)) != NULL)
+    {
+        std::string file = entry->d_name;
+        if (file.size() < 5 || file.compare(file.size() - 4, 4, ".svg") != 0)
+            continue;
+        std::string name = file.substr(0, file.size() - 4);
+        uint32_t best[2] = {UINT32_MAX, UINT32_MAX};
+        bool ok = true;
+        for (int i = 0; i < 2 && ok; i++)
+        {
+            for (int n = 0; n < renders && ok; n++)
+            {
+                uint32_t start = micros();
+                ok = svg_render(svgFs, ("/" + file).c_str(), sizes[i], sizes[i], image);
+                best[i] = min(best[i], micros() - start);
+            }
+            std::string preview = std::string(svgDir) + "/" + name + (i ? "" : "L") + ".png";
+            if (ok)
+                sim_write_image(preview.c_str(), image, sizes[i], sizes[i]);
+        }
+        if (!ok)
+        {
+            printf("%-12s can't render\n", name.c_str());
+            failed++;
+            continue;
+        }
+        printf("%-12s %10u %10u\n", name.c_str(), best[0], best[1]);
+        sum[0] += best[0];
+        sum[1] += best[1];
+        icons++;
+    }
+    closedir(dir);
+    free(image);
+    if (icons > 0)
+        printf("%d icons, mean %u us at %dx%d, %u us at %dx%d\n", icons, sum[0] / icons, L_SIZE, L_SIZE,
+               sum[1] / icons, S_SIZE, S_SIZE);
+    return (icons == 0 || failed > 0) ? 1 : 0;
+}
+
+int main(int argc, char **argv)
+{
+    const char *dataDir = "data";
+    const char *weatherFile = NULL;
+    const char *output = "frame.png";
+    const char *city = NULL;
+    int renders = 1;
+    const char *iconsDir = NULL;
+    const char *svgDir = NULL;
+    const char *prevFile = NULL;
+    const char *recording = NULL;
+    const char *fetchDir = NULL;
+    bool snapshot = false;
+    bool vocab = false;
+    bool paramCache = false;
+    bool settings = false;
+    int bands = DL_BANDS;
+    int opt;
+    while ((opt = getopt(argc, argv, "d:w:o:n:c:b:r:sq:v:p:t:e:ki:ym")) != -1)
+    {
+        switch (opt)
+        {
+        case 'd':
+            dataDir = optarg;
+            break;
+        case 'w':
+            weatherFile = optarg;
+            break;
+        case 'o':
+            output = optarg;
+            break;
+        case 'n':
+            renders = max(1, atoi(optarg));
+            break;
+        case 'c':
+            city = optarg;
+            break;
+        case 'b':
+            battery_voltage = atof(optarg);
+            break;
+        case 'r':
+            wifi_signal = atoi(optarg);
+            break;
+        case 's':
+            settings = true;
+            break;
+        case 'q':
+            iconsDir = optarg;
+            break;
+        case 'v':
+            svgDir = optarg;
+            break;
+        case 'p':
+            prevFile = optarg;
+            break;
+        case 't':
+            bands = atoi(optarg);
+            break;
+        case 'e':
+            recording = optarg;
+            break;
+        case 'k':
+            snapshot = true;
+            break;
+        case 'i':
+            fetchDir = optarg;
+            break;
+        case 'y':
+            vocab = true;
+            break;
+        case 'm':
+            paramCache = true;
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-d data_dir] [-w weather.json] [-o frame.png|frame.pgm] [-n renders] "
+                            "[-c city] [-b volts] [-r rssi] [-s] [-t bands]\n"
+                            "       %s [-d data_dir] -p prev.json [-w weather.json] [-o frame.png|frame.pgm]\n"
+                            "       %s [-d data_dir] -q icons_dir\n"
+                            "       %s -v svg_dir [-n renders]\n"
+                            "       %s [-d data_dir] [-w weather.json] -k [-n runs]\n"
+                            "       %s -y [-n runs]\n"
+                            "       %s [-d data_dir] -m [-n runs]\n"
+                            "       %s [-d data_dir] -w weather.json -i svg_dir [-o frame.png|frame.pgm]\n"
+                            "       %s [-d data_dir] -e recording\n",
+                    argv[0], argv[0], argv[0], argv[0], argv[0], argv[0], argv[0], argv[0], argv[0]);
+            return 2;
+        }
+    }
+
+    if (svgDir)
+        return svg_bench(svgDir, renders);
+    if (vocab)
+        return vocab_bench(renders);
+    if (!SPIFFS.begin(dataDir))
+    {
+        fprintf(stderr, "%s is not a directory\n", dataDir);
+        return 1;
+    }
+    if (iconsDir)
+        return quality_check(iconsDir);
+    if (paramCache)
+        return param_bench(renders);
+    load_param();
+    if (city)
+        param.city = city;
+    // Yandex times are printed in the configured zone, like configTime() does on the board
+    char tz[16];
+    snprintf(tz, sizeof(tz), "UTC%+d", -param.time_zone);
+    setenv("TZ", tz, 1);
+    tzset();
+    if (recording)
+        return schedule_replay(recording, param.update_interval * 3600);
+
+    std::string weatherPath = weatherFile ? weatherFile : std::string(dataDir) + "/test_data.json";
+    if (snapshot)
+        return snapshot_bench(weatherPath.c_str(), renders);
+    if (!settings && !load_weather(weatherPath.c_str()))
+        return 1;
+
+    displayBuffer = (uint8_t *)ps_calloc(sizeof(uint8_t), EPD_WIDTH * EPD_HEIGHT / 2);
+    dl_bands(bands);
+    if (fetchDir)
+        return icon_check(weatherPath.c_str(), fetchDir, output);
+    if (prevFile && update_check(prevFile, weatherPath.c_str()))
+        return 1;
+    uint32_t best = UINT32_MAX, bestRaster = UINT32_MAX, bestAhead = UINT32_MAX;
+    uint64_t total = 0, totalRaster = 0, totalAhead = 0;
+    uint16_t chromeCnt = 0;
+    glyph_cache_stats_t glyphs = {};
+    for (int i = 0; i < renders; i++)
+    {
+        memset(displayBuffer, 0xFF, EPD_WIDTH * EPD_HEIGHT / 2);
+        dl_clear();
+        glyph_cache_clear(); // Every frame is drawn after a boot on the board
+        uint32_t start = micros();
+        if (settings)
+            display_settings("WEATHER_STATION", "0123456789");
+        else
+        {
+            // The board does this part while the weather is fetched
+            display_chrome();
+            chromeCnt = dl_count();
+            dl_draw_ahead(SPIFFS, displayBuffer);
+            uint32_t ahead = micros() - start;
+            bestAhead = min(bestAhead, ahead);
+            totalAhead += ahead;
+            display_info();
+            display_weather();
+        }
+        uint32_t recorded = micros();
+        dl_draw(SPIFFS, displayBuffer);
+        uint32_t elapsed = micros() - start;
+        best = min(best, elapsed);
+        total += elapsed;
+        bestRaster = min(bestRaster, micros() - recorded);
+        totalRaster += micros() - recorded;
+        glyphs.hits += glyph_cache_stats().hits;
+        glyphs.misses += glyph_cache_stats().misses;
+        glyphs.evictions += glyph_cache_stats().evictions;
+        glyphs.bytes = max(glyphs.bytes, glyph_cache_stats().bytes);
+    }
+    printf("render: %d frame(s) of %u commands, best %u us, mean %u us\n", renders, dl_count(), best,
+           (uint32_t)(total / renders));
+    if (!settings)
+        printf("ahead: the chrome of %u commands, best %u us, mean %u us\n", chromeCnt, bestAhead,
+               (uint32_t)(totalAhead / renders));
+    printf("raster after it: %d band(s), best %u us, mean %u us\n", bands, bestRaster, (uint32_t)(totalRaster / renders));
+    printf("glyph cache per frame: %u hits, %u misses, %u evictions, %u bytes\n", glyphs.hits / renders,
+           glyphs.misses / renders, glyphs.evictions / renders, glyphs.bytes);
+    if (!settings)
+    {
+        // Every section drawn on its own like a partial update of it, wall clock with the bands on their threads
+        uint8_t *scratch = (uint8_t *)malloc(EPD_WIDTH * EPD_HEIGHT / 2);
+        for (uint8_t s = 0; s < SECTION_COUNT; s++)
+        {
+            uint32_t bestSection = UINT32_MAX;
+            uint64_t totalSection = 0;
+            for (int i = 0; i < renders; i++)
+            {
+                memcpy(scratch, displayBuffer, EPD_WIDTH * EPD_HEIGHT / 2);
+                glyph_cache_clear();
+                uint32_t start = micros();
+                dl_draw(SPIFFS, scratch, &sections[s], 1);
+                uint32_t elapsed = micros() - start;
+                bestSection = min(bestSection, elapsed);
+                totalSection += elapsed;
+            }
+            printf("raster of rows %d-%d: %d band(s), best %u us, mean %u us\n", sections[s].y,
+                   sections[s].y + sections[s].h, bands, bestSection, (uint32_t)(totalSection / renders));
+        }
+        free(scratch);
+    }
+
+    if (!sim_write_image(output, displayBuffer, EPD_WIDTH, EPD_HEIGHT))
+    {
+        fprintf(stderr, "can't write %s\n", output);
+        return 1;
+    }
+    printf("frame written to %s\n", output);
+    free(displayBuffer);
+    return 0;
+}
@@ -0,0 +1,158 @@
+// Replays recorded observations against the refresh policy and the fixed schedule it replaces.
+// A recording is "obs_time,temp,prec_prob,battery" lines, the "policy: observed" lines of the board's log
+// can be used as they are. The energy is by the model below, not measured.
+
+#include <Arduino.h>
+#include <vector>
+#include "refresh_policy.h"
+#include "render.h"
+#include "sim.h"
+
+#define SIM_SLEEP_MA 0.25  // Deep sleep, the whole board
+#define SIM_FETCH_S 6.0    // WiFi, NTP and the weather request
+#define SIM_FETCH_MA 110
+#define SIM_QUIET_S 3.0    // WiFi and NTP of a wake in the quiet hours, the fixed schedule only
+#define SIM_QUIET_MA 110
+#define SIM_REFRESH_S 6.0  // Panel on, the refresh and the wait after it
+#define SIM_REFRESH_MA 80
+#define SIM_SAMPLE 300     // s between the checks of the shown weather against the recorded one
+
+typedef struct
+{
+    time_t time;
+    float temp;
+    uint8_t precProb;
+    uint8_t battery;
+} sim_record_t;
+
+typedef struct
+{
+    uint32_t wakes;
+    uint32_t fetches;
+    uint32_t refreshes;
+    float mAh;
+    float tempError;    // Mean of |shown - recorded|, degrees
+    float tempErrorMax;
+    float precError;    // Mean, %
+    uint32_t reasons[8]; // Decisions with each POLICY_* bit
+} sim_schedule_t;
+
+static bool read_records(const char *path, std::vector<sim_record_t> &records)
+{
+    FILE *f = fopen(path, "r");
+    if (f == NULL)
+        return false;
+    char line[256];
+    while (fgets(line, sizeof(line), f))
+    {
+        const char *fields = strstr(line, "policy: observed ");
+        fields = fields ? fields + strlen("policy: observed ") : line;
+        long time;
+        float temp;
+        unsigned prec, battery;
+        if (sscanf(fields, "%ld,%f,%u,%u", &time, &temp, &prec, &battery) == 4)
+            records.push_back({(time_t)time, temp, (uint8_t)prec, (uint8_t)battery});
+    }
+    fclose(f);
+    return records.size() > 1;
+}
+
+// The last record at or before time
+static const sim_record_t &record_at(const std::vector<sim_record_t> &records, time_t time)
+{
+    size_t i = 0;
+    while (i + 1 < records.size() && records[i + 1].time <= time)
+        i++;
+    return records[i];
+}
+
+static sim_schedule_t run(const std::vector<sim_record_t> &records, uint32_t base, bool adaptive)
+{
+    sim_schedule_t s = {};
+    policy_reset();
+    time_t start = (records.front().time + base - 1) / base * base;
+    time_t end = records.back().time;
+    time_t sampled = start;
+    uint32_t samples = 0;
+    int shownTemp = 0, shownPrec = 0, shownBattery = -1;
+    float sleepS = 0;
+    for (time_t t = start; t <= end;)
+    {
+        // What the panel showed up to this wake
+        for (; sampled < t; sampled += SIM_SAMPLE)
+        {
+            const sim_record_t &r = record_at(records, sampled);
+            float error = fabsf(shownTemp - r.temp);
+            s.tempError += error;
+            s.tempErrorMax = max(s.tempErrorMax, error);
+            s.precError += abs(shownPrec - r.precProb);
+            samples++;
+        }
+        s.wakes++;
+        if (policy_quiet(t, param))
+            s.mAh += SIM_QUIET_S * SIM_QUIET_MA / 3600;
+        else
+        {
+            const sim_record_t &r = record_at(records, t);
+            s.fetches++;
+            s.mAh += SIM_FETCH_S * SIM_FETCH_MA / 3600;
+            int temp = lroundf(r.temp);
+            if (shownBattery < 0 || temp != shownTemp || r.precProb != shownPrec || r.battery != shownBattery)
+            {
+                s.refreshes++;
+                s.mAh += SIM_REFRESH_S * SIM_REFRESH_MA / 3600;
+                shownTemp = temp;
+                shownPrec = r.precProb;
+                shownBattery = r.battery;
+            }
+            weather_t w = {};
+            w.fact.obs_time = r.time;
+            w.fact.temp = temp;
+            w.forecast.parts[0].prec_prob = r.precProb;
+            policy_observe(w, r.battery);
+        }
+        time_t next = t + base; // The fixed schedule also woke in the quiet hours, only to go back to sleep
+        if (adaptive)
+        {
+            policy_decision_t d = policy_next(t, base, param);
+            policy_log(d);
+            for (uint8_t i = 0; i < 8; i++)
+                s.reasons[i] += (d.reasons >> i) & 1;
+            next = d.next;
+        }
+        sleepS += next - t;
+        t = next;
+    }
+    s.mAh += sleepS * SIM_SLEEP_MA / 3600;
+    s.tempError /= max(samples, 1u);
+    s.precError /= max(samples, 1u);
+    return s;
+}
+
+static void print_schedule(const char *name, const sim_schedule_t &s)
+{
+    printf("%-8s %5u wakes, %4u fetches, %4u refreshes, %6.1f mAh; shown temp off by %.2f (max %.1f), "
+           "precipitation by %.1f%%\n",
+           name, s.wakes, s.fetches, s.refreshes, s.mAh, s.tempError, s.tempErrorMax, s.precError);
+}
+
+int schedule_replay(const char *path, uint32_t base)
+{
+    std::vector<sim_record_t> records;
+    if (!read_records(path, records))
+    {
+        fprintf(stderr, "%s: no records\n", path);
+        return 1;
+    }
+    printf("replay: %u records over %.1f days, base interval %u min\n", (uint32_t)records.size(),
+           (records.back().time - records.front().time) / 86400.0, base / 60);
+    sim_schedule_t fixed = run(records, base, false);
+    sim_schedule_t policy = run(records, base, true);
+    print_schedule("fixed", fixed);
+    print_schedule("policy", policy);
+    printf("policy decisions: %u volatile, %u calm, %u battery, %u quiet, %u no data\n", policy.reasons[0],
+           policy.reasons[1], policy.reasons[2], policy.reasons[3], policy.reasons[4]);
+    printf("energy: %.0f%% of the fixed schedule (model: sleep %.2f mA, fetch %.0f s at %d mA, refresh %.0f s at %d mA)\n",
+           100 * policy.mAh / fixed.mAh, SIM_SLEEP_MA, SIM_FETCH_S, SIM_FETCH_MA, SIM_REFRESH_S, SIM_REFRESH_MA);
+    return 0;
+}
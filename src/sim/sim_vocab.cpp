@@ -0,0 +1,201 @@
+// Times the generated vocabulary tables against the String == chains they replaced, and checks that both
+// give the same labels and angles for every token of the tables and for a token Yandex may add later.
+// The chains are the ones of the original sketch, get_wind_angle() with the return it fell off without.
+
+#include <Arduino.h>
+#include <vector>
+#include "weather_vocab.h"
+#include "weather_vocab_table.h"
+#include "sim.h"
+
+#define VOCAB_LOOKUPS 20000 // Per token and run
+#define VOCAB_NEW_TOKEN "dust-storm"
+
+typedef struct
+{
+    const char *name;
+    const vocab_entry_t *table;
+    uint8_t slots;
+    String (*chain)(String token);
+    const char *(*lookup)(const char *token);
+    int16_t (*chainAngle)(String token); // The wind is timed by the angles, the strings are for the check
+    int16_t (*tableAngle)(const char *token);
+} vocab_bench_t;
+
+static String get_description_condition(String str)
+{
+    String retStr = str;
+    if (str == "clear")
+        retStr = "Ясно";
+    if (str == "partly-cloudy")
+        retStr = "Малооблачно";
+    if (str == "cloudy")
+        retStr = "Облачно с прояснениями";
+    if (str == "overcast")
+        retStr = "Пасмурно";
+    if (str == "drizzle")
+        retStr = "Моросящий дождь";
+    if (str == "light-rain")
+        retStr = "Небольшой дождь";
+    if (str == "rain")
+        retStr = "Дождь";
+    if (str == "moderate-rain")
+        retStr = "Умеренно сильный дождь";
+    if (str == "heavy-rain")
+        retStr = "Сильный дождь";
+    if (str == "continuous-heavy-rain")
+        retStr = "Длительный сильный дождь";
+    if (str == "showers")
+        retStr = "Ливень";
+    if (str == "wet-snow")
+        retStr = "Дождь со снегом";
+    if (str == "light-snow")
+        retStr = "Небольшой снег";
+    if (str == "snow")
+        retStr = "Снег";
+    if (str == "snow-showers")
+        retStr = "Снегопад";
+    if (str == "hail")
+        retStr = "Град";
+    if (str == "thunderstorm")
+        retStr = "Гроза";
+    if (str == "thunderstorm-with-rain")
+        retStr = "Дождь с грозой";
+    if (str == "thunderstorm-with-hail")
+        retStr = "Гроза с градом";
+    return retStr;
+}
+
+static String getSeason(String season)
+{
+    if (season == "summer")
+        return "Лето";
+    if (season == "autumn")
+        return "Осень";
+    if (season == "winter")
+        return "Зима";
+    if (season == "spring")
+        return "Весна";
+    return season;
+}
+
+static String get_partName(String pName)
+{
+    if (pName == "night")
+        return "Ночь";
+    if (pName == "morning")
+        return "Утро";
+    if (pName == "day")
+        return "День";
+    if (pName == "evening")
+        return "Вечер";
+    return pName;
+}
+
+static int16_t get_wind_angle(String dir)
+{
+    if (dir == "nw")
+        return 315;
+    if (dir == "n")
+        return 0;
+    if (dir == "ne")
+        return 45;
+    if (dir == "e")
+        return 90;
+    if (dir == "se")
+        return 135;
+    if (dir == "s")
+        return 180;
+    if (dir == "sw")
+        return 225;
+    if (dir == "w")
+        return 270;
+    if (dir == "c")
+        return -1;
+    return -1;
+}
+
+// The angle as a string, so the wind is checked in the same loop as the labels
+static String chain_wind(String dir)
+{
+    return String((int)get_wind_angle(dir));
+}
+
+static const char *table_condition(const char *token)
+{
+    return label_or_token(condition_label(parse_condition(token)), token);
+}
+
+static const char *table_season(const char *token)
+{
+    return label_or_token(season_label(parse_season(token)), token);
+}
+
+static const char *table_part_name(const char *token)
+{
+    return label_or_token(part_name_label(parse_part_name(token)), token);
+}
+
+static int16_t table_angle(const char *token)
+{
+    return wind_dir_angle(parse_wind_dir(token));
+}
+
+static const char *table_wind(const char *token)
+{
+    static char angle[8];
+    snprintf(angle, sizeof(angle), "%d", table_angle(token));
+    return angle;
+}
+
+int vocab_bench(int runs)
+{
+    const vocab_bench_t vocabs[] = {
+        {"condition", condition_table, CONDITION_SLOTS, get_description_condition, table_condition, NULL, NULL},
+        {"season", season_table, SEASON_SLOTS, getSeason, table_season, NULL, NULL},
+        {"part_name", part_name_table, PART_NAME_SLOTS, get_partName, table_part_name, NULL, NULL},
+        {"wind_dir", wind_dir_table, WIND_DIR_SLOTS, chain_wind, table_wind, get_wind_angle, table_angle},
+    };
+    int mismatches = 0;
+    volatile uint32_t sink = 0; // Keeps the lookups from being optimized out
+    printf("%-10s %6s %12s %12s\n", "vocabulary", "tokens", "chain, ns", "table, ns");
+    for (const vocab_bench_t &v : vocabs)
+    {
+        std::vector<const char *> tokens;
+        for (uint8_t i = 0; i < v.slots; i++)
+        {
+            if (*v.table[i].token)
+                tokens.push_back(v.table[i].token);
+        }
+        tokens.push_back(VOCAB_NEW_TOKEN);
+        for (const char *token : tokens)
+        {
+            String old = v.chain(token);
+            if (strcmp(old.c_str(), v.lookup(token)) != 0)
+            {
+                printf("%s: \"%s\" is \"%s\" by the chain and \"%s\" by the table\n", v.name, token, old.c_str(),
+                       v.lookup(token));
+                mismatches++;
+            }
+        }
+        uint32_t best[2] = {UINT32_MAX, UINT32_MAX};
+        for (int n = 0; n < runs; n++)
+        {
+            uint32_t start = micros();
+            for (int k = 0; k < VOCAB_LOOKUPS; k++)
+                for (const char *token : tokens)
+                    sink += v.chainAngle ? v.chainAngle(token) : v.chain(token).length();
+            best[0] = min(best[0], micros() - start);
+            start = micros();
+            for (int k = 0; k < VOCAB_LOOKUPS; k++)
+                for (const char *token : tokens)
+                    sink += v.tableAngle ? v.tableAngle(token) : *v.lookup(token);
+            best[1] = min(best[1], micros() - start);
+        }
+        double lookups = (double)VOCAB_LOOKUPS * tokens.size() / 1000;
+        printf("%-10s %6u %12.1f %12.1f\n", v.name, (uint32_t)tokens.size(), best[0] / lookups, best[1] / lookups);
+    }
+    printf("per lookup and label, best of %d; %s\n", runs,
+           mismatches ? "the tables differ from the chains" : "the same labels and angles");
+    return mismatches ? 1 : 0;
+}
@@ -0,0 +1,1206 @@
+#include "svg_raster.h"
+
+#define SUBROWS 4                       // Sample rows per pixel row
+#define SUBPIXEL 16                     // Steps of horizontal coverage per pixel
+#define FULL_COVER (SUBROWS * SUBPIXEL) // Coverage of a pixel inside the shape
+#define FLATNESS 0.1f                   // Most a flattened curve is off the real one, pixels
+#define MAX_SEGMENTS 128                // Lines per curve
+#define NAME_SIZE 24
+#define VALUE_SIZE 128 // Longer attribute values are cut, d and points are streamed instead
+
+#define FILL_INHERIT -2
+#define FILL_NONE -1
+
+enum element_kind
+{
+    EL_OTHER, // Drawn like g
+    EL_SVG,
+    EL_HIDDEN, // Its content is not drawn: defs, clipPath, mask...
+    EL_GRADIENT,
+    EL_STOP,
+    EL_PATH,
+    EL_POLY,
+    EL_CIRCLE,
+    EL_ELLIPSE,
+    EL_RECT,
+};
+
+typedef struct
+{
+    float a, b, c, d, e, f; // x' = a x + c y + e, y' = b x + d y + f
+} matrix_t;
+
+typedef struct
+{
+    matrix_t ctm;
+    int16_t fill; // Grey 0..255 or FILL_NONE
+    float paint;  // Opacity of the fill colour itself, gradients can be see-through
+    float fillOpacity;
+    float opacity; // Of the groups down to here, multiplied into the fill
+    bool evenOdd;
+    bool hidden;
+} style_t;
+
+// What the attributes of one element say; FILL_INHERIT and negative values - not given
+typedef struct
+{
+    int16_t fill;
+    float paint;
+    float fillOpacity;
+    float opacity;
+    int8_t evenOdd;
+    bool hidden;
+    matrix_t transform;
+    float x, y, width, height, cx, cy, r, rx, ry;
+    float viewBox[4];
+    bool hasViewBox;
+    int16_t stopGrey;
+    float stopOpacity;
+    uint32_t id;
+    uint32_t href;
+} attrs_t;
+
+typedef struct
+{
+    uint32_t id;
+    float grey; // Sums over the stops
+    float alpha;
+    uint16_t stops;
+} gradient_t;
+
+typedef struct
+{
+    float x, y;
+    bool move; // Starts a subpath
+} point_t;
+
+typedef struct
+{
+    float x0, y0, y1; // y0 < y1
+    float slope;
+    int8_t dir;
+} edge_t;
+
+typedef struct
+{
+    int32_t x; // 1/SUBPIXEL px
+    int8_t dir;
+} crossing_t;
+
+typedef struct
+{
+    File *file;
+    uint8_t buf[SVG_CHUNK];
+    int pos, len;
+
+    int width, height;
+    uint8_t *canvas; // 8-bit grey, white where nothing is drawn
+    uint16_t *cover; // One pixel row, width + 1
+    bool sized;      // The root svg element is read
+    bool complete;   // and closed, a cut download is not drawn
+
+    style_t stack[SVG_MAX_DEPTH];
+    int depth; // Can go past SVG_MAX_DEPTH, the deepest elements share the last entry then
+
+    gradient_t gradients[SVG_GRADIENTS];
+    int gradientCnt;
+    int gradient; // Being read, -1 - none
+
+    // The shape being read, in user units
+    point_t *points;
+    int pointCnt, pointCap;
+    edge_t *edges;
+    int *active;
+    crossing_t *crossings;
+    int edgeCap;
+
+    // Path data parser
+    char cmd;
+    char lastCmd;
+    float args[7];
+    int argCnt;
+    char number[24];
+    int numberLen;
+    bool numberDot, numberExp;
+    float curX, curY, startX, startY;
+    float ctrlX, ctrlY; // Last control point of C/S or Q/T
+    bool needMove;
+    float scale; // Pixels per user unit, for flattening
+} svg_t;
+
+static const struct
+{
+    const char *name;
+    uint8_t kind;
+} elements[] = {
+    {"svg", EL_SVG},
+    {"path", EL_PATH},
+    {"circle", EL_CIRCLE},
+    {"ellipse", EL_ELLIPSE},
+    {"rect", EL_RECT},
+    {"polygon", EL_POLY},
+    {"polyline", EL_POLY},
+    {"linearGradient", EL_GRADIENT},
+    {"radialGradient", EL_GRADIENT},
+    {"stop", EL_STOP},
+    {"defs", EL_HIDDEN},
+    {"clipPath", EL_HIDDEN},
+    {"mask", EL_HIDDEN},
+    {"symbol", EL_HIDDEN},
+    {"pattern", EL_HIDDEN},
+    {"marker", EL_HIDDEN},
+    {"filter", EL_HIDDEN},
+    {"text", EL_HIDDEN},
+    {"style", EL_HIDDEN},
+    {"title", EL_HIDDEN},
+    {"desc", EL_HIDDEN},
+    {"metadata", EL_HIDDEN},
+};
+
+static const matrix_t identity = {1, 0, 0, 1, 0, 0};
+
+static bool parse(svg_t &s);
+static int next(svg_t &s);
+static int read_name(svg_t &s, int c, char *name);
+static void skip_markup(svg_t &s, int c);
+static void start_element(svg_t &s, const char *name, int c);
+static void end_element(svg_t &s, const char *name);
+static uint8_t element_kind(const char *name);
+static style_t &top(svg_t &s);
+static void push(svg_t &s, const style_t &style);
+static void set_attr(svg_t &s, attrs_t &a, const char *name, const char *value);
+static void parse_style(svg_t &s, attrs_t &a, const char *value);
+static bool parse_colour(svg_t &s, const char *v, int16_t &grey, float &paint);
+static matrix_t parse_transform(const char *v);
+static int parse_numbers(const char *&v, float *out, int max);
+static matrix_t multiply(const matrix_t &m, const matrix_t &t);
+static uint32_t id_hash(const char *id, int len);
+static void path_char(svg_t &s, int c);
+static void path_flush(svg_t &s);
+static void path_arg(svg_t &s, float v);
+static void path_command(svg_t &s);
+static void add_point(svg_t &s, float x, float y);
+static void line_to(svg_t &s, float x, float y);
+static void cubic_to(svg_t &s, float x1, float y1, float x2, float y2, float x, float y);
+static void quad_to(svg_t &s, float x1, float y1, float x, float y);
+static void arc_to(svg_t &s, float rx, float ry, float angle, bool large, bool sweep, float x, float y);
+static void ellipse_arc(svg_t &s, float cx, float cy, float rx, float ry, float phi, float t0, float dt);
+static void shape_points(svg_t &s, uint8_t kind, const attrs_t &a);
+static void fill_shape(svg_t &s, const style_t &style);
+static void add_edge(svg_t &s, int &n, float x0, float y0, float x1, float y1);
+static void add_span(uint16_t *cover, int width, int32_t x0, int32_t x1);
+
+bool svg_render(fs::FS &fs, const char *path, int width, int height, uint8_t *image)
+{
+    File file = fs.open(path, FILE_READ);
+    if (!file)
+        return false;
+    svg_t *s = (svg_t *)calloc(1, sizeof(svg_t));
+    if (s == NULL)
+        return false;
+    s->file = &file;
+    s->width = width;
+    s->height = height;
+    s->canvas = (uint8_t *)ps_malloc(width * height);
+    s->cover = (uint16_t *)malloc((width + 1) * sizeof(uint16_t));
+    bool res = false;
+    if (s->canvas != NULL && s->cover != NULL)
+    {
+        memset(s->canvas, 0xFF, width * height);
+        style_t &root = s->stack[0];
+        root.ctm = identity;
+        root.fill = 0; // SVG fills black by default
+        root.paint = root.fillOpacity = root.opacity = 1;
+        s->depth = 1;
+        s->gradient = -1;
+        res = parse(*s);
+    }
+    if (res)
+    {
+        // 8-bit grey to 4bpp, even x in the low nibble
+        int rowBytes = (width + 1) / 2;
+        memset(image, 0xFF, rowBytes * height);
+        for (int y = 0; y < height; y++)
+        {
+            for (int x = 0; x < width; x++)
+            {
+                uint8_t v = (s->canvas[y * width + x] * 15 + 127) / 255;
+                uint8_t *b = &image[y * rowBytes + x / 2];
+                *b = (x & 1) ? ((*b & 0x0F) | (v << 4)) : ((*b & 0xF0) | v);
+            }
+        }
+    }
+    else
+        log_i("svg: can't render %s", path);
+    free(s->canvas);
+    free(s->cover);
+    free(s->points);
+    free(s->edges);
+    free(s->active);
+    free(s->crossings);
+    free(s);
+    file.close();
+    return res;
+}
+
+static bool parse(svg_t &s)
+{
+    int c;
+    while ((c = next(s)) >= 0)
+    {
+        if (c != '<')
+            continue; // Text content is not drawn
+        c = next(s);
+        if (c == '!' || c == '?')
+        {
+            skip_markup(s, c);
+            continue;
+        }
+        bool closing = (c == '/');
+        if (closing)
+            c = next(s);
+        char name[NAME_SIZE];
+        c = read_name(s, c, name);
+        if (closing)
+        {
+            while (c >= 0 && c != '>')
+                c = next(s);
+            end_element(s, name);
+        }
+        else
+            start_element(s, name, c);
+    }
+    return s.complete;
+}
+
+static int next(svg_t &s)
+{
+    if (s.pos == s.len)
+    {
+        s.len = s.file->read(s.buf, SVG_CHUNK);
+        s.pos = 0;
+        if (s.len <= 0)
+        {
+            s.len = 0;
+            return -1;
+        }
+    }
+    return s.buf[s.pos++];
+}
+
+// Reads a tag or attribute name that starts with c, returns the character after it
+static int read_name(svg_t &s, int c, char *name)
+{
+    int n = 0;
+    while (c >= 0 && !isspace(c) && c != '/' && c != '>' && c != '=')
+    {
+        if (n < NAME_SIZE - 1)
+            name[n++] = c;
+        c = next(s);
+    }
+    name[n] = 0;
+    return c;
+}
+
+// <!-- comment -->, <!DOCTYPE ...> and <?xml ...?>
+static void skip_markup(svg_t &s, int c)
+{
+    int dashes = 0;
+    bool comment = false;
+    if (c == '!')
+    {
+        comment = (c = next(s)) == '-' && (c = next(s)) == '-';
+        if (c == '>')
+            return;
+    }
+    while ((c = next(s)) >= 0)
+    {
+        if (c == '>' && (!comment || dashes >= 2))
+            return;
+        dashes = (c == '-') ? dashes + 1 : 0;
+    }
+}
+
+// Reads the attributes, c is the character after the name; shapes are drawn here, all they need is known
+static void start_element(svg_t &s, const char *name, int c)
+{
+    uint8_t kind = element_kind(name);
+    attrs_t a;
+    memset(&a, 0, sizeof(a));
+    a.fill = FILL_INHERIT;
+    a.paint = 1;
+    a.fillOpacity = a.opacity = -1;
+    a.evenOdd = -1;
+    a.transform = identity;
+    a.width = a.height = a.rx = a.ry = -1;
+    a.stopOpacity = 1;
+
+    const matrix_t &m = top(s).ctm;
+    s.scale = sqrtf(fabsf(m.a * m.d - m.b * m.c));
+    s.pointCnt = 0;
+    s.cmd = (kind == EL_POLY) ? 'M' : 0;
+    s.lastCmd = 0;
+    s.argCnt = s.numberLen = 0;
+    s.numberDot = s.numberExp = false;
+    s.curX = s.curY = s.startX = s.startY = 0;
+    s.needMove = true;
+
+    bool selfClosing = false;
+    while (c >= 0 && c != '>')
+    {
+        if (isspace(c))
+        {
+            c = next(s);
+            continue;
+        }
+        if (c == '/')
+        {
+            selfClosing = true;
+            c = next(s);
+            continue;
+        }
+        char attr[NAME_SIZE];
+        int first = c;
+        c = read_name(s, c, attr);
+        if (attr[0] == 0 && c == first)
+            c = next(s); // A stray character
+        while (c >= 0 && isspace(c))
+            c = next(s);
+        if (c != '=')
+            continue;
+        do
+            c = next(s);
+        while (c >= 0 && isspace(c));
+        if (c != '"' && c != '\'')
+            continue;
+        int quote = c;
+        if ((kind == EL_PATH && strcmp(attr, "d") == 0) || (kind == EL_POLY && strcmp(attr, "points") == 0))
+        {
+            while ((c = next(s)) >= 0 && c != quote)
+                path_char(s, c);
+            path_flush(s);
+        }
+        else
+        {
+            char value[VALUE_SIZE];
+            int n = 0;
+            while ((c = next(s)) >= 0 && c != quote)
+            {
+                if (n < VALUE_SIZE - 1)
+                    value[n++] = c;
+            }
+            value[n] = 0;
+            set_attr(s, a, attr, value);
+        }
+        if (c >= 0)
+            c = next(s);
+    }
+
+    style_t style = top(s);
+    if (a.fill != FILL_INHERIT)
+    {
+        style.fill = a.fill;
+        style.paint = a.paint;
+    }
+    if (a.fillOpacity >= 0)
+        style.fillOpacity = a.fillOpacity;
+    if (a.opacity >= 0)
+        style.opacity *= a.opacity;
+    if (a.evenOdd >= 0)
+        style.evenOdd = a.evenOdd;
+    style.hidden |= a.hidden || kind == EL_HIDDEN;
+    style.ctm = multiply(style.ctm, a.transform);
+
+    switch (kind)
+    {
+    case EL_SVG:
+        if (!s.sized)
+        {
+            // viewBox fitted into the image, centred
+            float vb[4] = {0, 0, (a.width > 0) ? a.width : s.width, (a.height > 0) ? a.height : s.height};
+            if (a.hasViewBox && a.viewBox[2] > 0 && a.viewBox[3] > 0)
+                memcpy(vb, a.viewBox, sizeof(vb));
+            float sc = min(s.width / vb[2], s.height / vb[3]);
+            matrix_t view = {sc, 0, 0, sc, (s.width - vb[2] * sc) / 2 - vb[0] * sc,
+                             (s.height - vb[3] * sc) / 2 - vb[1] * sc};
+            style.ctm = multiply(view, style.ctm);
+            s.sized = true;
+        }
+        break;
+    case EL_GRADIENT:
+        if (s.gradientCnt < SVG_GRADIENTS)
+        {
+            gradient_t &g = s.gradients[s.gradientCnt];
+            memset(&g, 0, sizeof(g));
+            for (int i = 0; i < s.gradientCnt; i++)
+            {
+                if (a.href != 0 && s.gradients[i].id == a.href)
+                    g = s.gradients[i]; // The stops of another gradient
+            }
+            g.id = a.id;
+            s.gradient = s.gradientCnt++;
+            if (selfClosing)
+                s.gradient = -1;
+        }
+        break;
+    case EL_STOP:
+        if (s.gradient >= 0)
+        {
+            gradient_t &g = s.gradients[s.gradient];
+            g.grey += a.stopGrey;
+            g.alpha += a.stopOpacity;
+            g.stops++;
+        }
+        break;
+    case EL_PATH:
+    case EL_POLY:
+    case EL_CIRCLE:
+    case EL_ELLIPSE:
+    case EL_RECT:
+        if (!style.hidden && style.fill != FILL_NONE)
+        {
+            shape_points(s, kind, a);
+            fill_shape(s, style);
+        }
+        break;
+    }
+    if (!selfClosing)
+        push(s, style);
+}
+
+static void end_element(svg_t &s, const char *name)
+{
+    uint8_t kind = element_kind(name);
+    if (kind == EL_GRADIENT)
+        s.gradient = -1;
+    else if (kind == EL_SVG && s.depth == 2)
+        s.complete = true;
+    if (s.depth > 1)
+        s.depth--;
+}
+
+static uint8_t element_kind(const char *name)
+{
+    for (size_t i = 0; i < sizeof(elements) / sizeof(elements[0]); i++)
+    {
+        if (strcmp(name, elements[i].name) == 0)
+            return elements[i].kind;
+    }
+    return EL_OTHER;
+}
+
+static style_t &top(svg_t &s)
+{
+    return s.stack[min(s.depth, SVG_MAX_DEPTH) - 1];
+}
+
+static void push(svg_t &s, const style_t &style)
+{
+    if (s.depth < SVG_MAX_DEPTH)
+        s.stack[s.depth] = style;
+    s.depth++;
+}
+
+static void set_attr(svg_t &s, attrs_t &a, const char *name, const char *value)
+{
+    if (strcmp(name, "fill") == 0)
+    {
+        int16_t grey;
+        float paint = 1;
+        if (parse_colour(s, value, grey, paint))
+        {
+            a.fill = grey;
+            a.paint = paint;
+        }
+    }
+    else if (strcmp(name, "fill-opacity") == 0)
+        a.fillOpacity = constrain(strtof(value, NULL), 0.0f, 1.0f);
+    else if (strcmp(name, "opacity") == 0)
+        a.opacity = constrain(strtof(value, NULL), 0.0f, 1.0f);
+    else if (strcmp(name, "fill-rule") == 0)
+        a.evenOdd = strstr(value, "evenodd") != NULL;
+    else if (strcmp(name, "display") == 0 || strcmp(name, "visibility") == 0)
+        a.hidden |= strstr(value, "none") != NULL || strstr(value, "hidden") != NULL;
+    else if (strcmp(name, "transform") == 0)
+        a.transform = parse_transform(value);
+    else if (strcmp(name, "style") == 0)
+        parse_style(s, a, value);
+    else if (strcmp(name, "viewBox") == 0)
+        a.hasViewBox = parse_numbers(value, a.viewBox, 4) == 4;
+    else if (strcmp(name, "id") == 0)
+        a.id = id_hash(value, strlen(value));
+    else if (strcmp(name, "xlink:href") == 0 || strcmp(name, "href") == 0)
+        a.href = (value[0] == '#') ? id_hash(value + 1, strlen(value + 1)) : 0;
+    else if (strcmp(name, "stop-color") == 0)
+    {
+        int16_t grey;
+        float paint;
+        if (parse_colour(s, value, grey, paint))
+            a.stopGrey = max(grey, (int16_t)0);
+    }
+    else if (strcmp(name, "stop-opacity") == 0)
+        a.stopOpacity = constrain(strtof(value, NULL), 0.0f, 1.0f);
+    else if (strchr(value, '%') == NULL) // Percentages of the viewport are not worth it for icons
+    {
+        float v = strtof(value, NULL);
+        if (strcmp(name, "x") == 0)
+            a.x = v;
+        else if (strcmp(name, "y") == 0)
+            a.y = v;
+        else if (strcmp(name, "width") == 0)
+            a.width = v;
+        else if (strcmp(name, "height") == 0)
+            a.height = v;
+        else if (strcmp(name, "cx") == 0)
+            a.cx = v;
+        else if (strcmp(name, "cy") == 0)
+            a.cy = v;
+        else if (strcmp(name, "r") == 0)
+            a.r = v;
+        else if (strcmp(name, "rx") == 0)
+            a.rx = v;
+        else if (strcmp(name, "ry") == 0)
+            a.ry = v;
+    }
+}
+
+// style="fill:#fff;fill-opacity:.5", the declarations are read like attributes
+static void parse_style(svg_t &s, attrs_t &a, const char *value)
+{
+    char decl[VALUE_SIZE];
+    while (*value)
+    {
+        int n = 0;
+        while (*value && *value != ';')
+            decl[n++] = *value++;
+        decl[n] = 0;
+        if (*value)
+            value++;
+        char *colon = strchr(decl, ':');
+        if (colon == NULL)
+            continue;
+        *colon = 0;
+        char *name = decl, *v = colon + 1;
+        while (isspace(*name))
+            name++;
+        for (char *e = colon - 1; e >= name && isspace(*e); e--)
+            *e = 0;
+        while (isspace(*v))
+            v++;
+        set_attr(s, a, name, v);
+    }
+}
+
+// Colour to grey, false if it is not understood (the fill is inherited then)
+static bool parse_colour(svg_t &s, const char *v, int16_t &grey, float &paint)
+{
+    int r, g, b;
+    while (isspace(*v))
+        v++;
+    if (*v == '#')
+    {
+        char *end;
+        uint32_t hex = strtoul(v + 1, &end, 16);
+        if (end - v == 4) // #rgb
+        {
+            r = (hex >> 8 & 0xF) * 0x11;
+            g = (hex >> 4 & 0xF) * 0x11;
+            b = (hex & 0xF) * 0x11;
+        }
+        else if (end - v == 7)
+        {
+            r = hex >> 16 & 0xFF;
+            g = hex >> 8 & 0xFF;
+            b = hex & 0xFF;
+        }
+        else
+            return false;
+    }
+    else if (strncmp(v, "rgb(", 4) == 0)
+    {
+        float c[3];
+        v += 4;
+        if (parse_numbers(v, c, 3) != 3)
+            return false;
+        r = constrain((int)c[0], 0, 255);
+        g = constrain((int)c[1], 0, 255);
+        b = constrain((int)c[2], 0, 255);
+    }
+    else if (strncmp(v, "url(#", 5) == 0)
+    {
+        const char *id = v + 5, *end = strchr(id, ')');
+        uint32_t hash = id_hash(id, end ? end - id : strlen(id));
+        grey = FILL_NONE; // A paint server we don't know draws nothing
+        for (int i = 0; i < s.gradientCnt; i++)
+        {
+            const gradient_t &gr = s.gradients[i];
+            if (gr.id == hash && gr.stops > 0)
+            {
+                grey = gr.grey / gr.stops + 0.5f;
+                paint = gr.alpha / gr.stops;
+            }
+        }
+        return true;
+    }
+    else if (strncmp(v, "none", 4) == 0 || strncmp(v, "transparent", 11) == 0)
+    {
+        grey = FILL_NONE;
+        return true;
+    }
+    else if (strncmp(v, "white", 5) == 0)
+        r = g = b = 255;
+    else if (strncmp(v, "black", 5) == 0 || strncmp(v, "currentColor", 12) == 0)
+        r = g = b = 0;
+    else if (strncmp(v, "gray", 4) == 0 || strncmp(v, "grey", 4) == 0)
+        r = g = b = 128;
+    else if (strncmp(v, "silver", 6) == 0)
+        r = g = b = 192;
+    else
+        return false;
+    grey = (r * 77 + g * 150 + b * 29) >> 8;
+    return true;
+}
+
+// translate(), scale(), rotate(), matrix(), skewX(), skewY() in any sequence
+static matrix_t parse_transform(const char *v)
+{
+    matrix_t m = identity;
+    while (*v)
+    {
+        while (*v && !isalpha(*v))
+            v++;
+        const char *name = v;
+        while (isalpha(*v))
+            v++;
+        int len = v - name;
+        while (*v && *v != '(')
+            v++;
+        if (*v == 0)
+            break;
+        v++;
+        float p[6];
+        int n = parse_numbers(v, p, 6);
+        while (*v && *v != ')')
+            v++;
+        matrix_t t = identity;
+        if (len == 6 && strncmp(name, "matrix", 6) == 0 && n == 6)
+            t = {p[0], p[1], p[2], p[3], p[4], p[5]};
+        else if (len == 9 && strncmp(name, "translate", 9) == 0 && n > 0)
+        {
+            t.e = p[0];
+            t.f = (n > 1) ? p[1] : 0;
+        }
+        else if (len == 5 && strncmp(name, "scale", 5) == 0 && n > 0)
+        {
+            t.a = p[0];
+            t.d = (n > 1) ? p[1] : p[0];
+        }
+        else if (len == 6 && strncmp(name, "rotate", 6) == 0 && n > 0)
+        {
+            float r = p[0] * (float)PI / 180;
+            t.a = t.d = cosf(r);
+            t.b = sinf(r);
+            t.c = -t.b;
+            if (n == 3) // Around cx, cy
+            {
+                t.e = p[1] - t.a * p[1] - t.c * p[2];
+                t.f = p[2] - t.b * p[1] - t.d * p[2];
+            }
+        }
+        else if (len == 5 && strncmp(name, "skewX", 5) == 0 && n > 0)
+            t.c = tanf(p[0] * (float)PI / 180);
+        else if (len == 5 && strncmp(name, "skewY", 5) == 0 && n > 0)
+            t.b = tanf(p[0] * (float)PI / 180);
+        m = multiply(m, t);
+    }
+    return m;
+}
+
+// Numbers separated by spaces or commas up to a ')' or the end, v is left after them
+static int parse_numbers(const char *&v, float *out, int max)
+{
+    int n = 0;
+    while (*v)
+    {
+        while (isspace(*v) || *v == ',')
+            v++;
+        char *end;
+        float f = strtof(v, &end);
+        if (end == v)
+            break;
+        if (n < max)
+            out[n++] = f;
+        v = end;
+    }
+    return n;
+}
+
+// t applied first, then m
+static matrix_t multiply(const matrix_t &m, const matrix_t &t)
+{
+    matrix_t r;
+    r.a = m.a * t.a + m.c * t.b;
+    r.b = m.b * t.a + m.d * t.b;
+    r.c = m.a * t.c + m.c * t.d;
+    r.d = m.b * t.c + m.d * t.d;
+    r.e = m.a * t.e + m.c * t.f + m.e;
+    r.f = m.b * t.e + m.d * t.f + m.f;
+    return r;
+}
+
+static uint32_t id_hash(const char *id, int len)
+{
+    uint32_t hash = 2166136261u;
+    while (len-- > 0)
+        hash = (hash ^ (uint8_t)*id++) * 16777619u;
+    return hash;
+}
+
+static int arg_count(char cmd)
+{
+    switch (toupper(cmd))
+    {
+    case 'H':
+    case 'V':
+        return 1;
+    case 'M':
+    case 'L':
+    case 'T':
+        return 2;
+    case 'S':
+    case 'Q':
+        return 4;
+    case 'C':
+        return 6;
+    case 'A':
+        return 7;
+    default:
+        return 0;
+    }
+}
+
+// Path data comes a character at a time: "M10-5.5.5" is M 10 -5.5 0.5, arc flags need no separator
+static void path_char(svg_t &s, int c)
+{
+    if (c >= '0' && c <= '9')
+    {
+        if (s.numberLen == 0 && toupper(s.cmd) == 'A' && (s.argCnt == 3 || s.argCnt == 4))
+        {
+            path_arg(s, c - '0');
+            return;
+        }
+    }
+    else if (c == '.')
+    {
+        if (s.numberDot || s.numberExp)
+            path_flush(s);
+        s.numberDot = true;
+    }
+    else if (c == '-' || c == '+')
+    {
+        if (s.numberLen == 0 || toupper(s.number[s.numberLen - 1]) != 'E')
+            path_flush(s);
+    }
+    else if ((c == 'e' || c == 'E') && s.numberLen > 0)
+        s.numberExp = true;
+    else
+    {
+        path_flush(s);
+        if (isalpha(c))
+        {
+            s.cmd = c;
+            s.argCnt = 0;
+            if (toupper(c) == 'Z')
+            {
+                s.curX = s.startX;
+                s.curY = s.startY;
+                s.needMove = true;
+                s.lastCmd = 'Z';
+            }
+        }
+        return;
+    }
+    if (s.numberLen < (int)sizeof(s.number) - 1)
+        s.number[s.numberLen++] = c;
+}
+
+static void path_flush(svg_t &s)
+{
+    if (s.numberLen == 0)
+        return;
+    s.number[s.numberLen] = 0;
+    s.numberLen = 0;
+    s.numberDot = s.numberExp = false;
+    path_arg(s, strtof(s.number, NULL));
+}
+
+static void path_arg(svg_t &s, float v)
+{
+    int count = arg_count(s.cmd);
+    if (count == 0)
+        return;
+    s.args[s.argCnt++] = v;
+    if (s.argCnt < count)
+        return;
+    path_command(s);
+    s.argCnt = 0;
+    if (s.cmd == 'M') // More coordinates after a move are lines
+        s.cmd = 'L';
+    else if (s.cmd == 'm')
+        s.cmd = 'l';
+}
+
+static void path_command(svg_t &s)
+{
+    const float *p = s.args;
+    bool rel = islower(s.cmd);
+    float ox = rel ? s.curX : 0, oy = rel ? s.curY : 0;
+    char cmd = toupper(s.cmd);
+    switch (cmd)
+    {
+    case 'M':
+        s.curX = s.startX = ox + p[0];
+        s.curY = s.startY = oy + p[1];
+        s.needMove = true;
+        break;
+    case 'L':
+        line_to(s, ox + p[0], oy + p[1]);
+        break;
+    case 'H':
+        line_to(s, ox + p[0], s.curY);
+        break;
+    case 'V':
+        line_to(s, s.curX, oy + p[0]);
+        break;
+    case 'C':
+        cubic_to(s, ox + p[0], oy + p[1], ox + p[2], oy + p[3], ox + p[4], oy + p[5]);
+        break;
+    case 'S':
+    {
+        bool smooth = s.lastCmd == 'C' || s.lastCmd == 'S';
+        float x1 = smooth ? 2 * s.curX - s.ctrlX : s.curX, y1 = smooth ? 2 * s.curY - s.ctrlY : s.curY;
+        cubic_to(s, x1, y1, ox + p[0], oy + p[1], ox + p[2], oy + p[3]);
+        break;
+    }
+    case 'Q':
+        quad_to(s, ox + p[0], oy + p[1], ox + p[2], oy + p[3]);
+        break;
+    case 'T':
+    {
+        bool smooth = s.lastCmd == 'Q' || s.lastCmd == 'T';
+        float x1 = smooth ? 2 * s.curX - s.ctrlX : s.curX, y1 = smooth ? 2 * s.curY - s.ctrlY : s.curY;
+        quad_to(s, x1, y1, ox + p[0], oy + p[1]);
+        break;
+    }
+    case 'A':
+        arc_to(s, p[0], p[1], p[2], p[3] != 0, p[4] != 0, ox + p[5], oy + p[6]);
+        break;
+    }
+    s.lastCmd = cmd;
+}
+
+static void add_point(svg_t &s, float x, float y)
+{
+    int need = s.pointCnt + (s.needMove ? 2 : 1);
+    if (need > s.pointCap)
+    {
+        int cap = max(need, max(s.pointCap * 2, 64));
+        point_t *p = (point_t *)ps_realloc(s.points, cap * sizeof(point_t));
+        if (p == NULL)
+            return; // The shape comes out incomplete
+        s.points = p;
+        s.pointCap = cap;
+    }
+    if (s.needMove)
+    {
+        s.points[s.pointCnt++] = {s.curX, s.curY, true};
+        s.needMove = false;
+    }
+    s.points[s.pointCnt++] = {x, y, false};
+}
+
+static void line_to(svg_t &s, float x, float y)
+{
+    add_point(s, x, y);
+    s.curX = x;
+    s.curY = y;
+}
+
+// Lines per curve for a FLATNESS error, from the second differences of the control points
+static int curve_segments(float dd, float k)
+{
+    int n = ceilf(sqrtf(dd * k / FLATNESS));
+    return constrain(n, 1, MAX_SEGMENTS);
+}
+
+static void cubic_to(svg_t &s, float x1, float y1, float x2, float y2, float x, float y)
+{
+    float x0 = s.curX, y0 = s.curY;
+    float dd = max(hypotf(x0 - 2 * x1 + x2, y0 - 2 * y1 + y2), hypotf(x1 - 2 * x2 + x, y1 - 2 * y2 + y));
+    int n = curve_segments(dd * s.scale, 0.75f);
+    for (int i = 1; i < n; i++)
+    {
+        float t = (float)i / n, u = 1 - t;
+        float b0 = u * u * u, b1 = 3 * u * u * t, b2 = 3 * u * t * t, b3 = t * t * t;
+        add_point(s, b0 * x0 + b1 * x1 + b2 * x2 + b3 * x, b0 * y0 + b1 * y1 + b2 * y2 + b3 * y);
+    }
+    line_to(s, x, y);
+    s.ctrlX = x2;
+    s.ctrlY = y2;
+}
+
+static void quad_to(svg_t &s, float x1, float y1, float x, float y)
+{
+    float x0 = s.curX, y0 = s.curY;
+    int n = curve_segments(hypotf(x0 - 2 * x1 + x, y0 - 2 * y1 + y) * s.scale, 0.25f);
+    for (int i = 1; i < n; i++)
+    {
+        float t = (float)i / n, u = 1 - t;
+        add_point(s, u * u * x0 + 2 * u * t * x1 + t * t * x, u * u * y0 + 2 * u * t * y1 + t * t * y);
+    }
+    line_to(s, x, y);
+    s.ctrlX = x1;
+    s.ctrlY = y1;
+}
+
+// Endpoint arc to centre form, SVG 1.1 appendix F.6.5
+static void arc_to(svg_t &s, float rx, float ry, float angle, bool large, bool sweep, float x, float y)
+{
+    float x0 = s.curX, y0 = s.curY;
+    rx = fabsf(rx);
+    ry = fabsf(ry);
+    if (rx == 0 || ry == 0 || (x == x0 && y == y0))
+    {
+        line_to(s, x, y);
+        return;
+    }
+    float phi = angle * (float)PI / 180, cs = cosf(phi), sn = sinf(phi);
+    float dx = (x0 - x) / 2, dy = (y0 - y) / 2;
+    float x1 = cs * dx + sn * dy, y1 = -sn * dx + cs * dy;
+    float lambda = x1 * x1 / (rx * rx) + y1 * y1 / (ry * ry);
+    if (lambda > 1) // The radii are too small to reach, scaled up as the spec says
+    {
+        rx *= sqrtf(lambda);
+        ry *= sqrtf(lambda);
+    }
+    float num = rx * rx * ry * ry - rx * rx * y1 * y1 - ry * ry * x1 * x1;
+    float den = rx * rx * y1 * y1 + ry * ry * x1 * x1;
+    float k = sqrtf(max(num, 0.0f) / den);
+    if (large == sweep)
+        k = -k;
+    float cx1 = k * rx * y1 / ry, cy1 = -k * ry * x1 / rx;
+    float cx = cs * cx1 - sn * cy1 + (x0 + x) / 2, cy = sn * cx1 + cs * cy1 + (y0 + y) / 2;
+    float t0 = atan2f((y1 - cy1) / ry, (x1 - cx1) / rx);
+    float dt = atan2f((-y1 - cy1) / ry, (-x1 - cx1) / rx) - t0;
+    if (sweep && dt < 0)
+        dt += 2 * (float)PI;
+    else if (!sweep && dt > 0)
+        dt -= 2 * (float)PI;
+    ellipse_arc(s, cx, cy, rx, ry, phi, t0, dt);
+    line_to(s, x, y);
+}
+
+// The points between the ends of an elliptic arc, the caller adds the end
+static void ellipse_arc(svg_t &s, float cx, float cy, float rx, float ry, float phi, float t0, float dt)
+{
+    // A chord of angle a is r * a^2 / 8 off the circle
+    float r = max(rx, ry) * s.scale;
+    int n = (r > FLATNESS) ? ceilf(fabsf(dt) / sqrtf(8 * FLATNESS / r)) : 1;
+    n = constrain(n, 1, MAX_SEGMENTS);
+    float cs = cosf(phi), sn = sinf(phi);
+    for (int i = 1; i < n; i++)
+    {
+        float t = t0 + dt * i / n;
+        float ex = rx * cosf(t), ey = ry * sinf(t);
+        add_point(s, cx + ex * cs - ey * sn, cy + ex * sn + ey * cs);
+    }
+}
+
+// Outlines of circle, ellipse and rect; path and polygon points come with their attribute
+static void shape_points(svg_t &s, uint8_t kind, const attrs_t &a)
+{
+    float pi = (float)PI;
+    if (kind == EL_CIRCLE || kind == EL_ELLIPSE)
+    {
+        float rx = (kind == EL_CIRCLE) ? a.r : a.rx, ry = (kind == EL_CIRCLE) ? a.r : a.ry;
+        if (rx <= 0 || ry <= 0)
+            return;
+        s.curX = a.cx + rx;
+        s.curY = a.cy;
+        s.needMove = true;
+        ellipse_arc(s, a.cx, a.cy, rx, ry, 0, 0, 2 * pi);
+        add_point(s, a.cx + rx, a.cy);
+    }
+    else if (kind == EL_RECT)
+    {
+        if (a.width <= 0 || a.height <= 0)
+            return;
+        // One of rx, ry given means both, rounded corners are quarter ellipses
+        float rx = (a.rx >= 0) ? a.rx : max(a.ry, 0.0f), ry = (a.ry >= 0) ? a.ry : rx;
+        rx = min(rx, a.width / 2);
+        ry = min(ry, a.height / 2);
+        float x0 = a.x, y0 = a.y, x1 = a.x + a.width, y1 = a.y + a.height;
+        s.curX = x0 + rx;
+        s.curY = y0;
+        s.needMove = true;
+        add_point(s, x1 - rx, y0);
+        ellipse_arc(s, x1 - rx, y0 + ry, rx, ry, 0, -pi / 2, pi / 2);
+        add_point(s, x1, y0 + ry);
+        add_point(s, x1, y1 - ry);
+        ellipse_arc(s, x1 - rx, y1 - ry, rx, ry, 0, 0, pi / 2);
+        add_point(s, x1 - rx, y1);
+        add_point(s, x0 + rx, y1);
+        ellipse_arc(s, x0 + rx, y1 - ry, rx, ry, 0, pi / 2, pi / 2);
+        add_point(s, x0, y1 - ry);
+        add_point(s, x0, y0 + ry);
+        ellipse_arc(s, x0 + rx, y0 + ry, rx, ry, 0, pi, pi / 2);
+        add_point(s, x0 + rx, y0);
+    }
+}
+
+static int edge_cmp(const void *a, const void *b)
+{
+    float d = ((const edge_t *)a)->y0 - ((const edge_t *)b)->y0;
+    return (d < 0) ? -1 : (d > 0);
+}
+
+// Scanline fill of the closed subpaths: SUBROWS sample rows per pixel, each adds the covered part of
+// every pixel in 1/SUBPIXEL steps, then the row is blended into the canvas
+static void fill_shape(svg_t &s, const style_t &style)
+{
+    int alpha = constrain((int)lrintf(255 * style.fillOpacity * style.opacity * style.paint), 0, 255);
+    if (alpha == 0 || s.pointCnt < 3)
+        return;
+    if (s.pointCnt > s.edgeCap)
+    {
+        // Every point but the first of a subpath makes one edge, each subpath one more to close it
+        edge_t *e = (edge_t *)ps_realloc(s.edges, s.pointCnt * sizeof(edge_t));
+        if (e != NULL)
+            s.edges = e;
+        int *a = (int *)ps_realloc(s.active, s.pointCnt * sizeof(int));
+        if (a != NULL)
+            s.active = a;
+        crossing_t *c = (crossing_t *)ps_realloc(s.crossings, s.pointCnt * sizeof(crossing_t));
+        if (c != NULL)
+            s.crossings = c;
+        if (e == NULL || a == NULL || c == NULL)
+            return;
+        s.edgeCap = s.pointCnt;
+    }
+
+    const matrix_t &m = style.ctm;
+    int n = 0;
+    float firstX = 0, firstY = 0, prevX = 0, prevY = 0;
+    for (int i = 0; i < s.pointCnt; i++)
+    {
+        const point_t &p = s.points[i];
+        float x = m.a * p.x + m.c * p.y + m.e, y = m.b * p.x + m.d * p.y + m.f;
+        if (p.move)
+        {
+            if (i > 0)
+                add_edge(s, n, prevX, prevY, firstX, firstY);
+            firstX = x;
+            firstY = y;
+        }
+        else
+            add_edge(s, n, prevX, prevY, x, y);
+        prevX = x;
+        prevY = y;
+    }
+    add_edge(s, n, prevX, prevY, firstX, firstY);
+    if (n == 0)
+        return;
+    qsort(s.edges, n, sizeof(edge_t), edge_cmp);
+
+    float top = s.edges[0].y0, bottom = top, left = s.width, right = 0;
+    for (int i = 0; i < n; i++)
+    {
+        const edge_t &e = s.edges[i];
+        float x1 = e.x0 + (e.y1 - e.y0) * e.slope;
+        bottom = max(bottom, e.y1);
+        left = min(left, min(e.x0, x1));
+        right = max(right, max(e.x0, x1));
+    }
+    int y0 = max((int)floorf(top), 0), y1 = min((int)ceilf(bottom), s.height);
+    int x0 = max((int)floorf(left), 0), x1 = min((int)ceilf(right), s.width - 1);
+    if (x1 < x0)
+        return;
+
+    int next = 0, active = 0;
+    for (int y = y0; y < y1; y++)
+    {
+        memset(s.cover + x0, 0, (x1 - x0 + 1) * sizeof(uint16_t));
+        for (int k = 0; k < SUBROWS; k++)
+        {
+            float sy = y + (k + 0.5f) / SUBROWS;
+            while (next < n && s.edges[next].y0 <= sy)
+                s.active[active++] = next++;
+            int crossings = 0, keep = 0;
+            for (int i = 0; i < active; i++)
+            {
+                const edge_t &e = s.edges[s.active[i]];
+                if (e.y1 <= sy)
+                    continue; // Done with
+                s.active[keep++] = s.active[i];
+                int32_t x = lrintf((e.x0 + (sy - e.y0) * e.slope) * SUBPIXEL);
+                crossing_t c = {constrain(x, (int32_t)0, (int32_t)s.width * SUBPIXEL), e.dir};
+                int j = crossings++;
+                for (; j > 0 && s.crossings[j - 1].x > c.x; j--)
+                    s.crossings[j] = s.crossings[j - 1];
+                s.crossings[j] = c;
+            }
+            active = keep;
+            int winding = 0;
+            for (int i = 0; i + 1 < crossings; i++)
+            {
+                winding += s.crossings[i].dir;
+                if (style.evenOdd ? (winding & 1) : (winding != 0))
+                    add_span(s.cover, s.width, s.crossings[i].x, s.crossings[i + 1].x);
+            }
+        }
+        uint8_t *row = s.canvas + y * s.width;
+        for (int x = x0; x <= x1; x++)
+        {
+            if (s.cover[x] == 0)
+                continue;
+            int a = s.cover[x] * alpha / FULL_COVER;
+            int d = (style.fill - row[x]) * a;
+            row[x] += (d + ((d < 0) ? -127 : 127)) / 255;
+        }
+    }
+}
+
+static void add_edge(svg_t &s, int &n, float x0, float y0, float x1, float y1)
+{
+    if (y0 == y1)
+        return; // Horizontal edges are never crossed
+    edge_t &e = s.edges[n++];
+    e.dir = (y1 > y0) ? 1 : -1;
+    if (y0 > y1)
+    {
+        std::swap(x0, x1);
+        std::swap(y0, y1);
+    }
+    e.x0 = x0;
+    e.y0 = y0;
+    e.y1 = y1;
+    e.slope = (x1 - x0) / (y1 - y0);
+}
+
+// Pixels x0 .. x1 of a sample row are inside, in 1/SUBPIXEL px
+static void add_span(uint16_t *cover, int width, int32_t x0, int32_t x1)
+{
+    if (x1 <= x0)
+        return;
+    int p0 = x0 / SUBPIXEL, p1 = x1 / SUBPIXEL;
+    if (p0 == p1)
+    {
+        cover[p0] += x1 - x0;
+        return;
+    }
+    cover[p0] += SUBPIXEL - x0 % SUBPIXEL;
+    for (int p = p0 + 1; p < p1; p++)
+        cover[p] += SUBPIXEL;
+    if (p1 < width)
+        cover[p1] += x1 % SUBPIXEL;
+}
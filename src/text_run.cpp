@@ -0,0 +1,46 @@
+#include "text_run.h"
+#include "glyph_cache.h"
+
+void text_shape(text_run_t &run, const GFXfont *font, const char *str)
+{
+    int minx = 100000, miny = 100000, maxx = -1, maxy = -1;
+    int pen = 0;
+    uint32_t cp;
+    run.font = font;
+    run.count = 0;
+    while ((cp = utf8_next(&str)) != 0)
+    {
+        const GFXglyph *glyph = glyph_find(font, cp);
+        if (glyph == NULL)
+            continue;
+        if (run.count == TEXT_RUN_MAX)
+        {
+            log_i("text run is full, \"%s\" dropped", str);
+            break;
+        }
+        run.glyph[run.count] = glyph;
+        run.pen[run.count++] = pen;
+        // Same box as get_text_bounds(), which mirrors the glyphs around the baseline
+        minx = min(minx, pen + glyph->left);
+        maxx = max(maxx, pen + glyph->left + glyph->width);
+        miny = min(miny, glyph->top - glyph->height);
+        maxy = max(maxy, (int)glyph->top);
+        pen += glyph->advance_x;
+    }
+    run.advance = pen;
+    if (run.count == 0)
+    {
+        run.x1 = run.y1 = run.w = run.h = 0;
+        return;
+    }
+    run.x1 = min(0, minx);
+    run.w = maxx - run.x1;
+    run.y1 = miny;
+    run.h = maxy - miny;
+}
+
+void text_draw(const text_run_t &run, int x, int y, uint8_t *framebuffer, int top, int bottom)
+{
+    for (uint8_t i = 0; i < run.count; i++)
+        glyph_draw(run.font, run.glyph[i], x + run.pen[i], y, framebuffer, top, bottom);
+}
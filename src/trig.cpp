@@ -0,0 +1,69 @@
+#include "trig.h"
+
+// The quarter wave is computed by the compiler and lands in flash, nothing runs at boot
+
+namespace
+{
+template <int... I>
+struct index_seq
+{
+};
+template <int N, int... I>
+struct make_index_seq : make_index_seq<N - 1, N - 1, I...>
+{
+};
+template <int... I>
+struct make_index_seq<0, I...>
+{
+    typedef index_seq<I...> type;
+};
+
+struct quarter_wave_t
+{
+    uint16_t q[TRIG_QUARTER + 1]; // sin(0) .. sin(90 deg), 1.0 does not fit an int16_t
+};
+
+// Taylor series of sin, the terms past x^19 are below Q15 resolution for x <= pi / 2
+constexpr double taylor_sin(double x2, double term, int n, double sum)
+{
+    return (n > 19) ? sum : taylor_sin(x2, -term * x2 / ((n + 1) * (n + 2)), n + 2, sum + term);
+}
+
+constexpr uint16_t quarter_sin(int i)
+{
+    return (uint16_t)(taylor_sin((PI / 2 * i / TRIG_QUARTER) * (PI / 2 * i / TRIG_QUARTER), PI / 2 * i / TRIG_QUARTER, 1,
+                                 0) * TRIG_ONE + 0.5);
+}
+
+template <int... I>
+constexpr quarter_wave_t quarter_wave(index_seq<I...>)
+{
+    return {{quarter_sin(I)...}};
+}
+
+constexpr quarter_wave_t sineTable = quarter_wave(make_index_seq<TRIG_QUARTER + 1>::type());
+} // namespace
+
+int32_t trig_sin(int32_t angle)
+{
+    angle &= TRIG_TURN - 1;
+    if (angle < TRIG_QUARTER)
+        return sineTable.q[angle];
+    if (angle < 2 * TRIG_QUARTER)
+        return sineTable.q[2 * TRIG_QUARTER - angle];
+    if (angle < 3 * TRIG_QUARTER)
+        return -(int32_t)sineTable.q[angle - 2 * TRIG_QUARTER];
+    return -(int32_t)sineTable.q[TRIG_TURN - angle];
+}
+
+int32_t trig_cos(int32_t angle)
+{
+    return trig_sin(angle + TRIG_QUARTER);
+}
+
+void trig_rotate(int32_t x, int32_t y, int32_t angle, int32_t &rx, int32_t &ry)
+{
+    int32_t c = trig_cos(angle), s = trig_sin(angle);
+    rx = x * c - y * s;
+    ry = y * c + x * s;
+}
@@ -0,0 +1,68 @@
+#include "wake_profile.h"
+#include "esp_timer.h"
+
+static const char *const phaseNames[PHASE_COUNT] = {"spiffs", "param", "wifi", "ntp", "http",
+                                                    "decode", "chrome", "render", "panel"};
+
+RTC_DATA_ATTR static profile_wake_t wakes[PROFILE_WAKES];
+RTC_DATA_ATTR static uint8_t head = 0; // wakes[head] is the current wake
+RTC_DATA_ATTR static uint8_t wakeCnt = 0;
+RTC_DATA_ATTR static uint32_t wakeNumber = 0;
+static uint32_t started[PHASE_COUNT]; // esp_timer_get_time() of the running phases
+
+void profile_begin(uint8_t cause)
+{
+    head = (head + 1) % PROFILE_WAKES;
+    if (wakeCnt < PROFILE_WAKES)
+        wakeCnt++;
+    profile_wake_t &wake = wakes[head];
+    memset(&wake, 0, sizeof(wake));
+    wake.wake = ++wakeNumber;
+    wake.cause = cause;
+}
+
+void profile_start(uint8_t phase)
+{
+    started[phase] = esp_timer_get_time();
+}
+
+void profile_stop(uint8_t phase)
+{
+    wakes[head].phases[phase] += (uint32_t)esp_timer_get_time() - started[phase];
+}
+
+void profile_end()
+{
+    wakes[head].total = esp_timer_get_time();
+    profile_log(0);
+}
+
+uint8_t profile_count()
+{
+    return wakeCnt;
+}
+
+const profile_wake_t &profile_wake(uint8_t age)
+{
+    return wakes[(head + PROFILE_WAKES - age % PROFILE_WAKES) % PROFILE_WAKES];
+}
+
+const char *profile_phase_name(uint8_t phase)
+{
+    return (phase < PHASE_COUNT) ? phaseNames[phase] : "";
+}
+
+void profile_log(uint8_t age)
+{
+    const profile_wake_t &wake = profile_wake(age);
+    char line[256];
+    int len = snprintf(line, sizeof(line), "wake %u (cause %u), ms: awake %u.%u", wake.wake, wake.cause,
+                       wake.total / 1000, wake.total / 100 % 10);
+    for (uint8_t i = 0; i < PHASE_COUNT && len < (int)sizeof(line); i++)
+    {
+        if (wake.phases[i] != 0)
+            len += snprintf(line + len, sizeof(line) - len, ", %s %u.%u", phaseNames[i], wake.phases[i] / 1000,
+                            wake.phases[i] / 100 % 10);
+    }
+    log_i("%s", line);
+}
@@ -0,0 +1,99 @@
+#include "weather_json.h"
+#include "weather_vocab.h"
+
+static void keep_token(bool unknown, const char *token, char *out);
+
+const JsonDocument &weather_filter()
+{
+    static StaticJsonDocument<WEATHER_FILTER_SIZE> filter;
+    if (!filter.isNull())
+        return filter;
+    const char *fact[] = {"condition", "daytime", "feels_like", "humidity", "icon", "obs_time", "polar", "pressure_mm",
+                          "pressure_pa", "season", "temp", "temp_water", "wind_dir", "wind_gust", "wind_speed"};
+    const char *forecast[] = {"date", "date_ts", "moon_code", "moon_text", "sunrise", "sunset", "week"};
+    const char *part[] = {"condition", "daytime", "feels_like", "humidity", "icon", "part_name", "polar", "prec_mm",
+                          "prec_period", "prec_prob", "pressure_mm", "pressure_pa", "temp_avg", "temp_max", "temp_min",
+                          "temp_water", "wind_dir", "wind_gust", "wind_speed"};
+    const char *info[] = {"lat", "lon", "url"};
+    for (const char *key : fact)
+        filter["fact"][key] = true;
+    for (const char *key : forecast)
+        filter["forecast"][key] = true;
+    for (const char *key : part) // The first element of a filter array applies to every element
+        filter["forecast"]["parts"][0][key] = true;
+    for (const char *key : info)
+        filter["info"][key] = true;
+    filter["now"] = true;
+    filter["now_dt"] = true;
+    return filter;
+}
+
+void decode_weather(JsonObject jo, weather_t &weather)
+{
+    // read from JsonObject
+    JsonObject fact = jo["fact"];
+    weather.fact.condition = parse_condition(fact["condition"]);
+    weather.fact.daytime = parse_daytime(fact["daytime"]);
+    weather.fact.feels_like = fact["feels_like"].as<int8_t>();
+    weather.fact.humidity = fact["humidity"].as<uint8_t>();
+    weather.fact.icon = icon_id(fact["icon"]);
+    weather.fact.obs_time = fact["obs_time"].as<int>();
+    weather.fact.polar = fact["polar"].as<bool>();
+    weather.fact.pressure_mm = fact["pressure_mm"].as<uint16_t>();
+    weather.fact.pressure_pa = fact["pressure_pa"].as<uint16_t>();
+    weather.fact.season = parse_season(fact["season"]);
+    keep_token(weather.fact.condition == COND_UNKNOWN, fact["condition"], weather.fact.condition_token);
+    keep_token(weather.fact.season == SEASON_UNKNOWN, fact["season"], weather.fact.season_token);
+    weather.fact.temp = fact["temp"].as<int8_t>();
+    weather.fact.temp_water = fact["temp_water"].as<int8_t>();
+    weather.fact.wind_dir = parse_wind_dir(fact["wind_dir"]);
+    weather.fact.wind_gust = fact["wind_gust"].as<float>();
+    weather.fact.wind_speed = fact["wind_speed"].as<float>();
+
+    JsonObject forecast = jo["forecast"];
+    strlcpy(weather.forecast.date, forecast["date"] | "", sizeof(weather.forecast.date));
+    weather.forecast.date_ts = forecast["date_ts"].as<int>();
+    weather.forecast.moon_code = forecast["moon_code"].as<uint8_t>();
+    strlcpy(weather.forecast.moon_text, forecast["moon_text"] | "", sizeof(weather.forecast.moon_text));
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        JsonObject part = forecast["parts"][i];
+        weather.forecast.parts[i].condition = parse_condition(part["condition"]);
+        weather.forecast.parts[i].daytime = parse_daytime(part["daytime"]);
+        weather.forecast.parts[i].feels_like = part["feels_like"].as<int8_t>();
+        weather.forecast.parts[i].humidity = part["humidity"].as<uint8_t>();
+        weather.forecast.parts[i].icon = icon_id(part["icon"]);
+        weather.forecast.parts[i].part_name = parse_part_name(part["part_name"]);
+        keep_token(weather.forecast.parts[i].condition == COND_UNKNOWN, part["condition"],
+                   weather.forecast.parts[i].condition_token);
+        keep_token(weather.forecast.parts[i].part_name == PART_UNKNOWN, part["part_name"],
+                   weather.forecast.parts[i].part_name_token);
+        weather.forecast.parts[i].polar = part["polar"].as<bool>();
+        weather.forecast.parts[i].prec_mm = part["prec_mm"].as<float>();
+        weather.forecast.parts[i].prec_period = part["prec_period"].as<uint16_t>();
+        weather.forecast.parts[i].prec_prob = part["prec_prob"].as<uint8_t>();
+        weather.forecast.parts[i].pressure_mm = part["pressure_mm"].as<uint16_t>();
+        weather.forecast.parts[i].pressure_pa = part["pressure_pa"].as<uint16_t>();
+        weather.forecast.parts[i].temp_avg = part["temp_avg"].as<int8_t>();
+        weather.forecast.parts[i].temp_max = part["temp_max"].as<int8_t>();
+        weather.forecast.parts[i].temp_min = part["temp_min"].as<int8_t>();
+        weather.forecast.parts[i].temp_water = part["temp_water"].as<int8_t>();
+        weather.forecast.parts[i].wind_dir = parse_wind_dir(part["wind_dir"]);
+        weather.forecast.parts[i].wind_gust = part["wind_gust"].as<float>();
+        weather.forecast.parts[i].wind_speed = part["wind_speed"].as<float>();
+    }
+    strlcpy(weather.forecast.sunrise, forecast["sunrise"] | "", sizeof(weather.forecast.sunrise));
+    strlcpy(weather.forecast.sunset, forecast["sunset"] | "", sizeof(weather.forecast.sunset));
+    weather.forecast.week = forecast["week"].as<uint16_t>();
+    weather.info.lat = jo["info"]["lat"].as<float>();
+    weather.info.lon = jo["info"]["lon"].as<float>();
+    strlcpy(weather.info.url, jo["info"]["url"] | "", sizeof(weather.info.url));
+    weather.now = jo["now"].as<int>();
+    strlcpy(weather.now_dt, jo["now_dt"] | "", sizeof(weather.now_dt));
+}
+
+// A new Yandex token has no label, it is printed as it came like before the vocabulary tables
+static void keep_token(bool unknown, const char *token, char *out)
+{
+    strlcpy(out, (unknown && token != NULL) ? token : "", TOKEN_SIZE);
+}
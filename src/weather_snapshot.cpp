@@ -0,0 +1,231 @@
+#include "weather_snapshot.h"
+#include "weather_vocab.h"
+#include <rom/crc.h>
+
+static uint16_t intern(snapshot_t &s, const char *str);
+static uint32_t payload_crc(const snapshot_t &s);
+static bool fields_ok(const snapshot_t &s);
+
+bool snapshot_save(fs::FS &fs, const weather_t &w)
+{
+    snapshot_t *s = (snapshot_t *)calloc(1, sizeof(snapshot_t));
+    if (s == NULL)
+        return false;
+    s->str_used = 1; // strings[0] is the empty string
+
+    s->obs_time = w.fact.obs_time;
+    s->condition = w.fact.condition;
+    s->daytime = w.fact.daytime;
+    s->icon = intern(*s, icon_name(w.fact.icon));
+    s->season = w.fact.season;
+    s->wind_dir = w.fact.wind_dir;
+    s->pressure_mm = w.fact.pressure_mm;
+    s->pressure_pa = w.fact.pressure_pa;
+    s->feels_like = w.fact.feels_like;
+    s->humidity = w.fact.humidity;
+    s->wind_gust = w.fact.wind_gust;
+    s->wind_speed = w.fact.wind_speed;
+    s->polar = w.fact.polar;
+    s->temp = w.fact.temp;
+    s->temp_water = w.fact.temp_water;
+    s->condition_token = intern(*s, w.fact.condition_token);
+    s->season_token = intern(*s, w.fact.season_token);
+
+    s->date_ts = w.forecast.date_ts;
+    s->date = intern(*s, w.forecast.date);
+    s->moon_code = w.forecast.moon_code;
+    s->moon_text = intern(*s, w.forecast.moon_text);
+    s->sunrise = intern(*s, w.forecast.sunrise);
+    s->sunset = intern(*s, w.forecast.sunset);
+    s->week = w.forecast.week;
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        const forecast_part_t &p = w.forecast.parts[i];
+        snapshot_part_t &sp = s->parts[i];
+        sp.condition = p.condition;
+        sp.daytime = p.daytime;
+        sp.icon = intern(*s, icon_name(p.icon));
+        sp.part_name = p.part_name;
+        sp.wind_dir = p.wind_dir;
+        sp.prec_period = p.prec_period;
+        sp.pressure_mm = p.pressure_mm;
+        sp.pressure_pa = p.pressure_pa;
+        sp.prec_mm = p.prec_mm;
+        sp.wind_gust = p.wind_gust;
+        sp.wind_speed = p.wind_speed;
+        sp.feels_like = p.feels_like;
+        sp.humidity = p.humidity;
+        sp.polar = p.polar;
+        sp.prec_prob = p.prec_prob;
+        sp.temp_avg = p.temp_avg;
+        sp.temp_max = p.temp_max;
+        sp.temp_min = p.temp_min;
+        sp.temp_water = p.temp_water;
+        sp.condition_token = intern(*s, p.condition_token);
+        sp.part_name_token = intern(*s, p.part_name_token);
+    }
+
+    s->lat = w.info.lat;
+    s->lon = w.info.lon;
+    s->url = intern(*s, w.info.url);
+    s->now = w.now;
+    s->now_dt = intern(*s, w.now_dt);
+
+    s->header.magic = SNAPSHOT_MAGIC;
+    s->header.version = SNAPSHOT_VERSION;
+    s->header.size = sizeof(snapshot_t);
+    s->header.crc = payload_crc(*s);
+
+    bool res = false;
+    File f = fs.open(SNAPSHOT_FILE, FILE_WRITE);
+    if (f)
+    {
+        res = (f.write((uint8_t *)s, sizeof(snapshot_t)) == sizeof(snapshot_t));
+        f.close();
+    }
+    log_i("snapshot saved: %d, %d bytes, %d bytes of strings", res, sizeof(snapshot_t), s->str_used);
+    free(s);
+    return res;
+}
+
+bool snapshot_load(fs::FS &fs, weather_t &w)
+{
+    if (!fs.exists(SNAPSHOT_FILE))
+    {
+        log_i("snapshot not found");
+        return false;
+    }
+    snapshot_t *s = (snapshot_t *)malloc(sizeof(snapshot_t));
+    if (s == NULL)
+        return false;
+    File f = fs.open(SNAPSHOT_FILE, FILE_READ);
+    size_t size = f.read((uint8_t *)s, sizeof(snapshot_t));
+    f.close();
+
+    if (size != sizeof(snapshot_t) || s->header.magic != SNAPSHOT_MAGIC ||
+        s->header.version != SNAPSHOT_VERSION || s->header.size != sizeof(snapshot_t) ||
+        s->header.crc != payload_crc(*s) || !fields_ok(*s))
+    {
+        log_i("snapshot is invalid (size %d, version %d)", size, s->header.version);
+        free(s);
+        return false;
+    }
+    const char *str = s->strings;
+
+    w.fact.obs_time = s->obs_time;
+    w.fact.condition = (condition_t)s->condition;
+    w.fact.daytime = (daytime_t)s->daytime;
+    w.fact.icon = icon_id(&str[s->icon]);
+    w.fact.season = (season_t)s->season;
+    w.fact.wind_dir = (wind_dir_t)s->wind_dir;
+    w.fact.pressure_mm = s->pressure_mm;
+    w.fact.pressure_pa = s->pressure_pa;
+    w.fact.feels_like = s->feels_like;
+    w.fact.humidity = s->humidity;
+    w.fact.wind_gust = s->wind_gust;
+    w.fact.wind_speed = s->wind_speed;
+    w.fact.polar = s->polar;
+    w.fact.temp = s->temp;
+    w.fact.temp_water = s->temp_water;
+    strlcpy(w.fact.condition_token, &str[s->condition_token], sizeof(w.fact.condition_token));
+    strlcpy(w.fact.season_token, &str[s->season_token], sizeof(w.fact.season_token));
+
+    w.forecast.date_ts = s->date_ts;
+    strlcpy(w.forecast.date, &str[s->date], sizeof(w.forecast.date));
+    w.forecast.moon_code = s->moon_code;
+    strlcpy(w.forecast.moon_text, &str[s->moon_text], sizeof(w.forecast.moon_text));
+    strlcpy(w.forecast.sunrise, &str[s->sunrise], sizeof(w.forecast.sunrise));
+    strlcpy(w.forecast.sunset, &str[s->sunset], sizeof(w.forecast.sunset));
+    w.forecast.week = s->week;
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        forecast_part_t &p = w.forecast.parts[i];
+        const snapshot_part_t &sp = s->parts[i];
+        p.condition = (condition_t)sp.condition;
+        p.daytime = (daytime_t)sp.daytime;
+        p.icon = icon_id(&str[sp.icon]);
+        p.part_name = (part_name_t)sp.part_name;
+        p.wind_dir = (wind_dir_t)sp.wind_dir;
+        p.prec_period = sp.prec_period;
+        p.pressure_mm = sp.pressure_mm;
+        p.pressure_pa = sp.pressure_pa;
+        p.prec_mm = sp.prec_mm;
+        p.wind_gust = sp.wind_gust;
+        p.wind_speed = sp.wind_speed;
+        p.feels_like = sp.feels_like;
+        p.humidity = sp.humidity;
+        p.polar = sp.polar;
+        p.prec_prob = sp.prec_prob;
+        p.temp_avg = sp.temp_avg;
+        p.temp_max = sp.temp_max;
+        p.temp_min = sp.temp_min;
+        p.temp_water = sp.temp_water;
+        strlcpy(p.condition_token, &str[sp.condition_token], sizeof(p.condition_token));
+        strlcpy(p.part_name_token, &str[sp.part_name_token], sizeof(p.part_name_token));
+    }
+
+    w.info.lat = s->lat;
+    w.info.lon = s->lon;
+    strlcpy(w.info.url, &str[s->url], sizeof(w.info.url));
+    w.now = s->now;
+    strlcpy(w.now_dt, &str[s->now_dt], sizeof(w.now_dt));
+    free(s);
+    log_i("snapshot loaded");
+    return true;
+}
+
+// Identical strings (the icon names of both parts, say) are stored once
+static uint16_t intern(snapshot_t &s, const char *str)
+{
+    size_t len = strlen(str);
+    if (len == 0)
+        return 0;
+    for (uint16_t i = 1; i < s.str_used; i += strlen(&s.strings[i]) + 1)
+    {
+        if (strcmp(str, &s.strings[i]) == 0)
+            return i;
+    }
+    if (s.str_used + len + 1 > SNAPSHOT_STR_SIZE)
+    {
+        log_i("snapshot string table is full, \"%s\" dropped", str);
+        return 0;
+    }
+    uint16_t offset = s.str_used;
+    memcpy(&s.strings[offset], str, len + 1);
+    s.str_used += len + 1;
+    return offset;
+}
+
+// The CRC only says the file is as written; a writer with another idea of the layout under the same version
+// could still have put anything in it, so every string offset and enum is checked before it is used
+static bool fields_ok(const snapshot_t &s)
+{
+    // The used part of the table starts with the empty string and ends with a terminator,
+    // so a string at any offset below str_used ends inside it
+    if (s.str_used < 1 || s.str_used > SNAPSHOT_STR_SIZE || s.strings[0] != 0 || s.strings[s.str_used - 1] != 0)
+        return false;
+    const uint16_t offsets[] = {s.icon, s.date, s.moon_text, s.sunrise, s.sunset, s.url, s.now_dt,
+                                s.condition_token, s.season_token, s.parts[0].icon, s.parts[1].icon,
+                                s.parts[0].condition_token, s.parts[1].condition_token, s.parts[0].part_name_token,
+                                s.parts[1].part_name_token};
+    for (uint8_t i = 0; i < sizeof(offsets) / sizeof(offsets[0]); i++)
+    {
+        if (offsets[i] >= s.str_used)
+            return false;
+    }
+    if (s.condition >= COND_COUNT || s.daytime >= DAYTIME_COUNT || s.season >= SEASON_COUNT || s.wind_dir >= WIND_COUNT)
+        return false;
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        const snapshot_part_t &p = s.parts[i];
+        if (p.condition >= COND_COUNT || p.daytime >= DAYTIME_COUNT || p.part_name >= PART_COUNT || p.wind_dir >= WIND_COUNT)
+            return false;
+    }
+    return true;
+}
+
+static uint32_t payload_crc(const snapshot_t &s)
+{
+    const uint8_t *payload = (const uint8_t *)&s + sizeof(snapshot_header_t);
+    return crc32_le(0, payload, sizeof(snapshot_t) - sizeof(snapshot_header_t));
+}
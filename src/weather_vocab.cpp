@@ -0,0 +1,101 @@
+#include "weather_vocab.h"
+#include "weather_vocab_table.h"
+#include <string.h>
+
+static char extraIcons[ICON_EXTRA][ICON_NAME_SIZE];
+static uint8_t extraIconCnt = 0;
+
+#define LOOKUP(name, NAME, token) lookup(name##_table, NAME##_SEED, NAME##_SLOTS, NAME##_UNKNOWN_SLOT, token)
+
+// One probe, a miss lands on the unknown entry
+static const vocab_entry_t &lookup(const vocab_entry_t *table, uint32_t seed, uint8_t slots, uint8_t unknown,
+                                   const char *token)
+{
+    if (token == NULL)
+        return table[unknown];
+    const vocab_entry_t &entry = table[vocab_hash(token, seed) & (slots - 1)];
+    return (strcmp(entry.token, token) == 0) ? entry : table[unknown];
+}
+
+condition_t parse_condition(const char *token)
+{
+    return (condition_t)LOOKUP(condition, CONDITION, token).value;
+}
+
+daytime_t parse_daytime(const char *token)
+{
+    return (daytime_t)LOOKUP(daytime, DAYTIME, token).value;
+}
+
+season_t parse_season(const char *token)
+{
+    return (season_t)LOOKUP(season, SEASON, token).value;
+}
+
+part_name_t parse_part_name(const char *token)
+{
+    return (part_name_t)LOOKUP(part_name, PART_NAME, token).value;
+}
+
+wind_dir_t parse_wind_dir(const char *token)
+{
+    return (wind_dir_t)LOOKUP(wind_dir, WIND_DIR, token).value;
+}
+
+uint8_t icon_id(const char *name)
+{
+    if (name == NULL || *name == 0 || strlen(name) >= ICON_NAME_SIZE)
+        return ICON_NONE;
+    uint8_t id = LOOKUP(icon, ICON, name).value;
+    if (id != ICON_NONE)
+        return id;
+    // New Yandex icon: keep its name so it can still be downloaded and printed
+    for (uint8_t i = 0; i < extraIconCnt; i++)
+    {
+        if (strcmp(extraIcons[i], name) == 0)
+            return ICON_SLOTS + i;
+    }
+    if (extraIconCnt == ICON_EXTRA)
+        return ICON_NONE;
+    strcpy(extraIcons[extraIconCnt], name);
+    return ICON_SLOTS + extraIconCnt++;
+}
+
+const char *condition_label(condition_t condition)
+{
+    return condition_table[condition_slot[(condition < COND_COUNT) ? condition : COND_UNKNOWN]].label;
+}
+
+const char *season_label(season_t season)
+{
+    return season_table[season_slot[(season < SEASON_COUNT) ? season : SEASON_UNKNOWN]].label;
+}
+
+const char *part_name_label(part_name_t part)
+{
+    return part_name_table[part_name_slot[(part < PART_COUNT) ? part : PART_UNKNOWN]].label;
+}
+
+const char *wind_dir_label(wind_dir_t dir)
+{
+    return wind_dir_table[wind_dir_slot[(dir < WIND_COUNT) ? dir : WIND_UNKNOWN]].label;
+}
+
+int16_t wind_dir_angle(wind_dir_t dir)
+{
+    return wind_dir_table[wind_dir_slot[(dir < WIND_COUNT) ? dir : WIND_UNKNOWN]].angle;
+}
+
+const char *icon_name(uint8_t id)
+{
+    if (id < ICON_SLOTS)
+        return icon_table[id].token;
+    if (id != ICON_NONE && id - ICON_SLOTS < extraIconCnt)
+        return extraIcons[id - ICON_SLOTS];
+    return "";
+}
+
+const char *label_or_token(const char *label, const char *token)
+{
+    return (*label != 0) ? label : token;
+}
@@ -1,5 +1,6 @@
 #include "web_server.h"
 #include "param_data.h"
+#include "wake_profile.h"
 
 static WebServer *_server;
 static FS *_filesystem;
@@ -7,6 +8,7 @@ static bool loadFromFS(String path);
 static void hw_WebRequests();
 static void hw_Website();
 static void hw_param();
+static void hw_wakes();
 static String curDataToJSONStr();
 static void _task(void *param);
 static xTaskHandle _th;
@@ -22,6 +24,7 @@ void Web_Server::begin(fs::FS *Filesystem)
     // Регистрация обработчиков
     _server->on(F("/"), hw_Website);
     _server->on(F("/param"), hw_param);
+    _server->on(F("/wakes"), hw_wakes);
     _server->onNotFound(hw_WebRequests);
     ElegantOTA.begin(_server);
     _server->begin();
@@ -179,6 +182,7 @@ static void hw_param()
             if (_server->arg(F("api_key")) != "")
                 jsonDoc["api_key"] = _param.api_key;
             jsonDoc["test_data"] = _param.test_data;
+            jsonDoc["generation"] = jsonDoc["generation"].as<uint32_t>() + 1; // Новая версия настроек
 
             f = SPIFFS.open("/param.json", FILE_WRITE); // Открыли для записи
             serializeJson(jsonDoc, f);                  // Сериализовали JSON-документ в файл
@@ -197,3 +201,27 @@ static void hw_param()
     log_d("Resetting ESP...");
     ESP.restart();
 }
+
+// The wake timelines kept in RTC memory, the latest first, times in us
+static void hw_wakes()
+{
+    DynamicJsonDocument jsonDoc(PROFILE_WAKES * (PHASE_COUNT + 4) * 32);
+    JsonArray wakes = jsonDoc.to<JsonArray>();
+    for (uint8_t i = 0; i < profile_count(); i++)
+    {
+        const profile_wake_t &wake = profile_wake(i);
+        JsonObject jo = wakes.createNestedObject();
+        jo["wake"] = wake.wake;
+        jo["cause"] = wake.cause;
+        jo["total"] = wake.total;
+        JsonObject phases = jo.createNestedObject("phases");
+        for (uint8_t p = 0; p < PHASE_COUNT; p++)
+        {
+            if (wake.phases[p] != 0)
+                phases[profile_phase_name(p)] = wake.phases[p];
+        }
+    }
+    String json;
+    serializeJson(jsonDoc, json);
+    _server->send(200, F("application/json"), json);
+}
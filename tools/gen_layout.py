@@ -0,0 +1,52 @@
+#!/usr/bin/env python3
+"""Generates include/layout_default.h: data/layout.json as a C string, the layout the board falls back
+to when /layout.json is missing or broken.
+
+The JSON is stored without the whitespace, one widget per line of the header.
+
+Usage: python3 tools/gen_layout.py
+"""
+
+import json
+import os
+
+
+def c_string(text):
+    return '"' + text.replace("\\", "\\\\").replace('"', '\\"') + '"'
+
+
+def compact(value):
+    return json.dumps(value, ensure_ascii=False, separators=(",", ":"))
+
+
+def main():
+    root = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")
+    with open(os.path.join(root, "data", "layout.json"), encoding="utf-8") as f:
+        layout = json.load(f)
+
+    lines = []
+    sections = list(layout.items())
+    for i, (name, widgets) in enumerate(sections):
+        lines.append(("{" if i == 0 else "") + compact(name) + ":[")
+        for j, widget in enumerate(widgets):
+            lines.append(compact(widget) + ("," if j + 1 < len(widgets) else ""))
+        lines.append("]" + ("," if i + 1 < len(sections) else "}"))
+
+    out = [
+        "// Generated by tools/gen_layout.py from data/layout.json, do not edit",
+        "#ifndef LAYOUT_DEFAULT_H_",
+        "#define LAYOUT_DEFAULT_H_",
+        "",
+        "// The layout used without /layout.json on SPIFFS",
+        "static const char layoutDefault[] =",
+    ]
+    out += ["    " + c_string(line) for line in lines]
+    out[-1] += ";"
+    out += ["", "#endif /* LAYOUT_DEFAULT_H_ */"]
+
+    with open(os.path.join(root, "include", "layout_default.h"), "w", encoding="utf-8") as f:
+        f.write("\n".join(out) + "\n")
+
+
+if __name__ == "__main__":
+    main()
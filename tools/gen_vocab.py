@@ -0,0 +1,184 @@
+#!/usr/bin/env python3
+"""Generates include/weather_vocab_table.h: perfect-hash tables for the Yandex vocabulary.
+
+Every token of a vocabulary lands in its own slot of a power-of-two table, so a lookup is
+one hash, one mask and one strcmp(). Empty slots hold the "unknown" entry, which makes
+unknown tokens fall through to *_UNKNOWN without a special case.
+
+Usage: python3 tools/gen_vocab.py
+"""
+
+import os
+
+FNV_PRIME = 16777619
+MASK32 = 0xFFFFFFFF
+
+# token, enum, label, angle
+CONDITIONS = [
+    ("clear", "COND_CLEAR", "Ясно"),
+    ("partly-cloudy", "COND_PARTLY_CLOUDY", "Малооблачно"),
+    ("cloudy", "COND_CLOUDY", "Облачно с прояснениями"),
+    ("overcast", "COND_OVERCAST", "Пасмурно"),
+    ("drizzle", "COND_DRIZZLE", "Моросящий дождь"),
+    ("light-rain", "COND_LIGHT_RAIN", "Небольшой дождь"),
+    ("rain", "COND_RAIN", "Дождь"),
+    ("moderate-rain", "COND_MODERATE_RAIN", "Умеренно сильный дождь"),
+    ("heavy-rain", "COND_HEAVY_RAIN", "Сильный дождь"),
+    ("continuous-heavy-rain", "COND_CONTINUOUS_HEAVY_RAIN", "Длительный сильный дождь"),
+    ("showers", "COND_SHOWERS", "Ливень"),
+    ("wet-snow", "COND_WET_SNOW", "Дождь со снегом"),
+    ("light-snow", "COND_LIGHT_SNOW", "Небольшой снег"),
+    ("snow", "COND_SNOW", "Снег"),
+    ("snow-showers", "COND_SNOW_SHOWERS", "Снегопад"),
+    ("hail", "COND_HAIL", "Град"),
+    ("thunderstorm", "COND_THUNDERSTORM", "Гроза"),
+    ("thunderstorm-with-rain", "COND_THUNDERSTORM_WITH_RAIN", "Дождь с грозой"),
+    ("thunderstorm-with-hail", "COND_THUNDERSTORM_WITH_HAIL", "Гроза с градом"),
+]
+
+DAYTIMES = [
+    ("d", "DAYTIME_DAY", "День"),
+    ("n", "DAYTIME_NIGHT", "Ночь"),
+]
+
+SEASONS = [
+    ("summer", "SEASON_SUMMER", "Лето"),
+    ("autumn", "SEASON_AUTUMN", "Осень"),
+    ("winter", "SEASON_WINTER", "Зима"),
+    ("spring", "SEASON_SPRING", "Весна"),
+]
+
+PART_NAMES = [
+    ("night", "PART_NIGHT", "Ночь"),
+    ("morning", "PART_MORNING", "Утро"),
+    ("day", "PART_DAY", "День"),
+    ("evening", "PART_EVENING", "Вечер"),
+]
+
+WIND_DIRS = [
+    ("c", "WIND_CALM", "C", -1),
+    ("n", "WIND_N", "N", 0),
+    ("ne", "WIND_NE", "NE", 45),
+    ("e", "WIND_E", "E", 90),
+    ("se", "WIND_SE", "SE", 135),
+    ("s", "WIND_S", "S", 180),
+    ("sw", "WIND_SW", "SW", 225),
+    ("w", "WIND_W", "W", 270),
+    ("nw", "WIND_NW", "NW", 315),
+]
+
+# Icons shipped in icons/ (packed into data/icons.pak), the icon id is the slot
+ICONS = [
+    "bkn_+ra_d", "bkn_+ra_n", "bkn_-ra_d", "bkn_-ra_n", "bkn_-sn_d", "bkn_-sn_n", "bkn_d", "bkn_n",
+    "bkn_ra_d", "bkn_ra_n", "bkn_sn_d", "bkn_sn_n", "bl", "fg_d", "ovc", "ovc_+ra",
+    "ovc_+sn", "ovc_-ra", "ovc_-sn", "ovc_ra", "ovc_ra_sn", "ovc_sn", "ovc_ts", "ovc_ts_ra",
+    "skc_d", "skc_n",
+]
+
+
+def vocab_hash(token, seed):
+    h = seed
+    for b in token.encode():
+        h = ((h ^ b) * FNV_PRIME) & MASK32
+    return h
+
+
+def find_seed(tokens):
+    size = 4
+    while size <= len(tokens):  # keep at least one empty slot for the unknown entry
+        size *= 2
+    while True:
+        for seed in range(1, 1 << 16):
+            slots = {vocab_hash(t, seed) & (size - 1) for t in tokens}
+            if len(slots) == len(tokens):
+                return seed, size
+        size *= 2
+
+
+def emit_table(out, name, unknown, entries):
+    """entries: (token, value, label, angle), a None value stores the slot itself"""
+    seed, size = find_seed([e[0] for e in entries])
+    upper = name.upper()
+    slots = [None] * size
+    for e in entries:
+        slots[vocab_hash(e[0], seed) & (size - 1)] = e
+    out.append(f"#define {upper}_SEED 0x{seed:08X}u")
+    out.append(f"#define {upper}_SLOTS {size}")
+    out.append(f"#define {upper}_UNKNOWN_SLOT {slots.index(None)}")
+    out.append(f"constexpr vocab_entry_t {name}_table[{upper}_SLOTS] = {{")
+    for i, e in enumerate(slots):
+        if e is None:
+            out.append(f'    {{"", {unknown}, "", -1}},')
+        else:
+            value = i if e[1] is None else e[1]
+            out.append(f'    {{"{e[0]}", {value}, "{e[2]}", {e[3]}}},')
+    out.append("};")
+    for e in entries:
+        out.append(f'static_assert(vocab_slot("{e[0]}", {upper}_SEED, {upper}_SLOTS) == '
+                   f'{slots.index(e)}, "regenerate with tools/gen_vocab.py");')
+    out.append("")
+    return slots
+
+
+def emit_enum_vocab(out, name, unknown, count, entries):
+    entries = [(e[0], e[1], e[2], e[3] if len(e) > 3 else -1) for e in entries]
+    slots = emit_table(out, name, unknown, entries)
+    # enum -> slot, for the label and angle of a decoded value
+    out.append(f"// Indexed by {name}_t")
+    out.append(f"constexpr uint8_t {name}_slot[{count}] = {{")
+    out.append(f"    {name.upper()}_UNKNOWN_SLOT, // {unknown}")
+    for e in entries:
+        out.append(f"    {slots.index(e)}, // {e[1]}")
+    out.append("};")
+    for e in entries:
+        out.append(f'static_assert({name}_table[{name}_slot[{e[1]}]].value == {e[1]}, '
+                   f'"{name}_t changed, regenerate with tools/gen_vocab.py");')
+    out.append("")
+
+
+def main():
+    out = [
+        "// Generated by tools/gen_vocab.py, do not edit",
+        "#ifndef WEATHER_VOCAB_TABLE_H_",
+        "#define WEATHER_VOCAB_TABLE_H_",
+        "",
+        "#include <stdint.h>",
+        '#include "weather_data.h"',
+        "",
+        "typedef struct",
+        "{",
+        "    const char *token;",
+        "    uint8_t value; // enum value, the slot itself for icons",
+        "    const char *label;",
+        "    int16_t angle; // wind direction, -1 for everything else",
+        "} vocab_entry_t;",
+        "",
+        "// FNV-1a with a per-table seed",
+        "constexpr uint32_t vocab_hash(const char *token, uint32_t h)",
+        "{",
+        "    return *token ? vocab_hash(token + 1, (h ^ (uint8_t)*token) * 16777619u) : h;",
+        "}",
+        "",
+        "constexpr uint8_t vocab_slot(const char *token, uint32_t seed, uint8_t slots)",
+        "{",
+        "    return vocab_hash(token, seed) & (slots - 1);",
+        "}",
+        "",
+    ]
+    emit_enum_vocab(out, "condition", "COND_UNKNOWN", "COND_COUNT", CONDITIONS)
+    emit_enum_vocab(out, "daytime", "DAYTIME_UNKNOWN", "DAYTIME_COUNT", DAYTIMES)
+    emit_enum_vocab(out, "season", "SEASON_UNKNOWN", "SEASON_COUNT", SEASONS)
+    emit_enum_vocab(out, "part_name", "PART_UNKNOWN", "PART_COUNT", PART_NAMES)
+    emit_enum_vocab(out, "wind_dir", "WIND_UNKNOWN", "WIND_COUNT", WIND_DIRS)
+
+    # The icon id is the slot, names unknown at build time are interned above ICON_SLOTS
+    emit_table(out, "icon", "ICON_NONE", [(n, None, "", -1) for n in ICONS])
+    out.append("#endif /* WEATHER_VOCAB_TABLE_H_ */")
+
+    path = os.path.join(os.path.dirname(__file__), "..", "include", "weather_vocab_table.h")
+    with open(path, "w", encoding="utf-8") as f:
+        f.write("\n".join(out) + "\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,147 @@
+#!/usr/bin/env python3
+"""Packs the 4bpp images from icons/ into data/icons.pak, one SPIFFS file instead of one per icon.
+
+Layout, little endian:
+    header  "YWIA", u16 version, u16 count
+    index   count entries sorted by hash: u32 hash, u32 offset, u16 size, u16 width, u16 height,
+            u8 encoding, u8 reserved
+    data    the images, offsets are from the start of the file
+
+The hash is FNV-1a of the name without ".bin", the reader binary searches the index by it.
+Raw images (encoding 0) have rows padded to whole bytes, even x in the low nibble.
+RLE images (encoding 1) are runs of pixels in row order, no padding, runs go on to the next row:
+a byte is value << 4 | length - 1 for 1..15 pixels; length bits 15 mean 15 + the next byte.
+An image is stored in whichever encoding is smaller.
+
+A 100x100 icon whose 250x250 "L" version exists is not packed, the board scales the large one
+down (icon_scale.cpp). The hand-made small icons stay in icons/ as the reference for the
+simulator quality check: sim -q icons.
+
+Usage: python3 tools/pack_icons.py
+Also runs from PlatformIO (extra_scripts) before the file system image is built.
+"""
+
+import os
+import struct
+import sys
+
+MAGIC = b"YWIA"
+VERSION = 2
+MAX_ICONS = 80  # ATLAS_MAX_ICONS in include/icon_atlas.h
+ENCODING_RAW = 0
+ENCODING_RLE = 1
+INDEX_ENTRY = struct.Struct("<IIHHHBB")
+
+# Images that are not weather icons; *L is 250x250 and the rest is 100x100
+SIZES = {
+    "ovc_+snL": (248, 247),
+    "blob": (36, 40),
+    "sunrise": (47, 35),
+    "sunset": (47, 40),
+    "wifi_img": (200, 200),
+    "url_img": (200, 200),
+    "moon_new": (100, 57),
+}
+
+
+def name_hash(name):
+    h = 2166136261
+    for b in name.encode():
+        h = ((h ^ b) * 16777619) & 0xFFFFFFFF
+    return h
+
+
+def icon_size(name):
+    if name in SIZES:
+        return SIZES[name]
+    return (250, 250) if name.endswith("L") else (100, 100)
+
+
+def load_icons(src):
+    icons = []
+    files = sorted(os.listdir(src))
+    for file in files:
+        if not file.endswith(".bin"):
+            continue
+        name = file[:-4]
+        if name + "L.bin" in files:
+            continue  # Made from the large icon on the board
+        width, height = icon_size(name)
+        size = (width + 1) // 2 * height
+        with open(os.path.join(src, file), "rb") as f:
+            data = f.read()
+        if len(data) > size:
+            sys.exit(f"{file}: {len(data)} bytes, more than {width}x{height}")
+        # The converter drops the last byte, some files are cut shorter; the rest is white
+        if len(data) < size - 1:
+            print(f"warning: {file} is {size - len(data)} bytes short, padded with white")
+        icons.append((name_hash(name), name, width, height, data + b"\xff" * (size - len(data))))
+    return icons
+
+
+def pixels(data, width, height):
+    row_bytes = (width + 1) // 2
+    for y in range(height):
+        for x in range(width):
+            b = data[y * row_bytes + x // 2]
+            yield b >> 4 if x & 1 else b & 0x0F
+
+
+def rle(data, width, height):
+    out = bytearray()
+    value, length = None, 0
+    for p in list(pixels(data, width, height)) + [None]:
+        if p == value:
+            length += 1
+            continue
+        while length > 0:
+            n = min(length, 15 + 255)
+            out += bytes([value << 4 | (n - 1)]) if n < 15 else bytes([value << 4 | 15, n - 15])
+            length -= n
+        value, length = p, 1
+    return bytes(out)
+
+
+def pack(src, dst):
+    icons = sorted(load_icons(src))
+    if len(icons) > MAX_ICONS:
+        sys.exit(f"{len(icons)} icons, the reader keeps {MAX_ICONS}")
+    for a, b in zip(icons, icons[1:]):
+        if a[0] == b[0]:
+            sys.exit(f"{a[1]} and {b[1]} have the same hash, rename one")
+    offset = 8 + INDEX_ENTRY.size * len(icons)
+    index, blobs = [], []
+    raw_total = 0
+    for h, name, width, height, data in icons:
+        encoding, raw_total = ENCODING_RAW, raw_total + len(data)
+        packed = rle(data, width, height)
+        if len(packed) < len(data):
+            encoding, data = ENCODING_RLE, packed
+        if len(data) > 0xFFFF:
+            sys.exit(f"{name}: {len(data)} bytes do not fit the index")
+        index.append(INDEX_ENTRY.pack(h, offset, len(data), width, height, encoding, 0))
+        blobs.append(data)
+        offset += len(data)
+    with open(dst, "wb") as f:
+        f.write(MAGIC + struct.pack("<HH", VERSION, len(icons)))
+        f.write(b"".join(index))
+        f.write(b"".join(blobs))
+    images = sum(len(b) for b in blobs)
+    print(f"{os.path.relpath(dst)}: {len(icons)} icons, {offset} bytes, "
+          f"images {raw_total} -> {images} bytes ({raw_total / images:.1f}x)")
+
+
+def paths(root):
+    root = os.path.normpath(root)
+    return os.path.join(root, "icons"), os.path.join(root, "data", "icons.pak")
+
+
+if __name__ == "__main__":
+    pack(*paths(os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")))
+else:
+    Import("env")  # noqa: F821 - PlatformIO extra script
+
+    def before_buildfs(source, target, env):
+        pack(*paths(env.subst("$PROJECT_DIR")))
+
+    env.AddPreAction("$BUILD_DIR/spiffs.bin", before_buildfs)  # noqa: F821